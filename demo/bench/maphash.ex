@@ -0,0 +1,90 @@
+--****
+-- === bench/maphash.ex
+--
+-- Map hashing benchmark
+--
+-- ==== Usage
+-- {{{
+--     eui maphash <keys> <key length>
+-- }}}
+--
+-- default is 200000 random keys of 16 characters
+--
+-- Fills a large map with string keys and then looks every key up again,
+-- once for each hashing algorithm that [[:hash_algorithm]] accepts. The
+-- time for the bare [[:hash]] calls is shown too, since that is the part
+-- that the algorithm changes.
+--
+
+without type_check
+include std/get.e
+include std/hash.e
+include std/map.e
+include std/rand.e
+
+function init()
+	object arg
+	sequence cmd
+	integer nkeys = 200_000
+	integer keylen = 16
+
+	cmd = command_line()
+	if length(cmd) >= 3 then
+		arg = value(cmd[3])
+		if arg[1] = GET_SUCCESS then
+			nkeys = arg[2]
+		end if
+	end if
+	if length(cmd) >= 4 then
+		arg = value(cmd[4])
+		if arg[1] = GET_SUCCESS then
+			keylen = arg[2]
+		end if
+	end if
+
+	return {nkeys, keylen}
+end function
+
+procedure time_it(sequence keys, integer algo, sequence name)
+	atom t0, t_hash, t_put, t_get
+	object h
+	map m
+
+	map:hash_algorithm(algo)
+
+	t0 = time()
+	for i = 1 to length(keys) do
+		h = hash(keys[i], algo)
+	end for
+	t_hash = time() - t0
+
+	t0 = time()
+	m = map:new(length(keys))
+	for i = 1 to length(keys) do
+		map:put(m, keys[i], i)
+	end for
+	t_put = time() - t0
+
+	t0 = time()
+	for i = 1 to length(keys) do
+		if map:get(m, keys[i]) != i then
+			printf(1, "%s lost key %d\n", {name, i})
+			abort(1)
+		end if
+	end for
+	t_get = time() - t0
+
+	printf(1, "%-10s  hash %6.3f  put %6.3f  get %6.3f\n", {name, t_hash, t_put, t_get})
+end procedure
+
+sequence arg = init()
+sequence keys = repeat(0, arg[1])
+for i = 1 to length(keys) do
+	keys[i] = rand(repeat(26, arg[2])) + 'a' - 1
+end for
+
+printf(1, "Map Hashing Benchmark: %d keys of %d characters\n", arg)
+time_it(keys, HSIEH30,  "HSIEH30")
+time_it(keys, HSIEH32,  "HSIEH32")
+time_it(keys, CRC32C,   "CRC32C")
+time_it(keys, XXHASH64, "XXHASH64")
@@ -0,0 +1,101 @@
+--****
+-- === bench/output.ex
+--
+-- File output benchmark
+--
+-- ==== Usage
+-- {{{
+--     eui output <lines>
+-- }}}
+--
+-- default is 2000000 lines
+--
+-- Writes the same text to a file three ways: with one [[:puts]] per line,
+-- with one [[:puts]] for a large block of lines, and with the C library's
+-- ##fputs## called once per line. The last shows how close the Euphoria
+-- output path comes to plain C stdio.
+--
+
+without type_check
+include std/dll.e
+include std/filesys.e
+include std/get.e
+include std/machine.e
+
+constant LINE = "a short line of output text, like a log entry\n"
+constant FILE_NAME = "output.tmp"
+
+function init()
+	object arg
+	sequence cmd
+	integer nlines = 2_000_000
+
+	cmd = command_line()
+	if length(cmd) >= 3 then
+		arg = value(cmd[3])
+		if arg[1] = GET_SUCCESS then
+			nlines = arg[2]
+		end if
+	end if
+
+	return nlines
+end function
+
+procedure report(sequence name, atom t, integer nlines)
+	atom mb = nlines * length(LINE) / 1_000_000
+	printf(1, "%-18s %7.3f s  %8.1f MB/s\n", {name, t, mb / (t + 1e-9)})
+end procedure
+
+integer nlines = init()
+integer fn
+atom t0
+
+printf(1, "Output Benchmark: %d lines of %d bytes\n", {nlines, length(LINE)})
+
+fn = open(FILE_NAME, "w")
+t0 = time()
+for i = 1 to nlines do
+	puts(fn, LINE)
+end for
+close(fn)
+report("puts per line", time() - t0, nlines)
+
+sequence block = repeat(0, 1000 * length(LINE))
+for i = 1 to 1000 do
+	block[(i - 1) * length(LINE) + 1 .. i * length(LINE)] = LINE
+end for
+fn = open(FILE_NAME, "w")
+t0 = time()
+for i = 1 to floor(nlines / 1000) do
+	puts(fn, block)
+end for
+close(fn)
+report("puts per 1000", time() - t0, nlines - remainder(nlines, 1000))
+
+atom libc
+ifdef WINDOWS then
+	libc = open_dll("msvcrt.dll")
+elsedef
+	libc = open_dll({"libc.so.6", "libc.so", "libc.dylib"})
+end ifdef
+if libc then
+	integer c_fopen  = define_c_func(libc, "fopen",  {C_POINTER, C_POINTER}, C_POINTER)
+	integer c_fputs  = define_c_func(libc, "fputs",  {C_POINTER, C_POINTER}, C_INT)
+	integer c_fclose = define_c_func(libc, "fclose", {C_POINTER}, C_INT)
+	atom name = allocate_string(FILE_NAME)
+	atom mode = allocate_string("w")
+	atom text = allocate_string(LINE)
+	atom f = c_func(c_fopen, {name, mode})
+
+	t0 = time()
+	for i = 1 to nlines do
+		c_func(c_fputs, {text, f})
+	end for
+	c_func(c_fclose, {f})
+	report("C fputs per line", time() - t0, nlines)
+	free(name)
+	free(mode)
+	free(text)
+end if
+
+delete_file(FILE_NAME)
@@ -0,0 +1,143 @@
+--****
+-- === bench/pingpong.ex
+--
+-- Task wake-up benchmark
+--
+-- ==== Usage
+-- {{{
+--     eui pingpong <rounds> <idle tasks>
+-- }}}
+--
+-- default is 100000 rounds, with 1000 idle tasks
+--
+-- Two tasks hand a turn back and forth, first by polling a shared variable
+-- with [[:task_yield]] as programs had to before, then through a pair of
+-- semaphores and through a pair of channels. The idle tasks poll too while
+-- the first test runs, and then wait for an event. A task that polls has to
+-- take turns with every other task that polls, while a task that waits is
+-- simply woken.
+--
+
+without type_check
+include std/get.e
+include std/task.e
+
+function init()
+	object arg
+	sequence cmd
+	integer nrounds = 100_000
+	integer nidle = 1000
+
+	cmd = command_line()
+	if length(cmd) >= 3 then
+		arg = value(cmd[3])
+		if arg[1] = GET_SUCCESS then
+			nrounds = arg[2]
+		end if
+	end if
+	if length(cmd) >= 4 then
+		arg = value(cmd[4])
+		if arg[1] = GET_SUCCESS then
+			nidle = arg[2]
+		end if
+	end if
+
+	return {nrounds, nidle}
+end function
+
+sequence params = init()
+integer nrounds = params[1]
+integer nidle = params[2]
+atom t0
+
+procedure report(sequence name, atom t)
+	printf(1, "%-12s %7.3f s  %10.0f round trips/s\n",
+		{name, t, nrounds / (t + 1e-9)})
+end procedure
+
+atom done = event_new()
+integer polling = 1
+integer waiting = 0
+
+procedure idler()
+	while polling do
+		task_yield()
+	end while
+	waiting += 1
+	event_wait(done)
+end procedure
+
+-- polling
+integer turn = 0
+
+procedure poll_pong()
+	for i = 1 to nrounds do
+		while turn != 1 do
+			task_yield()
+		end while
+		turn = 0
+	end for
+end procedure
+
+-- semaphores
+atom ping = semaphore_new(), pong = semaphore_new()
+
+procedure sem_pong()
+	for i = 1 to nrounds do
+		semaphore_wait(ping)
+		semaphore_signal(pong)
+	end for
+end procedure
+
+-- channels
+atom to_pong = channel_new(1), to_ping = channel_new(1)
+
+procedure chan_pong()
+	sequence msg
+
+	for i = 1 to nrounds do
+		msg = channel_receive(to_pong)
+		channel_send(to_ping, msg[1] + 1)
+	end for
+end procedure
+
+printf(1, "Ping-pong Benchmark: %d rounds, %d idle tasks\n", {nrounds, nidle})
+
+for i = 1 to nidle do
+	task_schedule(task_create(routine_id("idler"), {}), 1)
+end for
+
+task_schedule(task_create(routine_id("poll_pong"), {}), 1)
+t0 = time()
+for i = 1 to nrounds do
+	turn = 1
+	while turn != 0 do
+		task_yield()
+	end while
+end for
+report("polling", time() - t0)
+
+-- from here on the idle tasks wait for the event instead of polling
+polling = 0
+while waiting < nidle do
+	task_yield()
+end while
+
+task_schedule(task_create(routine_id("sem_pong"), {}), 1)
+t0 = time()
+for i = 1 to nrounds do
+	semaphore_signal(ping)
+	semaphore_wait(pong)
+end for
+report("semaphores", time() - t0)
+
+task_schedule(task_create(routine_id("chan_pong"), {}), 1)
+t0 = time()
+sequence msg
+for i = 1 to nrounds do
+	channel_send(to_pong, i)
+	msg = channel_receive(to_ping)
+end for
+report("channels", time() - t0)
+
+event_set(done)
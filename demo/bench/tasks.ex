@@ -0,0 +1,88 @@
+--****
+-- === bench/tasks.ex
+--
+-- Task scheduler benchmark
+--
+-- ==== Usage
+-- {{{
+--     eui tasks <tasks> <yields>
+-- }}}
+--
+-- default is 100000 tasks that each yield 10 times
+--
+-- Creates a large number of tasks, some time-shared and some real-time,
+-- and lets each of them call [[:task_yield]] in a loop until it is done.
+-- The time per switch should stay about the same however many tasks
+-- there are. The time to look up every task with [[:task_status]] is
+-- shown too.
+--
+
+without type_check
+include std/get.e
+
+function init()
+	object arg
+	sequence cmd
+	integer ntasks = 100_000
+	integer nyields = 10
+
+	cmd = command_line()
+	if length(cmd) >= 3 then
+		arg = value(cmd[3])
+		if arg[1] = GET_SUCCESS then
+			ntasks = arg[2]
+		end if
+	end if
+	if length(cmd) >= 4 then
+		arg = value(cmd[4])
+		if arg[1] = GET_SUCCESS then
+			nyields = arg[2]
+		end if
+	end if
+
+	return {ntasks, nyields}
+end function
+
+integer switches = 0
+
+procedure worker(integer nyields)
+	for i = 1 to nyields do
+		switches += 1
+		task_yield()
+	end for
+end procedure
+
+sequence params = init()
+integer ntasks = params[1]
+integer nyields = params[2]
+sequence tids = repeat(0, ntasks)
+atom t0, t
+
+printf(1, "Task Benchmark: %d tasks, %d yields each\n", {ntasks, nyields})
+
+t0 = time()
+for i = 1 to ntasks do
+	tids[i] = task_create(routine_id("worker"), {nyields})
+	if remainder(i, 10) = 0 then
+		-- every tenth one is real-time, due within a second
+		task_schedule(tids[i], {0, remainder(i, 100) / 100})
+	else
+		task_schedule(tids[i], 1 + remainder(i, 3))
+	end if
+end for
+printf(1, "create and schedule  %7.3f s\n", time() - t0)
+
+t0 = time()
+integer active = 0
+for i = 1 to ntasks do
+	active += task_status(tids[i]) = 1
+end for
+printf(1, "task_status, all     %7.3f s  (%d active)\n", {time() - t0, active})
+
+t0 = time()
+while switches < ntasks * nyields do
+	task_yield()
+end while
+t = time() - t0
+printf(1, "run to completion    %7.3f s  %10.0f switches/s\n",
+	{t, switches / (t + 1e-9)})
@@ -0,0 +1,117 @@
+// Two Euphoria runtime contexts on two threads.
+//
+// One thread packs sequences of numbers into bytes with array_to_bytes()'s
+// backend routine and sends them through a channel; the other unpacks and
+// adds them up.  Each thread has its own context, and so its own storage
+// cache, task scheduler and conversion buffers.  Only C code runs in the
+// contexts: two Euphoria programs can't yet run at once (see be_context.h).
+//
+// Build the backend library with ./configure --reentrant, then from this
+// directory:
+//
+//     gcc -I../../source contexts.c ../../source/build/eu.a -lm -lpthread -ldl
+//
+// and run ./a.out
+
+#include <stdio.h>
+#include <pthread.h>
+
+#include "alldefs.h"
+#include "be_alloc.h"
+#include "be_runtime.h"
+#include "be_binary.h"
+#include "be_task.h"
+#include "be_context.h"
+
+#define ROUNDS 2000
+#define COUNT  1000
+
+int Argc = 0;
+char **Argv = NULL;
+struct routine_list _00[] = {{0}};
+
+static struct channel *packed;
+static double received_sum;
+
+static void *packer(void *arg)
+{
+	struct eu_context *ctx;
+	s1_ptr values, args;
+	int r, i;
+
+	ctx = eu_context_new();
+	eu_context_enter(ctx);
+	InitTask();
+
+	for (r = 0; r < ROUNDS; r++) {
+		values = NewS1(COUNT);
+		for (i = 1; i <= COUNT; i++)
+			values->base[i] = NewDouble(r + i * 0.5);
+		args = NewS1(3);
+		args->base[1] = C_DOUBLE;
+		args->base[2] = MAKE_SEQ(values);
+		args->base[3] = ATOM_0;
+		eu_channel_send(packed, encode_array_to(MAKE_SEQ(args)));
+		DeRefDS(MAKE_SEQ(args));
+	}
+	eu_channel_close(packed);
+
+	eu_context_enter(NULL);
+	eu_context_free(ctx);
+	return NULL;
+}
+
+static void *unpacker(void *arg)
+{
+	struct eu_context *ctx;
+	s1_ptr args, values;
+	object bytes, result;
+	int i;
+
+	ctx = eu_context_new();
+	eu_context_enter(ctx);
+	InitTask();
+
+	while (eu_channel_receive(packed, &bytes)) {
+		args = NewS1(4);
+		args->base[1] = bytes;
+		args->base[2] = C_DOUBLE;
+		args->base[3] = -1;
+		args->base[4] = ATOM_0;
+		result = decode_array_from(MAKE_SEQ(args));
+		values = SEQ_PTR(result);
+		for (i = 1; i <= values->length; i++)
+			received_sum += DBL_PTR(values->base[i])->dbl;
+		DeRefDS(result);
+		DeRefDS(MAKE_SEQ(args));
+	}
+
+	eu_context_enter(NULL);
+	eu_context_free(ctx);
+	return NULL;
+}
+
+int main()
+{
+	pthread_t a, b;
+	double expected;
+	int r, i;
+
+	InitEMalloc();
+	InitTask();
+
+	packed = eu_channel_new(8);
+	pthread_create(&a, NULL, packer, NULL);
+	pthread_create(&b, NULL, unpacker, NULL);
+	pthread_join(a, NULL);
+	pthread_join(b, NULL);
+	eu_channel_delete(packed);
+
+	expected = 0.0;
+	for (r = 0; r < ROUNDS; r++)
+		for (i = 1; i <= COUNT; i++)
+			expected += r + i * 0.5;
+	printf("sum %.1f, expected %.1f: %s\n", received_sum, expected,
+		   received_sum == expected ? "ok" : "WRONG");
+	return received_sum != expected;
+}
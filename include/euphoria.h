@@ -351,8 +351,6 @@ void Replace(replace_ptr rb);
 void UserCleanup(int);
 
 // from be_task.h
-extern int tcb_size;
-extern int current_task;
 extern double clock_period;
 #ifdef EWINDOWS
 #include <windows.h>
@@ -360,22 +358,33 @@ extern double clock_period;
 // Address to a fiber:
 #define TASK_HANDLE LPVOID
 
-#else
+#elif defined(EOSX)
 
 #include <pthread.h>
 
 // PThread handle:
 #define TASK_HANDLE pthread_t
 
+#else
+
+// Translated tasks are coroutines, each with a stack of its own
+#define TASK_COROUTINES
+
+// Address of its saved context:
+#define TASK_HANDLE void *
+
 #endif
 
+struct stack_segment;
+
 struct interpreted_task{
 	intptr_t *pc;         // program counter for this task
-	object_ptr expr_stack; // call stack for this task
-	object_ptr expr_max;   // current top limit of stack
-	object_ptr expr_limit; // don't start a new routine above this
-	object_ptr expr_top;   // stack pointer
-	int stack_size;        // current size of stack
+	object_ptr stack;       // call stack for this task (its current segment)
+	struct stack_segment *segment; // the segment stack is in
+	object_ptr stack_max;   // current top limit of stack
+	object_ptr stack_limit; // don't start a new routine above this
+	object_ptr stack_top;   // stack pointer
+	int stack_length;       // current size of stack
 };
 
 struct translated_task{
@@ -383,8 +392,10 @@ struct translated_task{
 	
 };
 
+struct wait_queue;
+
 // Task Control Block - sync with euphoria\include\euphoria.h
-struct tcb {
+struct tcb_entry {
 	int rid;         // routine id
 	double tid;      // external task id
 	int type;        // type of task: T_REAL_TIME or T_TIME_SHARED
@@ -397,7 +408,7 @@ struct tcb {
 	double max_time; // maximum activation time (determines task order)
 	int runs_left;   // number of executions left in this burst
 	int runs_max;    // maximum number of executions in one burst
-	int next;        // index of next task of the same kind
+	int next;        // index of next task on the same queue
 	object args;     // args to call task procedure with at startup
 	
 	int mode;  // TRANSLATED_TASK or INTERPRETED_TASK
@@ -406,16 +417,29 @@ struct tcb {
 		struct translated_task translated;
 	} impl;
 	
+	int prev;        // index of previous task on the same time-share queue
+	int queue;       // which scheduler queue the task is on, if any
+	int heap_pos;    // position in the real-time heap
+	struct wait_queue *waiting; // the wait queue it's on, if queue is Q_WAIT
+	int woken;       // was it handed what it waited for when woken?
+	uintptr_t unit_of; // while woken, the semaphore whose unit it was handed
+
+	// statistics, for task_stats()
+	double run_start;  // when its current or last run began
+	double cpu_time;   // seconds it has run for
+	double runs;       // number of times it has been run
+	double late_total; // seconds its runs began after max_time, in all
+	double late_max;   // ... and at most
+	double waited;     // seconds the scheduler waited before running it
 };
 
-extern struct tcb *tcb;
-
 // TASK API:
 void task_yield();
 void task_schedule(object task, object sparams);
 void task_suspend(object a);
 object task_list();
 object task_status(object a);
+object task_self();
 void task_clock_stop();
 void task_clock_start();
 object ctask_create(object r_id, object args);
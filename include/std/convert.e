@@ -17,7 +17,9 @@ constant
 	M_A_TO_F32 = 48,
 	M_F32_TO_A = 49,
 	M_F80_TO_A = 101,
-	M_A_TO_F80 = 105
+	M_A_TO_F80 = 105,
+	M_DECODE_ARRAY = 130,
+	M_ENCODE_ARRAY = 131
 
 
 constant M_ALLOC = 16
@@ -370,6 +372,67 @@ public function float32_to_atom(sequence_4 ieee32)
 	return machine_func(M_F32_TO_A, ieee32)
 end function
 
+--**
+-- Convert a sequence of bytes to an array of fixed size numbers
+--
+-- Parameters:
+-- 		# ##bytes## : the sequence of bytes to convert
+--		# ##elem_type## : the type of each number, one of the C_ types from std/dll.e,
+--        such as ##C_INT##, ##C_USHORT##, ##C_LONGLONG## or ##C_DOUBLE##
+--		# ##big_endian## : an integer, non-zero if the most significant byte comes
+--        first. The default, 0, is little endian, as on Intel processors.
+--
+-- Returns:
+--		A **sequence**, of atoms. Bytes left over at the end, too few
+--      for one more number, are ignored.
+--
+-- Comments:
+-- The whole sequence is converted natively in one call. This is much faster
+-- than calling [[:bytes_to_int]] or [[:float64_to_atom]] for each number.
+--
+-- Example 1:
+-- <eucode>
+-- s = bytes_to_array({1,0,0,0, 255,255,255,255}, C_INT)
+-- -- s is {1, -1}
+-- s = bytes_to_array({1,0,0,0, 255,255,255,255}, C_UINT)
+-- -- s is {1, 4294967295}
+-- </eucode>
+--
+-- See Also:
+--		[[:array_to_bytes]], [[:get_array]], [[:bytes_to_int]], [[:float64_to_atom]]
+
+public function bytes_to_array(sequence bytes, atom elem_type, integer big_endian = 0)
+	return machine_func(M_DECODE_ARRAY, {bytes, elem_type, -1, big_endian})
+end function
+
+--**
+-- Convert an array of numbers to a sequence of bytes, each number taking a fixed size
+--
+-- Parameters:
+-- 		# ##values## : the sequence of atoms to convert
+--		# ##elem_type## : the type of each number, one of the C_ types from std/dll.e
+--		# ##big_endian## : an integer, non-zero if the most significant byte should
+--        come first. The default, 0, is little endian.
+--
+-- Returns:
+--		A **sequence**, of ##length(values)## times the size of ##elem_type## bytes.
+--
+-- Comments:
+-- Integers that don't fit in ##elem_type## keep their lowest bytes, as with [[:poke4]].
+--
+-- Example 1:
+-- <eucode>
+-- s = array_to_bytes({1, 2}, C_USHORT, 1)
+-- -- s is {0,1, 0,2}
+-- </eucode>
+--
+-- See Also:
+--		[[:bytes_to_array]], [[:put_array]], [[:int_to_bytes]], [[:atom_to_float64]]
+
+public function array_to_bytes(sequence values, atom elem_type, integer big_endian = 0)
+	return machine_func(M_ENCODE_ARRAY, {elem_type, values, big_endian})
+end function
+
 --**
 -- Convert a text representation of a hexadecimal number to an atom
 -- Parameters:
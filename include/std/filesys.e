@@ -27,6 +27,9 @@ end ifdef
 
 constant
 	M_DIR	      = 22,
+	M_WALK_OPEN   = 125,
+	M_WALK_NEXT   = 126,
+	M_WALK_CLOSE  = 127,
 	M_CURRENT_DIR = 23,
 	M_CHDIR       = 63
 
@@ -639,6 +642,136 @@ public function walk_dir(sequence path_name, object your_function, integer scan_
 	return 0
 end function
 
+ifdef not UNIX then
+	-- walks that are in progress: {directories still to read, with_stat, batch_size}
+	sequence walks = {}
+end ifdef
+
+--**
+-- Start walking through every file and directory in a tree.
+--
+-- Parameters:
+-- 		# ##path_name## : a sequence, the directory at the top of the tree
+--		# ##with_stat## : an integer. If zero, the default, only names and
+--		  the ##'d'## attribute of directories are returned. Otherwise the
+--		  sizes and dates are filled in as well, as [[:dir]] does.
+--		# ##batch_size## : an integer, the most entries that [[:walk_next]]
+--		  returns at a time. The default is 1024.
+--		# ##threads## : an integer, the number of threads that look up sizes and
+--		  dates. The default, 0, means one per processor.
+--
+-- Returns:
+-- 		An **atom**, the walk, or -1 if ##path_name## is not a directory.
+--
+-- Comments:
+--
+-- Unlike [[:walk_dir]](), this doesn't call a routine for each entry and
+-- doesn't list each whole directory first. The tree is read natively and the
+-- entries come back from [[:walk_next]]() in batches. This keeps memory use low
+-- even for trees of millions of files.
+--
+-- Finding out what is a directory needs no ##stat()## call on most Unix file
+-- systems. A walk without ##with_stat## therefore only reads the directories
+-- themselves. This is much faster than a walk that looks up the sizes and
+-- dates.
+--
+-- Symbolic links to directories are returned, but not followed. The entries
+-- are not in any particular order.
+--
+-- Example 1:
+-- <eucode>
+-- atom walk = walk_open("/home")
+-- sequence batch = walk_next(walk)
+-- while length(batch) do
+--     for i = 1 to length(batch) do
+--         puts(1, batch[i][D_NAME] & '\n')   -- the whole path
+--     end for
+--     batch = walk_next(walk)
+-- end while
+-- </eucode>
+--
+-- See Also:
+--   [[:walk_next]], [[:walk_close]], [[:walk_dir]], [[:dir]]
+
+public function walk_open(sequence path_name, integer with_stat = 0, integer batch_size = 1024, integer threads = 0)
+	ifdef UNIX then
+		return machine_func(M_WALK_OPEN, {path_name, with_stat != 0, batch_size, threads})
+	elsedef
+		path_name = text:trim_tail(match_replace('/', path_name, '\\'), {' ', SLASH, '\n'})
+		if atom(dir(path_name)) then
+			return -1
+		end if
+		walks = append(walks, {{path_name}, with_stat, batch_size})
+		return length(walks)
+	end ifdef
+end function
+
+--**
+-- Get the next batch of entries from a walk.
+--
+-- Parameters:
+-- 		# ##walk## : an atom, a walk from [[:walk_open]]
+--
+-- Returns:
+-- 		A **sequence**, of entries like those from [[:dir]], except that ##D_NAME## is
+--		the whole path. The sequence is empty once the whole tree has been walked.
+--
+-- See Also:
+--   [[:walk_open]], [[:walk_close]]
+
+public function walk_next(atom walk)
+	ifdef UNIX then
+		return machine_func(M_WALK_NEXT, walk)
+	elsedef
+		sequence entries = {}, path
+		object d
+
+		while length(entries) < walks[walk][3] and length(walks[walk][1]) do
+			path = walks[walk][1][$]
+			walks[walk][1] = walks[walk][1][1 .. $-1]
+			d = dir(path)
+			if atom(d) then
+				continue
+			end if
+			for i = 1 to length(d) do
+				if eu:find(d[i][D_NAME], {".", ".."}) then
+					continue
+				end if
+				d[i][D_NAME] = path & SLASH & d[i][D_NAME]
+				if eu:find('d', d[i][D_ATTRIBUTES]) then
+					walks[walk][1] = append(walks[walk][1], d[i][D_NAME])
+				end if
+				if not walks[walk][2] then
+					d[i][D_SIZE .. $] = 0
+				end if
+				entries = append(entries, d[i])
+			end for
+		end while
+		return entries
+	end ifdef
+end function
+
+--**
+-- Stop a walk before it has finished.
+--
+-- Parameters:
+-- 		# ##walk## : an atom, a walk from [[:walk_open]]
+--
+-- Comments:
+-- 		A walk that has been read to the end stops by itself, and a walk
+--		that is no longer used is stopped when it is garbage collected.
+--
+-- See Also:
+--   [[:walk_open]], [[:walk_next]]
+
+public procedure walk_close(atom walk)
+	ifdef UNIX then
+		machine_proc(M_WALK_CLOSE, walk)
+	elsedef
+		walks[walk][1] = {}
+	end ifdef
+end procedure
+
 --**
 -- Create a new directory.
 --
@@ -5,12 +5,21 @@
 --
 namespace stdhash
 
+include std/io.e
+
+constant
+	M_HASH_INIT   = 107,
+	M_HASH_UPDATE = 108,
+	M_HASH_FINAL  = 109
+
 --****
 -- === Type Constants
 --
 
 public enum
-	HSIEH30 = -6,
+	XXHASH64 = -8,
+	CRC32C,
+	HSIEH30,
 	HSIEH32,
 	ADLER32,
 	FLETCHER32,
@@ -31,6 +40,9 @@ public enum
 -- Parameters:
 --		# ##source## : Any Euphoria object
 --		# ##algo## : A code indicating which algorithm to use.
+-- ** XXHASH64 uses xxHash64. Returns a 64-bit value. Very fast on long data and excellent dispersion
+-- ** CRC32C uses CRC-32C (Castagnoli). Returns a 32-bit value. Very fast, using the
+--            SSE4.2 crc32 instruction where the processor has one, and good dispersion
 -- ** HSIEH30 uses Hsieh. Returns a 30-bit (a Euphoria integer). Fast and good dispersion
 -- ** HSIEH32 uses Hsieh. Returns a 32-bit value. Fast and very good dispersion
 -- ** ADLER32 uses Adler. Very fast and reasonable dispersion, especially for small strings
@@ -47,7 +59,8 @@ public enum
 --
 -- Returns:
 --     An **atom**,
---        Except for the HSIEH30, MD5 and SHA256 algorithms, this is a 32-bit integer.\\
+--        Except for the HSIEH30, XXHASH64, MD5 and SHA256 algorithms, this is a 32-bit integer.
+--        XXHASH64 returns a 64-bit integer.\\
 --     An **integer**,
 --        Except for the HSIEH30 algorithms, this is a 30-bit integer.\\
 --     A **sequence**,
@@ -56,6 +69,12 @@ public enum
 --
 -- Comments:
 -- * For //algo// values from zero to less than 1, that actual value used is (algo + 69096). 
+-- * CRC32C and XXHASH64 of a sequence of bytes give the standard CRC-32C and
+--   xxHash64 (seed 0) values, so they can be checked against other programs. Any
+--   other object is hashed by walking its elements, with integer valued atoms
+--   hashing the same as the equivalent integers.
+-- * On 32-bit platforms the 64-bit XXHASH64 value is rounded to the precision of
+--   an atom.
 --
 -- Example 1:
 -- <eucode>
@@ -71,3 +90,145 @@ public enum
 -- ? hash(1.23,                                          99        ) --> 3808916725
 -- ? hash({1, {2,3, {4,5,6}, 7}, 8.9},                   99        ) -->  526266621
 -- </eucode>
+
+--****
+-- === Incremental Hashing
+--
+-- [[:hash]] needs all of the data in memory at once. These routines let
+-- the data be fed in a piece at a time instead, which is how a large file
+-- or a network stream is hashed.
+--
+-- <eucode>
+-- atom state = hash_init(SHA256)
+-- integer fn = open("big.iso", "rb")
+-- sequence chunk = get_bytes(fn, 65536)
+-- while length(chunk) do
+--     hash_update(state, chunk)
+--     chunk = get_bytes(fn, 65536)
+-- end while
+-- close(fn)
+-- ? hash_final(state)
+-- </eucode>
+
+--**
+-- Start an incremental hash calculation.
+--
+-- Parameters:
+--		# ##algo## : one of SHA256, MD5, FLETCHER32, ADLER32, HSIEH32, HSIEH30,
+--                   CRC32C or XXHASH64.
+--
+-- Returns:
+--     An **atom**, the state of the calculation, to pass to [[:hash_update]]
+--     and [[:hash_final]]. The state is freed when the atom is no longer used.
+--
+-- Errors:
+--     Any other value of ##algo## causes a runtime error. The cyclic variants
+--     of [[:hash]] work on Euphoria objects rather than bytes, so they have
+--     no incremental form.
+--
+-- Comments:
+-- For a sequence of bytes, the incremental FLETCHER32, ADLER32, CRC32C and
+-- XXHASH64 values are the same as the ones returned by [[:hash]]. [[:hash]] seeds Hsieh with the
+-- length of the data, which isn't known in advance here, so HSIEH32 and
+-- HSIEH30 start from zero and give different values.
+--
+-- MD5 and SHA256 return the standard digest, as a sequence of 4 (MD5) or 8
+-- (SHA256) 32-bit words. Printing each word with ##"%08x"## gives the usual
+-- hexadecimal form of the digest.
+--
+-- See Also:
+--     [[:hash_update]], [[:hash_final]], [[:hash_file]]
+
+public function hash_init(integer algo)
+	return machine_func(M_HASH_INIT, algo)
+end function
+
+--**
+-- Add more data to an incremental hash calculation.
+--
+-- Parameters:
+--		# ##state## : the atom returned by [[:hash_init]].
+--		# ##data## : either a sequence of bytes, or the address of a block of memory.
+--		# ##count## : the number of bytes at ##data## when it is an address.
+--
+-- Errors:
+--     ##data## must not contain anything other than integers from 0 to 255.
+--
+-- Comments:
+-- Hashing straight from memory avoids building a sequence at all, for
+-- instance when the data came from [[:allocate]]d buffers or a C library.
+--
+-- Example 1:
+-- <eucode>
+-- atom state = hash_init(MD5)
+-- hash_update(state, "The quick brown fox ")
+-- hash_update(state, "jumps over the lazy dog")
+-- printf(1, "%08x%08x%08x%08x\n", hash_final(state))
+-- -- 9e107d9d372bb6826bd81d3542a419d6
+-- </eucode>
+--
+-- See Also:
+--     [[:hash_init]], [[:hash_final]]
+
+public procedure hash_update(atom state, object data, integer count = 0)
+	machine_proc(M_HASH_UPDATE, {state, data, count})
+end procedure
+
+--**
+-- Get the hash of everything added to an incremental hash calculation.
+--
+-- Parameters:
+--		# ##state## : the atom returned by [[:hash_init]].
+--
+-- Returns:
+--     An **object**, the same kind of value that [[:hash]] returns for the
+--     algorithm: a sequence for MD5 and SHA256, otherwise an atom.
+--
+-- Comments:
+-- The state is not changed, so more data can be added afterwards to get the
+-- hash of a longer stream.
+--
+-- See Also:
+--     [[:hash_init]], [[:hash_update]]
+
+public function hash_final(atom state)
+	return machine_func(M_HASH_FINAL, state)
+end function
+
+--**
+-- Hash the contents of a file.
+--
+-- Parameters:
+--		# ##filename## : the name of the file.
+--		# ##algo## : one of the algorithms accepted by [[:hash_init]].
+--
+-- Returns:
+--     An **object**, the hash of the file as [[:hash_final]] returns it, or
+--     -1 if the file could not be opened.
+--
+-- Comments:
+-- The file is read a block at a time, so it doesn't matter how big it is.
+--
+-- See Also:
+--     [[:hash_init]]
+
+public function hash_file(sequence filename, integer algo)
+	integer fn
+	atom state
+	sequence chunk
+
+	fn = open(filename, "rb")
+	if fn = -1 then
+		return -1
+	end if
+
+	state = hash_init(algo)
+	chunk = io:get_bytes(fn, 65536)
+	while length(chunk) do
+		hash_update(state, chunk)
+		chunk = io:get_bytes(fn, 65536)
+	end while
+	close(fn)
+
+	return hash_final(state)
+end function
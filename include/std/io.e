@@ -15,7 +15,14 @@ constant M_SEEK  = 19,
 		 M_WHERE = 20,
 		 M_FLUSH = 60,
 		 M_LOCK_FILE = 61,
-		 M_UNLOCK_FILE = 62
+		 M_UNLOCK_FILE = 62,
+		 M_GET_BYTES = 115,
+		 M_GETS_MANY = 116,
+		 M_LINES_OPEN = 117,
+		 M_LINES_NEXT = 118,
+		 M_LINES_CLOSE = 119,
+		 M_READ_ARRAY = 128,
+		 M_WRITE_ARRAY = 129
 
 --****
 -- === Constants
@@ -381,7 +388,125 @@ public constant EOF = (-1)
 -- See Also:
 --		[[:getc]], [[:read_lines]]
 
-constant CHUNK = 100
+--**
+-- Read several lines from a file at once.
+--
+-- Parameters:
+--		# ##fn## : an integer, the handle to an open file to read from.
+--		# ##n## : a positive integer, the largest number of lines to return.
+--
+-- Returns:
+--		A **sequence**, of at most ##n## lines. Each line is a sequence of bytes
+--      **without** its end of line marker.
+--
+-- Comments:
+--   When fewer than ##n## lines are returned the end of the file has been
+--   reached. After that an empty sequence is returned.
+--
+--   Reading many lines per call avoids most of the per line work of [[:gets]],
+--   which makes a big difference when reading large files one line at a time.
+--
+-- Example 1:
+-- <eucode>
+-- integer fn = open("server.log", "r")
+-- sequence lines
+-- while length(lines) with entry do
+--     for i = 1 to length(lines) do
+--         if match("ERROR", lines[i]) then
+--             puts(1, lines[i] & '\n')
+--         end if
+--     end for
+-- entry
+--     lines = gets_many(fn, 1000)
+-- end while
+-- close(fn)
+-- </eucode>
+--
+-- See Also:
+--		[[:gets]], [[:read_lines]]
+
+public function gets_many(integer fn, integer n)
+	if n <= 0 then
+		return {}
+	end if
+
+	return machine_func(M_GETS_MANY, {fn, n})
+end function
+
+--**
+-- Open a file for reading its lines in batches.
+--
+-- Parameters:
+--		# ##file_name## : a sequence, the path of the file to read.
+--		# ##batch_size## : a positive integer, the number of lines returned
+--                          by each call to [[:next_lines]]. The default is 1024.
+--
+-- Returns:
+--		An **atom**, a line stream to pass to [[:next_lines]], or -1 if the file
+--      can't be opened.
+--
+-- Comments:
+--   Unlike [[:read_lines]], a line stream never holds more than one batch of
+--   lines in memory, so it can work through files of any size. The file is
+--   read through a large buffer and closed as soon as its last line has been
+--   returned, or by [[:close_lines]], or when the line stream is no longer
+--   referenced.
+--
+--   The file is read as text, the same way that [[:read_lines]] reads it.
+--
+-- Example 1:
+-- <eucode>
+-- atom log = open_lines("huge.log", 10_000)
+-- integer errors = 0
+-- sequence lines
+-- while length(lines) with entry do
+--     for i = 1 to length(lines) do
+--         errors += match("ERROR", lines[i]) != 0
+--     end for
+-- entry
+--     lines = next_lines(log)
+-- end while
+-- </eucode>
+--
+-- See Also:
+--		[[:next_lines]], [[:close_lines]], [[:gets_many]], [[:read_lines]]
+
+public function open_lines(sequence file_name, integer batch_size = 1024)
+	return machine_func(M_LINES_OPEN, {file_name, batch_size})
+end function
+
+--**
+-- Return the next batch of lines from a line stream.
+--
+-- Parameters:
+--		# ##lines## : an atom, a line stream returned by [[:open_lines]].
+--
+-- Returns:
+--		A **sequence**, of at most the batch size lines, each **without** its end of
+--      line marker. An empty sequence means that the whole file has been read.
+--
+-- See Also:
+--		[[:open_lines]], [[:close_lines]]
+
+public function next_lines(atom lines)
+	return machine_func(M_LINES_NEXT, lines)
+end function
+
+--**
+-- Close the file of a line stream before all of its lines have been read.
+--
+-- Parameters:
+--		# ##lines## : an atom, a line stream returned by [[:open_lines]].
+--
+-- Comments:
+--   After this [[:next_lines]] returns an empty sequence.
+--
+-- See Also:
+--		[[:open_lines]], [[:next_lines]]
+
+public procedure close_lines(atom lines)
+	machine_proc(M_LINES_CLOSE, lines)
+end procedure
 
 --**
 -- Read the next bytes from a file.
@@ -402,6 +527,9 @@ constant CHUNK = 100
 --  This avoids the confusing situation in text mode where //Windows// will convert CR LF 
 --  pairs to LF.
 --
+--  The bytes are read with a single call to the C library, so asking for a
+--  large ##n## is much faster than calling [[:getc]] ##n## times.
+--
 -- Example 1:
 --     <eucode>
 --
@@ -429,41 +557,11 @@ constant CHUNK = 100
 -- 		[[:getc]], [[:gets]], [[:get_integer32]], [[:get_dstring]]
 
 public function get_bytes(integer fn, integer n)
-	sequence s
-	integer c, first, last
-
-	if n = 0 then
+	if n <= 0 then
 		return {}
 	end if
 
-	c = getc(fn)
-	if c = EOF then
-		return {}
-	end if
-
-	s = repeat(c, n)
-
-	last = 1
-	while last < n do
-		-- for speed, read a chunk without checking for EOF
-		first = last+1
-		last  = last+CHUNK
-		if last > n then
-			last = n
-		end if
-		for i = first to last do
-			s[i] = getc(fn)
-		end for
-		-- check for EOF after each chunk
-		if s[last] = EOF then
-			-- trim the EOF's and return
-			while s[last] = EOF do
-				last -= 1
-			end while
-			return s[1..last]
-		end if
-	end while
-	return s
+	return machine_func(M_GET_BYTES, {fn, n})
 end function
 
 
@@ -609,6 +707,69 @@ public procedure put_integer16(integer fh, atom val)
 	puts(fh, peek({mem0,2}))
 end procedure
 
+--**
+-- Read an array of fixed size binary numbers from a file.
+--
+-- Parameters:
+--		# ##fh## : an integer, the handle to an open file to read from.
+--		# ##elem_type## : the type of each number, one of the C_ types from std/dll.e,
+--        such as ##C_INT##, ##C_USHORT##, ##C_LONGLONG## or ##C_DOUBLE##
+--		# ##n## : an integer, the most numbers to read. The default, -1, reads
+--        to the end of the file.
+--		# ##big_endian## : an integer, non-zero if the most significant byte comes
+--        first. The default, 0, is little endian, as on Intel processors.
+--
+-- Returns:
+--		A **sequence**, of the atoms that were read. It is shorter than ##n## at the
+--      end of the file.
+--
+-- Comments:
+--     * This function is normally used with files opened in binary mode, "rb".
+--     * The numbers are read and converted natively, in large blocks. This is
+--       far faster than calling [[:get_integer32]] for each one.
+--
+-- Example 1:
+--     <eucode>
+--     integer fn = open("samples.dat", "rb")
+--     sequence header = get_array(fn, C_INT, 4)
+--     sequence samples = get_array(fn, C_DOUBLE)
+--     </eucode>
+--
+-- See Also:
+-- 		[[:put_array]], [[:get_integer32]], [[:bytes_to_array]]
+
+public function get_array(integer fh, atom elem_type, integer n = -1, integer big_endian = 0)
+	return machine_func(M_READ_ARRAY, {fh, elem_type, n, big_endian})
+end function
+
+--**
+-- Write an array of numbers to a file, each one as a fixed size binary number.
+--
+-- Parameters:
+--		# ##fh## : an integer, the handle to an open file to write to.
+--		# ##elem_type## : the type of each number, one of the C_ types from std/dll.e
+--		# ##values## : a sequence of atoms
+--		# ##big_endian## : an integer, non-zero if the most significant byte should
+--        come first. The default, 0, is little endian.
+--
+-- Comments:
+--     * This function is normally used with files opened in binary mode, "wb".
+--     * Integers that don't fit in ##elem_type## keep their lowest bytes, as with
+--       [[:put_integer32]].
+--
+-- Example 1:
+--     <eucode>
+--     integer fn = open("samples.dat", "wb")
+--     put_array(fn, C_DOUBLE, {0.5, 1.5, 2.5})
+--     </eucode>
+--
+-- See Also:
+-- 		[[:get_array]], [[:put_integer32]], [[:array_to_bytes]]
+
+public procedure put_array(integer fh, atom elem_type, sequence values, integer big_endian = 0)
+	machine_proc(M_WRITE_ARRAY, {fh, elem_type, values, big_endian})
+end procedure
+
 --**
 -- Read a delimited byte string from an opened file .
 --
@@ -1101,6 +1262,8 @@ end procedure
 -- See Also:
 --		[[:gets]], [[:write_lines]], [[:read_file]]
 
+constant LINE_BATCH = 1024
+
 public function read_lines(object file)
 	object fn, ret, y
 	if sequence(file) then
@@ -1115,6 +1278,20 @@ public function read_lines(object file)
 	if fn < 0 then return -1 end if
 
 	ret = {}
+	if fn != 0 then
+		while length(y) with entry do
+			ret &= y
+		entry
+			y = machine_func(M_GETS_MANY, {fn, LINE_BATCH})
+		end while
+
+		if sequence(file) and length(file) != 0 then
+			close(fn)
+		end if
+
+		return ret
+	end if
+
 	while sequence(y) with entry do
 		if y[$] = '\n' then
 			y = y[1..$-1]
@@ -1180,11 +1357,15 @@ end function
 -- See Also:
 --		[[:gets]], [[:read_lines]], [[:read_file]]
 
+constant LINE_BLOCK = 65536
+
 public function process_lines(object file, integer proc, object user_data = 0)
 	integer fh
 	object aLine
 	object res
 	integer line_no = 0
+	sequence buf
+	integer first, nl, scan
 	
 	res = 0
 	if sequence(file) then
@@ -1200,6 +1381,55 @@ public function process_lines(object file, integer proc, object user_data = 0)
 		return -1 
 	end if
 	
+	if sequence(file) and length(file) != 0 then
+		-- Nobody else sees this file, so it can be read in large blocks
+		-- and split into lines here.
+		buf = {}
+		first = 1
+		scan = 1  -- where the search for the next new line goes on from
+		while first <= length(buf) + 1 do
+			nl = find('\n', buf, scan)
+			if nl = 0 then
+				aLine = machine_func(M_GET_BYTES, {fh, LINE_BLOCK})
+				if length(aLine) then
+					-- only the new bytes need searching, and the start of a
+					-- long line is only moved down once
+					if first > 1 then
+						buf = buf[first .. $]
+						first = 1
+					end if
+					scan = length(buf) + 1
+					buf &= aLine
+					continue
+				end if
+				if first > length(buf) then
+					exit
+				end if
+				-- the last line has no new line
+				nl = length(buf) + 1
+			end if
+
+			line_no += 1
+			aLine = buf[first .. nl - 1]
+			ifdef UNIX then
+				if nl <= length(buf) and length(aLine) then
+					if aLine[$] = '\r' then
+						aLine = aLine[1 .. $-1]
+					end if
+				end if
+			end ifdef
+			first = nl + 1
+			scan = first
+			res = call_func(proc, {aLine, line_no, user_data})
+			if not equal(res, 0) then
+				exit
+			end if
+		end while
+
+		close(fh)
+		return res
+	end if
+
 	while sequence(aLine) with entry do
 		line_no += 1
 		if length(aLine) then
@@ -1370,7 +1600,6 @@ public enum
 
 public function read_file(object file, integer as_text = BINARY_MODE)
 	integer fn
-	integer len
 	sequence ret
 
 	if sequence(file) then
@@ -1380,32 +1609,13 @@ public function read_file(object file, integer as_text = BINARY_MODE)
 	end if
 	if fn < 0 then return -1 end if
 
-	seek(fn, -1)
-	len = where(fn)
 	seek(fn, 0)
-
-	ret = repeat(0, len)
-	for i = 1 to len do
-		ret[i] = getc(fn)
-	end for
+	ret = machine_func(M_GET_BYTES, {fn, -1})
 
 	if sequence(file) then
 		close(fn)
 	end if
 
-	ifdef WINDOWS then
-		-- Remove any extra -1 (EOF) characters in case file
-		-- had been opened in Windows 'text mode'.
-		for i = len to 1 by -1 do
-			if ret[i] != -1 then
-				if i != len then
-					ret = ret[1 .. i]
-				end if
-				exit
-			end if
-		end for
-	end ifdef
-
 	if as_text = BINARY_MODE then
 		return ret
 	end if
@@ -40,6 +40,12 @@ include std/types.e
 
 integer FREE_ARRAY_RID
 
+constant
+	M_PEEK_GATHER  = 132,
+	M_PEEK_STRIDED = 133,
+	M_POKE_SCATTER = 134,
+	M_POKE_STRIDED = 135
+
 -- The number of bytes required to hold a pointer.  Documented later...
 ifdef EU4_0 then
 	--**
@@ -1340,6 +1346,117 @@ public function peek_wstring(atom addr)
 	return peek2u({addr, (ptr - addr) / 2})
 end function
 
+ifdef SAFE then
+	function element_size(atom elem_type)
+		if elem_type = dll:C_LONGLONG then
+			return 8
+		elsif elem_type = dll:C_POINTER then
+			return ADDRESS_LENGTH
+		end if
+		return and_bits(elem_type, #FF)
+	end function
+
+	procedure bad_access(atom a, integer action)
+		if action = memconst:A_READ then
+			error:crash("BAD PEEK at #%x", a)
+		end if
+		error:crash("BAD POKE at #%x", a)
+	end procedure
+
+	procedure check_addresses(sequence addresses, atom elem_type, integer action)
+		integer len = element_size(elem_type)
+
+		for i = 1 to length(addresses) do
+			if not memory:safe_address(addresses[i], len, action) then
+				bad_access(addresses[i], action)
+			end if
+		end for
+	end procedure
+
+	procedure check_strided(atom base, integer stride, integer count, atom elem_type, integer action)
+		integer len = element_size(elem_type)
+
+		if stride = len then
+			if count > 0 and not memory:safe_address(base, count * len, action) then
+				bad_access(base, action)
+			end if
+			return
+		end if
+		for i = 0 to count - 1 do
+			if not memory:safe_address(base + i * stride, len, action) then
+				bad_access(base + i * stride, action)
+			end if
+		end for
+	end procedure
+end ifdef
+
+--**
+-- Read one number from each of a list of addresses.
+--
+-- Parameters:
+--   # ##addresses## : a sequence of atoms, the addresses to read from
+--   # ##elem_type## : the type of each number, one of the C_ types from std/dll.e
+--
+-- Returns:
+--   A **sequence**, of the same length as ##addresses##, holding the value
+--   found at each of them.
+--
+-- Comments:
+-- This does in one call what would otherwise take a [[:peek4s]], [[:peek8u]]
+-- and so on for each address, such as when reading one field of many
+-- structures from their pointers.
+--
+-- Example 1:
+-- <eucode>
+-- -- the first C_INT field of each structure
+-- sequence ids = peek_gather(struct_pointers, C_INT)
+-- </eucode>
+--
+-- See Also:
+-- [[:peek_strided]], [[:poke_scatter]], [[:peek4s]]
+
+public function peek_gather(sequence addresses, atom elem_type)
+	ifdef SAFE then
+		check_addresses(addresses, elem_type, memconst:A_READ)
+	end ifdef
+	return machine_func(M_PEEK_GATHER, {addresses, elem_type})
+end function
+
+--**
+-- Read numbers spaced a fixed number of bytes apart.
+--
+-- Parameters:
+--   # ##base## : an atom, the address of the first number
+--   # ##stride## : an integer, the number of bytes from the start of one number
+--     to the start of the next
+--   # ##count## : an integer, how many numbers to read
+--   # ##elem_type## : the type of each number, one of the C_ types from std/dll.e
+--
+-- Returns:
+--   A **sequence**, of ##count## values.
+--
+-- Comments:
+-- The usual use is reading one field from an array of C structures, with
+-- ##stride## the size of the structure. With ##stride## equal to the size of
+-- ##elem_type## it reads a plain array, like ##peek4s({base, count})##
+-- but for any of the C_ types.
+--
+-- Example 1:
+-- <eucode>
+-- -- struct point { int x; double y; } points[100];  (16 bytes each)
+-- sequence ys = peek_strided(points + 8, 16, 100, C_DOUBLE)
+-- </eucode>
+--
+-- See Also:
+-- [[:peek_gather]], [[:poke_strided]]
+
+public function peek_strided(atom base, integer stride, integer count, atom elem_type)
+	ifdef SAFE then
+		check_strided(base, stride, count, elem_type, memconst:A_READ)
+	end ifdef
+	return machine_func(M_PEEK_STRIDED, {base, stride, count, elem_type})
+end function
+
 --****
 -- === Writing to Memory
 
@@ -1700,6 +1817,60 @@ public function poke_wstring(atom buffaddr, integer buffsize, sequence s)
 	return buffaddr
 end function
 
+--**
+-- Store one number at each of a list of addresses.
+--
+-- Parameters:
+--   # ##addresses## : a sequence of atoms, the addresses to write to
+--   # ##elem_type## : the type of each number, one of the C_ types from std/dll.e
+--   # ##values## : a sequence of atoms, one for each address
+--
+-- Comments:
+-- Integers that don't fit in ##elem_type## keep their lowest bytes, as with
+-- [[:poke4]].
+--
+-- Example 1:
+-- <eucode>
+-- -- clear the first C_INT field of each structure
+-- poke_scatter(struct_pointers, C_INT, repeat(0, length(struct_pointers)))
+-- </eucode>
+--
+-- See Also:
+-- [[:poke_strided]], [[:peek_gather]], [[:poke4]]
+
+public procedure poke_scatter(sequence addresses, atom elem_type, sequence values)
+	ifdef SAFE then
+		check_addresses(addresses, elem_type, memconst:A_WRITE)
+	end ifdef
+	machine_proc(M_POKE_SCATTER, {addresses, elem_type, values})
+end procedure
+
+--**
+-- Store numbers spaced a fixed number of bytes apart.
+--
+-- Parameters:
+--   # ##base## : an atom, the address to store the first number at
+--   # ##stride## : an integer, the number of bytes from the start of one number
+--     to the start of the next
+--   # ##elem_type## : the type of each number, one of the C_ types from std/dll.e
+--   # ##values## : a sequence of atoms
+--
+-- Example 1:
+-- <eucode>
+-- -- struct point { int x; double y; } points[3];  (16 bytes each)
+-- poke_strided(points + 8, 16, C_DOUBLE, {0.5, 1.5, 2.5})
+-- </eucode>
+--
+-- See Also:
+-- [[:poke_scatter]], [[:peek_strided]]
+
+public procedure poke_strided(atom base, integer stride, atom elem_type, sequence values)
+	ifdef SAFE then
+		check_strided(base, stride, length(values), elem_type, memconst:A_WRITE)
+	end ifdef
+	machine_proc(M_POKE_STRIDED, {base, stride, elem_type, values})
+end procedure
+
 --****
 -- === Memory Manipulation
 
@@ -67,7 +67,8 @@ enum
 	 VALUE_BUCKETS,  -- ==> bucket[] --> bucket = {key[], value[]}
 	 KEY_LIST   = 5, -- ==> Small map keys
 	 VALUE_LIST,     -- ==> Small map values
-	 FREE_LIST       -- ==> Small map freespace
+	 FREE_LIST,      -- ==> Small map freespace
+	 HASH_ALGO  = 7  -- ==> Large map's hash algorithm
 
 constant type_is_map   = "Eu:StdMap"
 
@@ -94,6 +95,7 @@ public constant SMALLMAP = 's'
 public constant LARGEMAP = 'L'
 
 integer threshold_size = 23
+integer map_hash_algo = stdhash:HSIEH30
 
 -- This is a improbable value used to initialize a small map's keys list. 
 constant init_small_map_key = -75960.358941
@@ -117,13 +119,14 @@ public type map(object obj_p)
 -- Must be a valid EuMem pointer.
 	if not eumem:valid(obj_p, "") then return 0 end if
 	
--- Large maps have six data elements:
+-- Large maps have seven data elements:
 --   (1) Data type magic value
 --   (2) Count of elements 
 --   (3) Number of slots being used
 --   (4) The map type
 --   (5) Key Buckets 
 --   (6) Value Buckets
+--   (7) The hash algorithm its keys were placed with
 -- A bucket contains one or more lists of items.
 
 -- Small maps have seven data elements:
@@ -156,6 +159,8 @@ public type map(object obj_p)
 		if atom(m_[KEY_BUCKETS]) 		then return 0 end if
 		if atom(m_[VALUE_BUCKETS]) 		then return 0 end if
 		if length(m_[KEY_BUCKETS]) != length(m_[VALUE_BUCKETS])	then return 0 end if
+		if length(m_) != 7 then return 0 end if
+		if not integer(m_[HASH_ALGO]) then return 0 end if
 	else
 		return 0
 	end if
@@ -192,13 +197,69 @@ constant maxInt = #3FFFFFFF
 --
 
 public function calc_hash(object key_p, integer max_hash_p)
-	integer ret_
+	atom ret_
 
-    ret_ = hash(key_p, stdhash:HSIEH30)
+    ret_ = hash(key_p, map_hash_algo)
 	return remainder(ret_, max_hash_p) + 1 -- 1-based
 
 end function
 
+-- the bucket a key goes in, in a large map made with algo_p
+function bucket_of(object key_p, integer max_hash_p, integer algo_p)
+	atom ret_
+
+	ret_ = hash(key_p, algo_p)
+	return remainder(ret_, max_hash_p) + 1 -- 1-based
+end function
+
+--**
+-- Gets or Sets the hashing algorithm used by [[:calc_hash]], and by large
+-- maps created from now on. Initially this is ##HSIEH30##.
+--
+-- Parameters:
+-- # ##new_algo_p## : If this is not zero then it **sets** the algorithm. It
+-- must be one of the ##std/hash.e## algorithms that return an atom:
+-- ##HSIEH30##, ##HSIEH32##, ##ADLER32##, ##FLETCHER32##, ##CRC32C## or ##XXHASH64##.
+--
+-- Returns:
+--  An **integer**, the current algorithm (when ##new_algo_p## is zero) or the
+-- old algorithm prior to setting it to ##new_algo_p##.
+--
+-- Comments:
+-- Each large map keeps the algorithm that was set when it was created, or
+-- when it grew from a small map into a large one, and goes on using it, so
+-- changing the algorithm doesn't affect the maps that exist already.
+--
+-- ##CRC32C## is a good choice for maps with string keys. It is the quickest
+-- on keys longer than a few characters, and on 64-bit platforms its values
+-- are always integers. ##XXHASH64## values generally need a floating point
+-- atom, which costs an allocation on every lookup.
+--
+-- Example 1:
+-- <eucode>
+-- include std/hash.e
+-- include std/map.e
+--
+-- map:hash_algorithm(CRC32C)
+-- map words = map:new()
+-- </eucode>
+
+public function hash_algorithm(integer new_algo_p = 0)
+	integer old_algo_ = map_hash_algo
+
+	if new_algo_p = 0 then
+		return map_hash_algo
+	end if
+
+	if not find(new_algo_p, {stdhash:HSIEH30, stdhash:HSIEH32, stdhash:ADLER32,
+			stdhash:FLETCHER32, stdhash:CRC32C, stdhash:XXHASH64}) then
+		error:crash("Unsupported hash algorithm given to map.e:hash_algorithm()")
+	end if
+	map_hash_algo = new_algo_p
+	return old_algo_
+
+end function
+
 --**
 -- Gets or Sets the threshold value that determines at what point a small map
 -- converts into a large map structure. Initially this has been set to 23,
@@ -266,6 +327,7 @@ public procedure rehash(integer the_map_p, integer requested_bucket_size_p = 0)
 	sequence new_keys
 	integer in_use
 	integer elem_count
+	integer algo_
 	
 	if eumem:ram_space[the_map_p][MAP_TYPE] = SMALLMAP then
 		return -- small maps are not hashed.
@@ -293,6 +355,7 @@ public procedure rehash(integer the_map_p, integer requested_bucket_size_p = 0)
 	new_val_buckets_ = repeat(repeat(0, threshold_size), size_)
 	
 	elem_count = eumem:ram_space[the_map_p][ELEMENT_COUNT]
+	algo_ = eumem:ram_space[the_map_p][HASH_ALGO]
 	in_use = 0
 	
 	eumem:ram_space[the_map_p] = 0
@@ -303,7 +366,7 @@ public procedure rehash(integer the_map_p, integer requested_bucket_size_p = 0)
 			value_ = old_val_buckets_[index][entry_idx]
 			
 			-- calc the key's new hash value.
-			index_2_ = calc_hash(key_, size_)
+			index_2_ = bucket_of(key_, size_, algo_)
 			
 			-- cache the relevant set of keys
 			new_keys = new_key_buckets_[index_2_]
@@ -342,7 +405,8 @@ public procedure rehash(integer the_map_p, integer requested_bucket_size_p = 0)
 	end for
 
 	eumem:ram_space[the_map_p] = { 
-		type_is_map, elem_count, in_use, LARGEMAP, new_key_buckets_, new_val_buckets_ 
+		type_is_map, elem_count, in_use, LARGEMAP, new_key_buckets_, new_val_buckets_,
+		algo_
 	}
 end procedure
 
@@ -384,7 +448,8 @@ public function new(integer initial_size_p = 690)
 		buckets_ = floor((initial_size_p + threshold_size - 1) / threshold_size)
 		buckets_ = primes:next_prime(buckets_)
 		
-		new_map_ = { type_is_map, 0, 0, LARGEMAP, repeat({}, buckets_), repeat({}, buckets_) }
+		new_map_ = { type_is_map, 0, 0, LARGEMAP, repeat({}, buckets_), repeat({}, buckets_),
+			map_hash_algo }
 	else
 		-- Return a small map
 		new_map_ = {
@@ -517,7 +582,8 @@ public function has(integer the_map_p, object the_key_p)
 	integer from_
 	
 	if eumem:ram_space[the_map_p][MAP_TYPE] = LARGEMAP then
-		index_ = calc_hash(the_key_p, length(eumem:ram_space[the_map_p][KEY_BUCKETS]))
+		index_ = bucket_of(the_key_p, length(eumem:ram_space[the_map_p][KEY_BUCKETS]),
+			eumem:ram_space[the_map_p][HASH_ALGO])
 		pos_ = find(the_key_p, eumem:ram_space[the_map_p][KEY_BUCKETS][index_])
 	else
 		if equal(the_key_p, init_small_map_key) then
@@ -587,7 +653,7 @@ public function get(integer the_map_p, object the_key_p, object default_value_p
 	if themap[MAP_TYPE] = LARGEMAP then
 		sequence thekeys
 		thekeys = themap[KEY_BUCKETS]
-		bucket_ = calc_hash(the_key_p, length(thekeys))
+		bucket_ = bucket_of(the_key_p, length(thekeys), themap[HASH_ALGO])
 		pos_ = find(the_key_p, thekeys[bucket_])
 		if pos_ > 0 then
 			return themap[VALUE_BUCKETS][bucket_][pos_]
@@ -705,7 +771,7 @@ public procedure put(integer the_map_p, object the_key_p, object the_value_p,
 	
 	eumem:ram_space[the_map_p] = 0
 	if map_data[MAP_TYPE] = LARGEMAP then
-		bucket_ = calc_hash(the_key_p,  length(map_data[KEY_BUCKETS]))
+		bucket_ = bucket_of(the_key_p,  length(map_data[KEY_BUCKETS]), map_data[HASH_ALGO])
 		index_ = find(the_key_p, map_data[KEY_BUCKETS][bucket_])
 		if index_ > 0 then
 			-- The the_value_p already exists.
@@ -971,7 +1037,7 @@ public procedure remove(map the_map_p, object the_key_p)
 	
 	temp_map_ = eumem:ram_space[the_map_p]
 	if temp_map_[MAP_TYPE] = LARGEMAP then
-		bucket_ = calc_hash(the_key_p, length(temp_map_[KEY_BUCKETS]))
+		bucket_ = bucket_of(the_key_p, length(temp_map_[KEY_BUCKETS]), temp_map_[HASH_ALGO])
 	
 		index_ = find(the_key_p, temp_map_[KEY_BUCKETS][bucket_])
 		if index_ != 0 then
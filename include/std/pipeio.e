@@ -14,7 +14,6 @@
 namespace pipeio
 
 include std/dll.e
-include std/error.e
 include std/machine.e
 
 ifdef WINDOWS then
@@ -38,6 +37,7 @@ ifdef WINDOWS then
 		STARTF_USESHOWWINDOW = 1,
 		STARTF_USESTDHANDLES = 256,
 		FAIL = 0,
+		TRANSFER_CHUNK = 65536,
 		$
 ifdef BITS32 then
 	constant
@@ -64,17 +64,15 @@ elsedef
 		READ   = dll:define_c_func(STDLIB, "read",   {dll:C_INT, dll:C_POINTER, dll:C_POINTER}, dll:C_LONG),
 		WRITE  = dll:define_c_func(STDLIB, "write",  {dll:C_INT, dll:C_POINTER, dll:C_POINTER}, dll:C_LONG),
 		CLOSE  = dll:define_c_func(STDLIB, "close",  {dll:C_INT}, dll:C_INT),
-		DUP2   = dll:define_c_func(STDLIB, "dup2",   {dll:C_INT, dll:C_INT}, dll:C_INT),
 		KILL   = dll:define_c_func(STDLIB, "kill",   {dll:C_INT, dll:C_INT}, dll:C_INT),
-		FORK   = dll:define_c_func(STDLIB, "fork",   {}, dll:C_INT),
-		EXECV  = dll:define_c_func(STDLIB, "execv",  {dll:C_POINTER, dll:C_POINTER}, dll:C_INT),
-		SIGNAL = dll:define_c_func(STDLIB, "signal", {dll:C_INT, dll:C_POINTER}, dll:C_POINTER),
 		ERRNO  = dll:define_c_var( STDLIB, "errno"),
 		FAIL   = -1
 	
-	enum
-		os_stdin = 0, os_stdout, os_stderr,
-		os_sig_dfl = 0, os_sig_ign
+	constant
+		M_IO_READ   = 121,
+		M_IO_WRITE  = 122,
+		M_IO_SPLICE = 123,
+		M_SPAWN     = 124
 end ifdef
 
 --****
@@ -233,31 +231,38 @@ end function
 public function read(atom fd, integer bytes)
 	if bytes=0 then return "" end if
 
-	sequence data
-	atom
-		ret, ReadCount,
-		buf = allocate(bytes)
-	
 	ifdef WINDOWS then
-		atom pReadCount=machine:allocate(4)
+		sequence data
+		atom
+			ret, ReadCount,
+			buf = allocate(bytes),
+			pReadCount=machine:allocate(4)
+		
 		ret = c_func(iReadFile,{fd,buf,bytes,pReadCount,0})
 		ReadCount=peek4u(pReadCount)
 		machine:free(pReadCount)
+		
+		if ret = FAIL then
+			os_errno = get_errno()
+			machine:free(buf)
+			return ""
+		end if
+		
+		data=peek({buf,ReadCount})
+		machine:free(buf)
+		
+		return data
 	elsedef
-		ret = c_func(READ, {fd, buf, bytes})
-		ReadCount=ret
+		-- one read(2), through the backend's reusable buffer
+		object data = machine_func(M_IO_READ, {fd, bytes})
+		
+		if atom(data) then
+			os_errno = get_errno()
+			return ""
+		end if
+		
+		return data
 	end ifdef
-	
-	if ret = FAIL then
-		os_errno = get_errno()
-		machine:free(buf)
-		return ""
-	end if
-	
-	data=peek({buf,ReadCount})
-	machine:free(buf)
-	
-	return data
 end function
 
 --**
@@ -273,33 +278,99 @@ end function
 --
 
 public function write(atom fd, sequence str)
-	atom
-		buf = allocate_string(str),
-		ret,WrittenCount
-	
 	ifdef WINDOWS then
-		atom pWrittenCount=machine:allocate(4)
+		atom
+			buf = allocate_string(str),
+			ret,WrittenCount,
+			pWrittenCount=machine:allocate(4)
+		
 		ret=c_func(iWriteFile,{fd,buf,length(str),pWrittenCount,0})
 		WrittenCount=peek4u(pWrittenCount)
 		machine:free(pWrittenCount)
+		machine:free(buf)
+		
+		if ret = FAIL then
+			os_errno = get_errno()
+			return -1
+		end if
+
+		return WrittenCount
 	elsedef
-		ret = c_func(WRITE, {fd, buf, length(str)})
-		WrittenCount=ret
-	end ifdef
-	
-	machine:free(buf)
-	
-	if ret = FAIL then
-		os_errno = get_errno()
-		return -1
-	end if
+		-- the bytes go from the sequence to the descriptor in one call
+		object WrittenCount = machine_func(M_IO_WRITE, {fd, str})
+		
+		if WrittenCount = FAIL then
+			os_errno = get_errno()
+			return -1
+		end if
 
-	return WrittenCount
+		return WrittenCount
+	end ifdef
 end function
 
-procedure error()
-    error:crash(sprintf("Errno = %d", os_errno))
-end procedure
+--**
+-- Move data from one handle to another without reading it into a sequence
+--
+-- Parameters:
+--   # ##fd_in## : the handle to read from
+--   # ##fd_out## : the handle to write to
+--   # ##bytes## : the most bytes to move. The default, -1, moves everything up
+--                 to the end of ##fd_in##.
+--
+-- Returns:
+--   An **atom**, the number of bytes moved, or -1 on error
+--
+-- Comments:
+--   This is the way to connect the output of one child process to the input
+--   of another, or to save it in a file, when the program doesn't need
+--   to look at the data. On Linux, when either handle is a pipe, the data
+--   is moved inside the kernel with ##splice()## and is never copied into the
+--   program at all. Otherwise it is copied through one reused buffer.
+--
+-- Example 1:
+-- <eucode>
+-- -- sort the output of ls
+-- object ls = exec("ls -l", create())
+-- object sorter = exec("sort", create())
+-- transfer(ls[STDOUT], sorter[STDIN])
+-- close(sorter[STDIN])
+-- </eucode>
+--
+
+public function transfer(atom fd_in, atom fd_out, atom bytes = -1)
+	ifdef WINDOWS then
+		sequence data
+		atom total = 0, want
+		
+		while bytes < 0 or total < bytes do
+			want = TRANSFER_CHUNK
+			if bytes >= 0 and bytes - total < want then
+				want = bytes - total
+			end if
+			data = read(fd_in, want)
+			if length(data) = 0 then
+				exit
+			end if
+			if write(fd_out, data) != length(data) then
+				if total = 0 then
+					return -1
+				end if
+				exit
+			end if
+			total += length(data)
+		end while
+		
+		return total
+	elsedef
+		atom moved = machine_func(M_IO_SPLICE, {fd_in, fd_out, bytes})
+		
+		if moved = FAIL then
+			os_errno = get_errno()
+		end if
+
+		return moved
+	end ifdef
+end function
 
 --**
 -- Get error no from last call to a pipe function
@@ -459,51 +530,17 @@ ifdef WINDOWS then
 
 elsedef
 
-	function os_dup2(atom oldfd, atom newfd)
-		atom r = c_func(DUP2, {oldfd, newfd})
-		if r = -1 then
-			os_errno = peek4u(ERRNO)
-			return -1
-		end if
-		
-		return r
-	end function
-	
-	function os_fork()
-		atom pid = c_func(FORK, {})
+	function os_spawn(sequence path, sequence args, sequence fds, sequence closing)
+		-- posix_spawn() rather than fork(), which would have to copy this
+		-- whole process just to replace it
+		atom pid = machine_func(M_SPAWN, {path, args, fds, closing})
 		if pid = -1 then
-			os_errno = peek4u(ERRNO)
-			return -1
+			os_errno = get_errno()
 		end if
 		
 		return pid
 	end function
 	
-	function os_execv(sequence s, sequence v)
-		atom sbuf
-		atom vbuf
-		sequence vbufseq
-		atom r
-		
-		sbuf = machine:allocate_string(s)
-		vbufseq = {sbuf}
-		
-		for i = 1 to length(v) do
-			vbufseq &= machine:allocate_string(v[i])
-		end for
-		
-		vbufseq &= 0
-		vbuf = machine:allocate(length(vbufseq) * sizeof( C_POINTER ) )
-		poke_pointer(vbuf, vbufseq)
-		r = c_func(EXECV, {sbuf, vbuf})
-		os_errno = peek4u(ERRNO)
-		return -1
-	end function
-	
-	function os_signal(integer signal, atom handler)
-		return c_func(SIGNAL, {signal, handler})
-	end function
-
 	--See docs above in WIN32 version
 	public function create()
 	    object ipipe,opipe,epipe
@@ -542,28 +579,9 @@ elsedef
 	    opipe = pipe[1][2] & pipe[2][2]
 	    epipe = pipe[1][3] & pipe[2][3]
 	    
-	    pid=os_fork()
+	    pid=os_spawn(command, args, {ipipe[1], opipe[2], epipe[2]}, {ipipe[2], opipe[1], epipe[1]})
 		
-	    if pid=0 then
-			ret=close(ipipe[2])
-			ret=close(opipe[1])
-			ret=close(epipe[1])
-			
-			ret=os_signal(15, os_sig_dfl)
-			
-			ret=os_dup2(ipipe[1], os_stdin)
-			ret=close(ipipe[1])
-	
-			ret=os_dup2(opipe[2], os_stdout)
-			ret=close(opipe[2])
-			
-			ret=os_dup2(epipe[2], os_stderr)
-			ret=close(epipe[2])
-			
-			ret=os_execv(command,args)
-			
-			error()
-	    elsif pid=-1 then
+	    if pid=-1 then
 			ret=close(ipipe[1])
 			ret=close(ipipe[2])
 			ret=close(opipe[1])
@@ -593,3 +611,223 @@ elsedef
 		return exec_args("/bin/sh",{"-c", cmd}, pipe)
 	end function
 end ifdef
+
+--****
+-- === Worker Pools
+--
+-- Starting a process for every small job costs far more than the job itself
+-- when a program runs thousands of them. A worker pool starts a few
+-- long-lived helper processes once. Each one then answers request after
+-- request over its pipes.
+--
+-- A worker reads one request per line from its standard input. It writes
+-- exactly one line of reply for each request to its standard output, and
+-- flushes it, before reading the next request. It exits when its standard
+-- input is closed. Requests and replies must not contain new line
+-- characters.
+--
+-- Example 1:
+-- <eucode>
+-- -- a worker that upper cases each line: upper.ex
+-- include std/text.e
+-- object line = gets(0)
+-- while sequence(line) do
+--     puts(1, upper(line))
+--     flush(1)
+--     line = gets(0)
+-- end while
+--
+-- -- the program using it
+-- integer pool = pool_new("eui upper.ex", 4)
+-- ? pool_call(pool, "hello")                     -- "HELLO"
+-- ? pool_map(pool, {"one", "two", "three"})      -- {"ONE", "TWO", "THREE"}
+-- pool_close(pool)
+-- </eucode>
+
+enum
+	POOL_COMMAND,
+	POOL_WORKERS,
+	POOL_BUFFERS,
+	POOL_NEXT
+
+constant POOL_READ_SIZE = 65536
+
+sequence pools = {}
+
+function pool_start(sequence cmd)
+	object pipes = create()
+	if atom(pipes) then
+		return -1
+	end if
+	return exec(cmd, pipes)
+end function
+
+procedure pool_restart(integer pool, integer w)
+	-- the worker died or misbehaved: replace it
+	if sequence(pools[pool][POOL_WORKERS][w]) then
+		kill(pools[pool][POOL_WORKERS][w])
+	end if
+	pools[pool][POOL_WORKERS][w] = pool_start(pools[pool][POOL_COMMAND])
+	pools[pool][POOL_BUFFERS][w] = ""
+end procedure
+
+function pool_send(integer pool, integer w, sequence request)
+	object p = pools[pool][POOL_WORKERS][w]
+	if atom(p) then
+		return 0
+	end if
+	request &= '\n'
+	return write(p[STDIN], request) = length(request)
+end function
+
+function pool_receive(integer pool, integer w)
+	object p = pools[pool][POOL_WORKERS][w]
+	sequence buf, data
+	integer nl
+
+	if atom(p) then
+		return -1
+	end if
+	buf = pools[pool][POOL_BUFFERS][w]
+	nl = find('\n', buf)
+	while nl = 0 do
+		data = read(p[STDOUT], POOL_READ_SIZE)
+		if length(data) = 0 then
+			pool_restart(pool, w)
+			return -1
+		end if
+		nl = find('\n', data)
+		if nl then
+			nl += length(buf)
+		end if
+		buf &= data
+	end while
+	pools[pool][POOL_BUFFERS][w] = buf[nl + 1 .. $]
+	return buf[1 .. nl - 1]
+end function
+
+--**
+-- Start a pool of worker processes
+--
+-- Parameters:
+--   # ##cmd## : the command line that starts one worker, as for [[:exec]]
+--   # ##size## : the number of workers
+--
+-- Returns:
+--   An **integer**, the pool, or -1 if no worker could be started
+--
+-- See Also:
+--   [[:pool_call]], [[:pool_map]], [[:pool_close]]
+--
+
+public function pool_new(sequence cmd, integer size)
+	sequence workers = repeat(0, size)
+	integer started = 0
+
+	for i = 1 to size do
+		workers[i] = pool_start(cmd)
+		started += sequence(workers[i])
+	end for
+	if started = 0 then
+		return -1
+	end if
+
+	pools = append(pools, {cmd, workers, repeat("", size), 1})
+	return length(pools)
+end function
+
+--**
+-- Send one request to a worker in a pool and wait for its reply
+--
+-- Returns:
+--   A **sequence**, the reply line without its new line character, or
+--   -1 if the worker failed. A failed worker is replaced by a new one.
+--
+-- Comments:
+--   The workers take turns, one request each.
+--
+-- Example 1:
+-- <eucode>
+-- object reply = pool_call(pool, "hello")
+-- </eucode>
+--
+-- See Also:
+--   [[:pool_map]], [[:pool_new]]
+--
+
+public function pool_call(integer pool, sequence request)
+	integer w = pools[pool][POOL_NEXT]
+
+	pools[pool][POOL_NEXT] = remainder(w, length(pools[pool][POOL_WORKERS])) + 1
+	if not pool_send(pool, w, request) then
+		pool_restart(pool, w)
+		return -1
+	end if
+	return pool_receive(pool, w)
+end function
+
+--**
+-- Send many requests to a pool, keeping all of its workers busy
+--
+-- Returns:
+--   A **sequence**, the replies in the same order as ##requests##.
+--   The reply to a request whose worker failed is -1.
+--
+-- Comments:
+--   Request //i// goes to worker ##remainder(i - 1, size) + 1##, so every
+--   worker has one request at a time. The replies are collected in the order
+--   of the requests, and each worker is given its next request once its
+--   reply has been collected. The workers run in parallel, but while
+--   ##pool_map##() waits for a slow reply, the workers that have already
+--   replied wait for their next request too. Requests that take about the
+--   same time keep all the workers busy.
+--
+-- See Also:
+--   [[:pool_call]], [[:pool_new]]
+--
+
+public function pool_map(integer pool, sequence requests)
+	integer size = length(pools[pool][POOL_WORKERS])
+	sequence replies = repeat(-1, length(requests))
+	sequence sent = repeat(0, length(requests))
+	integer w
+
+	-- request i always goes to worker remainder(i-1, size)+1
+	for i = 1 to length(requests) do
+		if i > size then
+			exit
+		end if
+		sent[i] = pool_send(pool, i, requests[i])
+	end for
+	for i = 1 to length(requests) do
+		w = remainder(i - 1, size) + 1
+		if sent[i] then
+			replies[i] = pool_receive(pool, w)
+		else
+			pool_restart(pool, w)
+		end if
+		if i + size <= length(requests) then
+			sent[i + size] = pool_send(pool, w, requests[i + size])
+		end if
+	end for
+	return replies
+end function
+
+--**
+-- Stop the workers of a pool
+--
+-- Comments:
+--   Each worker's pipes are closed and it is sent signal 15, as by [[:kill]].
+--
+-- See Also:
+--   [[:pool_new]]
+--
+
+public procedure pool_close(integer pool)
+	for i = 1 to length(pools[pool][POOL_WORKERS]) do
+		if sequence(pools[pool][POOL_WORKERS][i]) then
+			kill(pools[pool][POOL_WORKERS][i])
+		end if
+	end for
+	pools[pool] = 0
+end procedure
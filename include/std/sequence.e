@@ -10,6 +10,11 @@ include std/types.e
 include std/search.e
 include std/sort.e
 
+constant
+	M_FORK_WORKERS   = 137,
+	M_WORKER_RETURN  = 138,
+	M_GATHER_WORKERS = 139
+
 --****
 -- === Constants
 
@@ -411,6 +416,155 @@ public function apply(sequence source, integer rid, object userdata = {})
 	return source
 end function
 
+--**
+-- Apply a function to every element of a sequence, using several processes.
+--
+-- Parameters:
+-- * ##rid## : the [[:routine_id]] of a function that takes one parameter
+-- * ##source## : the sequence to map
+-- * ##threads## : the number of processes to share the work between. The
+--                 default, 0, uses one per processor.
+--
+-- Returns:
+--	A **sequence**, the length of ##source##, where each element is the result
+-- of calling the routine on the corresponding element of ##source##, just as
+-- if it had been done one element after the other.
+--
+-- Comments:
+-- ##source## is cut into one part per process. On Unix, each part is worked on
+-- in a child process started with ##fork()##. A child sees all of the
+-- program's variables as they were when ##parallel_apply## was called, without
+-- any of them being copied, but it has a heap of its own: anything the routine
+-- changes, other than its return value, is lost when the child ends. The
+-- results are sent back to the parent and put together in order.
+--
+-- Starting the processes and sending the results back costs far more than a
+-- call to the routine, so this is only worth doing when there is a lot of work
+-- per element. If only one process would be used, or processes can't be
+-- started, for instance on Windows, the work is all done by the calling
+-- process instead.
+--
+-- If the routine fails in one of the children, ##parallel_apply## stops the
+-- program with a run-time error that gives the child's error message.
+--
+-- Example 1:
+-- <eucode>
+-- function checksum(sequence name)
+--     return hash(read_file(name), HSIEH32)
+-- end function
+--
+-- sequence sums = parallel_apply(routine_id("checksum"), file_names)
+-- </eucode>
+--
+-- See Also:
+--   [[:apply]], [[:parallel_range]]
+
+public function parallel_apply(integer rid, sequence source, integer threads = 0)
+	object workers
+	sequence parts
+	integer first, last
+
+	if threads != 1 then
+		workers = machine_func(M_FORK_WORKERS, {threads, length(source)})
+		if sequence(workers) then
+			if workers[1] = 0 then
+				parts = machine_func(M_GATHER_WORKERS, {})
+				last = 0
+				for i = 1 to length(parts) do
+					first = last + 1
+					last += length(parts[i])
+					source[first .. last] = parts[i]
+				end for
+				return source
+			end if
+
+			-- a child process: work on this worker's part and hand it back
+			first = floor((workers[1] - 1) * length(source) / workers[2]) + 1
+			last = floor(workers[1] * length(source) / workers[2])
+			for i = first to last do
+				source[i] = call_func(rid, {source[i]})
+			end for
+			machine_proc(M_WORKER_RETURN, {source[first .. last]})
+		end if
+	end if
+
+	for i = 1 to length(source) do
+		source[i] = call_func(rid, {source[i]})
+	end for
+	return source
+end function
+
+--**
+-- Split a range of indexes into parts and work on each part in its own process.
+--
+-- Parameters:
+-- * ##rid## : the [[:routine_id]] of a function that takes two parameters, the
+--             first and last index of a part
+-- * ##first## : the first index of the whole range
+-- * ##last## : the last index of the whole range
+-- * ##threads## : the number of processes to share the work between. The
+--                 default, 0, uses one per processor.
+--
+-- Returns:
+--	A **sequence**, with what the routine returned for each part, in the order
+-- of the parts. The parts are consecutive, cover the whole range and are all
+-- about the same size, but how many there are depends on ##threads## and on
+-- the number of processors. If ##last## is less than ##first##, the routine
+-- isn't called and the result is empty.
+--
+-- Comments:
+-- This is meant for jobs that read a lot of data but return little. On Unix,
+-- each part is worked on in a child process started with ##fork()##, which
+-- sees all of the program's variables without any of them being copied, so
+-- even a very large sequence can be shared out between the children by index.
+-- Only the values the routine returns are sent back to the parent.
+--
+-- If the routine fails in one of the children, the error is passed on: the
+-- program stops with a run-time error that says which part failed and why.
+-- The same is true of [[:parallel_apply]].
+--
+-- When processes can't be started, for instance on Windows, or ##threads## is
+-- 1, the routine is called once, by the calling process, for the whole range.
+--
+-- Example 1:
+-- <eucode>
+-- sequence readings = load_readings()     -- millions of atoms
+--
+-- function part_sum(integer first, integer last)
+--     return sum(readings[first .. last])
+-- end function
+--
+-- atom total = sum(parallel_range(routine_id("part_sum"), 1, length(readings)))
+-- </eucode>
+--
+-- See Also:
+--   [[:parallel_apply]]
+
+public function parallel_range(integer rid, integer first, integer last, integer threads = 0)
+	object workers
+	integer count = last - first + 1
+
+	if count <= 0 then
+		return {}
+	end if
+
+	if threads != 1 then
+		workers = machine_func(M_FORK_WORKERS, {threads, count})
+		if sequence(workers) then
+			if workers[1] = 0 then
+				return machine_func(M_GATHER_WORKERS, {})
+			end if
+
+			-- a child process: work on this worker's part and hand it back
+			last = first + floor(workers[1] * count / workers[2]) - 1
+			first += floor((workers[1] - 1) * count / workers[2])
+			machine_proc(M_WORKER_RETURN, {call_func(rid, {first, last})})
+		end if
+	end if
+
+	return {call_func(rid, {first, last})}
+end function
+
 --**
 -- Each item from ##source_arg## found in ##from_set## is changed into the
 -- corresponding item in ##to_set##
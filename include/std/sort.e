@@ -6,6 +6,8 @@
 
 namespace stdsort
 
+constant M_PARALLEL_SORT = 106
+
 --****
 -- === Constants
 --
@@ -105,6 +107,49 @@ public function sort(sequence x, integer order = ASCENDING)
 	end while
 end function
 
+--**
+-- Sort a large sequence of integers, floating point numbers or strings using
+-- several threads.
+--
+-- Parameters:
+--	 # ##x## : The sequence to be sorted.
+--   # ##order## : the sort order. Default is ##ASCENDING##.
+--   # ##threads## : the number of threads to use. The default, 0, uses one
+--                   thread per processor.
+--
+-- Returns:
+--	 A **sequence**, a copy of the original sequence in sorted order. This is
+--   always the same sequence that [[:sort]] would return.
+--
+-- Comments:
+--
+-- The sort is done natively, and split across several threads, when the
+-- elements of ##x## are either all integers, all floating point numbers or
+-- all flat sequences of integers such as strings. Each thread sorts a part
+-- of the sequence, and the sorted parts are then merged, again in parallel.
+-- Any other sequence is sorted with [[:sort]].
+--
+-- Short sequences are not worth splitting up, so they are sorted by a
+-- single thread. On Windows all of the work is done by the calling thread.
+--
+-- Example 1:
+--   <eucode>
+--   sequence ids = rand(repeat(1_000_000_000, 50_000_000))
+--   ids = parallel_sort(ids)
+--   </eucode>
+--
+-- See Also:
+--     [[:sort]], [[:compare]]
+
+public function parallel_sort(sequence x, integer order = ASCENDING, integer threads = 0)
+	object sorted = machine_func(M_PARALLEL_SORT, {x, order, threads})
+
+	if atom(sorted) then
+		return sort(x, order)
+	end if
+	return sorted
+end function
+
 --**
 -- Sort the elements of a sequence according to a user-defined order.
 --
@@ -21,7 +21,9 @@
 
 namespace task
 
-constant M_SLEEP = 64
+constant
+	M_SLEEP = 64,
+	M_TASK_WAIT_SPIN = 136
 
 --**
 -- Suspends a task for a short period, allowing other tasks to run in the meantime.
@@ -47,6 +49,41 @@ public procedure task_delay(atom delaytime)
 	end while
 end procedure
 
+--**
+-- Sets how much of each wait the task scheduler spends spinning rather than sleeping.
+--
+-- Parameters:
+--		# ##seconds## : an atom, the time at the end of each wait to spend checking the
+--        clock instead of sleeping. A negative value leaves the setting as it is.
+--
+-- Returns:
+--		An **atom**, the previous setting.
+--
+-- Comments:
+--
+-- When no task is ready to run, the scheduler sleeps until the next real-time task is due,
+-- and [[:sleep]]() sleeps the same way. The system may wake a sleeping program a little late,
+-- so the last part of the wait is spent spinning on the clock instead. The default, 0.0002
+-- seconds, keeps real-time tasks accurate to well under a millisecond while an idle program
+-- uses almost no CPU time.
+--
+-- Use 0 to never spin, when saving CPU time matters more than accurate timing.
+-- Larger values trade CPU time for accuracy on systems that wake sleepers late.
+--
+-- This has no effect on //Windows//, where waits of less than a millisecond always spin.
+--
+-- Example 1:
+-- <eucode>
+-- atom old = task_wait_spin(0.001)  -- spin for the last millisecond of each wait
+-- </eucode>
+--
+-- See Also:
+-- [[:task_schedule]], [[:sleep]]
+
+public function task_wait_spin(atom seconds = -1)
+	return machine_func(M_TASK_WAIT_SPIN, seconds)
+end function
+
 --****
 -- Signature:
 -- <built-in> procedure task_clock_start()
@@ -225,11 +262,12 @@ end procedure
 -- For precise timing, you can specify the same value for min and max. However, by specifying a range of times,
 -- you give the scheduler some flexibility. This allows it to schedule tasks more efficiently, 
 -- and avoid non-productive delays. 
--- When the scheduler must delay, it calls [[:sleep]](), unless the required delay is very short. 
--- [[:sleep]]() lets the operating system run other programs.
+-- When the scheduler must delay, it sleeps, spinning on the clock only for the last fraction
+-- of a millisecond (see [[:task_wait_spin]]). Sleeping lets the operating system run other programs.
 --
--- The min and max values can be fractional. If the min value is smaller than the resolution of the scheduler's clock 
--- (currently 0.01 seconds on //Windows// or // Unix//) then accurate time scheduling cannot be performed, but the 
+-- The min and max values can be fractional. On //Unix// the scheduler's clock is precise to well
+-- under a microsecond. If the min value is smaller than the resolution of the scheduler's clock 
+-- (currently 0.01 seconds on //Windows//) then accurate time scheduling cannot be performed, but the 
 -- scheduler will try to run the task several times in a row to approximate what is desired.
 --
 -- For example, if you ask for a min time of 0.002 seconds, then the scheduler will try to run your task 
@@ -418,3 +456,670 @@ end procedure
 --
 -- See Also: 
 -- [[:task_create]], [[:task_schedule]], [[:task_suspend]]
+
+--****
+-- === Task I/O
+--
+-- A task that reads from a pipe or socket normally blocks the whole program
+-- until data arrives, so no other task can run in the meantime. The routines
+-- below let a task wait for a file descriptor instead. While it waits, the task is
+-- suspended and the other tasks keep running. When the scheduler has nothing
+-- else to do, it sleeps until one of the descriptors is ready.
+--
+-- On Linux the waiting is done with ##epoll##, and on other Unix systems with
+-- ##poll##. On Windows the waiting is not supported, so these routines
+-- simply block.
+
+constant
+	M_TASK_IO_WAIT = 120,
+	M_IO_READ      = 121,
+	M_IO_WRITE     = 122
+
+constant IO_WRITE_CHUNK = 4096
+
+public enum
+	--** wait until the file descriptor has data to read, or is at end of file
+	TASK_IO_READ = 1,
+	--** wait until the file descriptor can accept more data
+	TASK_IO_WRITE
+
+--**
+-- Suspends the current task until a file descriptor is ready.
+--
+-- Parameters:
+--		# ##fd## : an integer, a file descriptor such as a pipe handle from [[:exec]]
+--		# ##events## : an integer, ##TASK_IO_READ##, ##TASK_IO_WRITE## or both added together
+--
+-- Comments:
+--
+-- If ##fd## is ready already the task carries on at once. Otherwise it is
+-- suspended and [[:task_yield]]() is called, so that other tasks run until
+-- ##fd## becomes ready. The task is then rescheduled, as a real-time or
+-- time-sharing task as before.
+--
+-- An error or hang up on ##fd## also counts as ready; the next read or write
+-- will report it.
+--
+-- Example 1:
+-- <eucode>
+-- task_io_wait(p[pipe:STDOUT], TASK_IO_READ)
+-- sequence data = pipe:read(p[pipe:STDOUT], 4096)
+-- </eucode>
+--
+-- See Also:
+--   [[:task_io_read]], [[:task_io_write]], [[:task_yield]]
+
+public procedure task_io_wait(integer fd, integer events)
+	if machine_func(M_TASK_IO_WAIT, {fd, events}) then
+		task_yield()
+	end if
+end procedure
+
+--**
+-- Reads from a file descriptor, letting other tasks run until data arrives.
+--
+-- Parameters:
+--		# ##fd## : an integer, the file descriptor to read from
+--		# ##n## : an integer, the most bytes to read
+--
+-- Returns:
+--   A **sequence**, the bytes that were read, or an **atom**, -1 on error.
+--   The sequence may hold fewer than ##n## bytes. It is empty at the end of the
+--   file, when the other end of a pipe has been closed.
+--
+-- Comments:
+--
+-- The bytes are read with one system call, into a buffer that is reused from
+-- call to call, and then copied into the result.
+--
+-- Example 1:
+-- <eucode>
+-- object data = task_io_read(p[pipe:STDOUT], 65536)
+-- while sequence(data) and length(data) do
+--     puts(1, data)
+--     data = task_io_read(p[pipe:STDOUT], 65536)
+-- end while
+-- </eucode>
+--
+-- See Also:
+--   [[:task_io_wait]], [[:task_io_write]]
+
+public function task_io_read(integer fd, integer n)
+	task_io_wait(fd, TASK_IO_READ)
+	return machine_func(M_IO_READ, {fd, n})
+end function
+
+--**
+-- Writes to a file descriptor, letting other tasks run while it is full.
+--
+-- Parameters:
+--		# ##fd## : an integer, the file descriptor to write to
+--		# ##data## : a sequence of bytes
+--
+-- Returns:
+--   An **integer**, the number of bytes written, or -1 on error.
+--
+-- Comments:
+--
+-- All of ##data## is written, in pieces small enough that writing to a pipe
+-- never blocks. Between the pieces, the task waits with [[:task_io_wait]]
+-- if the pipe is full.
+--
+-- See Also:
+--   [[:task_io_wait]], [[:task_io_read]]
+
+public function task_io_write(integer fd, sequence data)
+	integer done = 0, last
+	object n
+
+	while done < length(data) do
+		task_io_wait(fd, TASK_IO_WRITE)
+		last = done + IO_WRITE_CHUNK
+		if last > length(data) then
+			last = length(data)
+		end if
+		n = machine_func(M_IO_WRITE, {fd, data[done + 1 .. last]})
+		if n < 0 then
+			return -1
+		end if
+		done += n
+	end while
+	return done
+end function
+
+--****
+-- === Channels
+--
+-- A channel is a queue of messages, any Euphoria objects, that tasks send to
+-- and a task receives from. It holds a limited number of messages: a task
+-- that sends to a full channel waits until there is room, and a task that
+-- receives from an empty one waits until a message arrives. While a task
+-- waits it is suspended, and the other tasks keep running.
+--
+-- Channels also work between runtime contexts that a C application runs on
+-- several threads at once. There a message sent by Euphoria code is copied as
+-- it is sent, as the sender still refers to it; only the application's own C
+-- code, sending with ##eu_channel_send()##, can hand over a message that
+-- nothing else refers to without it being copied. A task then waits for the
+-- channel as [[:task_io_wait]] waits, so on Windows it blocks its whole
+-- thread.
+
+constant
+	M_CHANNEL_NEW     = 140,
+	M_CHANNEL_SEND    = 141,
+	M_CHANNEL_RECEIVE = 142,
+	M_CHANNEL_CLOSE   = 143,
+	M_CHANNEL_DELETE  = 144
+
+--**
+-- Creates a new channel.
+--
+-- Parameters:
+--		# ##capacity## : an integer, the most messages it can hold
+--
+-- Returns:
+--   An **atom**, the channel's handle.
+--
+-- Comments:
+--
+-- A channel is not freed automatically. Call [[:channel_delete]] when no
+-- task uses it any more.
+--
+-- See Also:
+--   [[:channel_send]], [[:channel_receive]], [[:channel_close]]
+
+public function channel_new(integer capacity = 64)
+	return machine_func(M_CHANNEL_NEW, capacity)
+end function
+
+--**
+-- Sends a message through a channel, waiting while it is full.
+--
+-- Parameters:
+--		# ##ch## : an atom, the channel
+--		# ##x## : an object, the message
+--
+-- Returns:
+--   An **integer**, 1 when the message has been sent, or 0 if the channel was
+--   closed.
+--
+-- See Also:
+--   [[:channel_receive]], [[:channel_close]]
+
+public function channel_send(atom ch, object x)
+	integer r = machine_func(M_CHANNEL_SEND, {ch, x})
+
+	while r = -1 do
+		-- suspended until there is room
+		task_yield()
+		r = machine_func(M_CHANNEL_SEND, {ch, x})
+	end while
+	return r
+end function
+
+--**
+-- Receives the next message from a channel, waiting until there is one.
+--
+-- Parameters:
+--		# ##ch## : an atom, the channel
+--
+-- Returns:
+--   A **sequence**, ##{message}##, or ##{}## once the channel has been closed
+--   and every message sent before that has been received.
+--
+-- Comments:
+--
+-- Messages are received in the order they were sent. Only one task should
+-- receive from a channel.
+--
+-- Example 1:
+-- <eucode>
+-- sequence msg = channel_receive(ch)
+-- while length(msg) do
+--     process(msg[1])
+--     msg = channel_receive(ch)
+-- end while
+-- </eucode>
+--
+-- See Also:
+--   [[:channel_send]], [[:channel_close]]
+
+public function channel_receive(atom ch)
+	object r = machine_func(M_CHANNEL_RECEIVE, ch)
+
+	while atom(r) do
+		-- suspended until a message arrives
+		task_yield()
+		r = machine_func(M_CHANNEL_RECEIVE, ch)
+	end while
+	return r
+end function
+
+--**
+-- Closes a channel, so that no more messages can be sent through it.
+--
+-- Parameters:
+--		# ##ch## : an atom, the channel
+--
+-- Comments:
+--
+-- The messages that were sent before can still be received. After the last
+-- of them, [[:channel_receive]] returns ##{}##.
+--
+-- See Also:
+--   [[:channel_send]], [[:channel_delete]]
+
+public procedure channel_close(atom ch)
+	machine_proc(M_CHANNEL_CLOSE, ch)
+end procedure
+
+--**
+-- Frees a channel and any messages still in it.
+--
+-- Parameters:
+--		# ##ch## : an atom, the channel
+--
+-- Comments:
+--
+-- No task or thread may use the channel afterwards.
+--
+-- See Also:
+--   [[:channel_new]], [[:channel_close]]
+
+public procedure channel_delete(atom ch)
+	machine_proc(M_CHANNEL_DELETE, ch)
+end procedure
+
+--****
+-- === Semaphores, Events and Condition Variables
+--
+-- A task that waits for a semaphore, an event or a condition variable is
+-- suspended until another task signals it, instead of calling [[:task_yield]]
+-- in a loop to check a variable. Waking it takes the same short time however
+-- many tasks there are, and tasks that wait for the same thing are woken in
+-- the order they began waiting.
+--
+-- A semaphore, an event, a condition variable or a channel (see above) can't
+-- be deleted while a task is waiting for it.
+
+constant
+	M_SYNC_NEW    = 145,
+	M_SYNC_WAIT   = 146,
+	M_SYNC_POST   = 147,
+	M_SYNC_CLEAR  = 148,
+	M_SYNC_DELETE = 149,
+	M_SYNC_BROADCAST = 152
+
+enum
+	SYNC_SEMAPHORE = 1,
+	SYNC_EVENT,
+	SYNC_CONDITION
+
+procedure sync_wait(atom s)
+	while not machine_func(M_SYNC_WAIT, s) do
+		-- suspended until it is signalled
+		task_yield()
+	end while
+end procedure
+
+--**
+-- Creates a new semaphore.
+--
+-- Parameters:
+--		# ##count## : an integer, the number of units it starts with
+--
+-- Returns:
+--   An **atom**, the semaphore's handle.
+--
+-- Comments:
+--
+-- A semaphore holds a count of units. [[:semaphore_wait]] takes one, waiting
+-- until there is one to take, and [[:semaphore_signal]] gives one back.
+--
+-- Example 1:
+-- <eucode>
+-- -- at most 4 tasks download at once
+-- atom downloads = semaphore_new(4)
+--
+-- procedure fetch(sequence url)
+--     semaphore_wait(downloads)
+--     download(url)
+--     semaphore_signal(downloads)
+-- end procedure
+-- </eucode>
+--
+-- See Also:
+--   [[:semaphore_wait]], [[:semaphore_signal]], [[:semaphore_delete]]
+
+public function semaphore_new(integer count = 0)
+	return machine_func(M_SYNC_NEW, {SYNC_SEMAPHORE, count})
+end function
+
+--**
+-- Takes a unit from a semaphore, waiting until it has one.
+--
+-- Parameters:
+--		# ##s## : an atom, the semaphore
+--
+-- See Also:
+--   [[:semaphore_new]], [[:semaphore_signal]]
+
+public procedure semaphore_wait(atom s)
+	sync_wait(s)
+end procedure
+
+--**
+-- Gives a unit to a semaphore.
+--
+-- Parameters:
+--		# ##s## : an atom, the semaphore
+--
+-- Comments:
+--
+-- If tasks are waiting for the semaphore, the unit goes straight to the one
+-- that has waited longest, which is then rescheduled.
+--
+-- See Also:
+--   [[:semaphore_new]], [[:semaphore_wait]]
+
+public procedure semaphore_signal(atom s)
+	machine_proc(M_SYNC_POST, s)
+end procedure
+
+--**
+-- Frees a semaphore.
+--
+-- Parameters:
+--		# ##s## : an atom, the semaphore
+--
+-- See Also:
+--   [[:semaphore_new]]
+
+public procedure semaphore_delete(atom s)
+	machine_proc(M_SYNC_DELETE, s)
+end procedure
+
+--**
+-- Creates a new event.
+--
+-- Parameters:
+--		# ##is_set## : an integer, 1 if it starts out set
+--
+-- Returns:
+--   An **atom**, the event's handle.
+--
+-- Comments:
+--
+-- An event is either set or clear. Tasks wait with [[:event_wait]] while it
+-- is clear, and [[:event_set]] sets it and wakes them all.
+--
+-- See Also:
+--   [[:event_wait]], [[:event_set]], [[:event_clear]], [[:event_delete]]
+
+public function event_new(integer is_set = 0)
+	return machine_func(M_SYNC_NEW, {SYNC_EVENT, is_set})
+end function
+
+--**
+-- Waits until an event is set.
+--
+-- Parameters:
+--		# ##e## : an atom, the event
+--
+-- Comments:
+--
+-- If the event is set already the task carries on at once. A task that was
+-- waiting carries on even if the event has been cleared again by the time it
+-- runs.
+--
+-- See Also:
+--   [[:event_new]], [[:event_set]]
+
+public procedure event_wait(atom e)
+	sync_wait(e)
+end procedure
+
+--**
+-- Sets an event, waking every task that waits for it.
+--
+-- Parameters:
+--		# ##e## : an atom, the event
+--
+-- See Also:
+--   [[:event_wait]], [[:event_clear]]
+
+public procedure event_set(atom e)
+	machine_proc(M_SYNC_POST, e)
+end procedure
+
+--**
+-- Clears an event, so that tasks wait for it again.
+--
+-- Parameters:
+--		# ##e## : an atom, the event
+--
+-- See Also:
+--   [[:event_wait]], [[:event_set]]
+
+public procedure event_clear(atom e)
+	machine_proc(M_SYNC_CLEAR, e)
+end procedure
+
+--**
+-- Frees an event.
+--
+-- Parameters:
+--		# ##e## : an atom, the event
+--
+-- See Also:
+--   [[:event_new]]
+
+public procedure event_delete(atom e)
+	machine_proc(M_SYNC_DELETE, e)
+end procedure
+
+--**
+-- Creates a new condition variable.
+--
+-- Returns:
+--   An **atom**, the condition variable's handle.
+--
+-- Comments:
+--
+-- A condition variable lets tasks wait until something that other tasks
+-- change becomes true. A task checks the condition itself, and waits with
+-- [[:cond_wait]] while it doesn't hold; a task that may have made it true
+-- wakes one waiting task with [[:cond_signal]], or all of them with
+-- [[:cond_broadcast]]. A woken task must check the condition again, as
+-- another task may have run first and changed things back.
+--
+-- Unlike an event, a condition variable remembers nothing: a signal when no
+-- task is waiting is lost. Tasks only switch when they yield or wait, so
+-- nothing can change between checking the condition and [[:cond_wait]], and
+-- no mutex is needed.
+--
+-- Example 1:
+-- <eucode>
+-- sequence queue = {}
+-- atom not_empty = cond_new()
+--
+-- procedure consumer()
+--     while 1 do
+--         while length(queue) = 0 do
+--             cond_wait(not_empty)
+--         end while
+--         process(queue[1])
+--         queue = queue[2 .. $]
+--     end while
+-- end procedure
+--
+-- procedure produce(object item)
+--     queue = append(queue, item)
+--     cond_signal(not_empty)
+-- end procedure
+-- </eucode>
+--
+-- See Also:
+--   [[:cond_wait]], [[:cond_signal]], [[:cond_broadcast]], [[:cond_delete]]
+
+public function cond_new()
+	return machine_func(M_SYNC_NEW, {SYNC_CONDITION, 0})
+end function
+
+--**
+-- Waits until a condition variable is signalled.
+--
+-- Parameters:
+--		# ##c## : an atom, the condition variable
+--
+-- Comments:
+--
+-- The task always waits, even if the condition variable was signalled
+-- before. Call it in a loop that checks the condition.
+--
+-- See Also:
+--   [[:cond_new]], [[:cond_signal]], [[:cond_broadcast]]
+
+public procedure cond_wait(atom c)
+	sync_wait(c)
+end procedure
+
+--**
+-- Wakes the task that has waited longest for a condition variable.
+--
+-- Parameters:
+--		# ##c## : an atom, the condition variable
+--
+-- Comments:
+--
+-- If no task is waiting, nothing happens. If the woken task is suspended
+-- before it runs, the signal goes on to the next waiting task.
+--
+-- See Also:
+--   [[:cond_wait]], [[:cond_broadcast]]
+
+public procedure cond_signal(atom c)
+	machine_proc(M_SYNC_POST, c)
+end procedure
+
+--**
+-- Wakes every task that waits for a condition variable.
+--
+-- Parameters:
+--		# ##c## : an atom, the condition variable
+--
+-- See Also:
+--   [[:cond_wait]], [[:cond_signal]]
+
+public procedure cond_broadcast(atom c)
+	machine_proc(M_SYNC_BROADCAST, c)
+end procedure
+
+--**
+-- Frees a condition variable.
+--
+-- Parameters:
+--		# ##c## : an atom, the condition variable
+--
+-- See Also:
+--   [[:cond_new]]
+
+public procedure cond_delete(atom c)
+	machine_proc(M_SYNC_DELETE, c)
+end procedure
+
+--****
+-- === Task Statistics
+--
+-- The scheduler keeps a few figures for each task, for finding out which
+-- tasks use the most time and which real-time tasks miss their deadlines.
+-- It can also write a trace of every run of every task to a file, to be
+-- looked at on a timeline.
+
+constant
+	M_TASK_STATS = 150,
+	M_TASK_TRACE = 151
+
+public enum
+	--** seconds the task has spent running
+	TASK_CPU_TIME = 1,
+	--** the number of times it has been run
+	TASK_RUNS,
+	--** seconds its runs began after their deadlines, added together
+	TASK_LATE_TOTAL,
+	--** the most seconds any one of its runs began after its deadline
+	TASK_LATE_MAX,
+	--** seconds the scheduler spent waiting until the task could be run
+	TASK_WAITED
+
+--**
+-- Returns what the scheduler has counted for a task.
+--
+-- Parameters:
+--		# ##tid## : an atom, the task id, or [[:task_self]]() for the current task
+--
+-- Returns:
+--   A **sequence**, indexed by ##TASK_CPU_TIME##, ##TASK_RUNS##,
+--   ##TASK_LATE_TOTAL##, ##TASK_LATE_MAX## and ##TASK_WAITED##.
+--
+-- Comments:
+--
+-- Times are in seconds, as [[:time]]() measures them. The time the scheduler
+-- takes to choose a task is counted as part of that task's run.
+--
+-- A run is late if it begins after the latest time that [[:task_schedule]]
+-- gave for it, so only real-time tasks can be late.
+--
+-- When no task is ready the scheduler waits, sleeping or waiting for
+-- I/O, and the time is added to ##TASK_WAITED## for the task that
+-- runs next. Time that a task spends suspended or waiting its turn isn't
+-- counted anywhere.
+--
+-- Example 1:
+-- <eucode>
+-- sequence s = task_stats(t)
+-- printf(1, "%d runs, %.3f s, late by up to %.3f s\n",
+--     {s[TASK_RUNS], s[TASK_CPU_TIME], s[TASK_LATE_MAX]})
+-- </eucode>
+--
+-- See Also:
+--   [[:task_trace]], [[:task_schedule]]
+
+public function task_stats(atom tid)
+	return machine_func(M_TASK_STATS, tid)
+end function
+
+--**
+-- Starts or stops writing a trace of task runs to a file.
+--
+-- Parameters:
+--		# ##file_name## : a sequence, the file to write, or an atom to stop
+--
+-- Returns:
+--   An **integer**, 1 on success, or 0 if the file couldn't be opened.
+--
+-- Comments:
+--
+-- The trace is written in the Chrome trace event format, so it can be
+-- loaded into ##chrome:~//tracing## or another viewer that reads it. Each
+-- run of a task is shown as a slice named after the task's routine, on the
+-- line for its task id, and each time the scheduler waited before running
+-- a task is shown as a slice named ##wait##.
+--
+-- Starting a new trace finishes the one being written. A trace that is
+-- still open when the program ends is left without its closing bracket,
+-- which the viewers accept.
+--
+-- Example 1:
+-- <eucode>
+-- task_trace("tasks.json")
+-- run_simulation()
+-- task_trace(0)
+-- </eucode>
+--
+-- See Also:
+--   [[:task_stats]]
+
+public function task_trace(object file_name)
+	return machine_func(M_TASK_TRACE, file_name)
+end function
@@ -198,6 +198,10 @@ ifdef ENO_DBL_CACHE
 MEM_FLAGS+=-DNO_DBL_CACHE
 endif
 
+ifeq "$(REENTRANT)" "1"
+MEM_FLAGS+=-DEREENTRANT
+endif
+
 ifdef COVERAGE
 COVERAGEFLAG=-fprofile-arcs -ftest-coverage
 DEBUG_FLAGS=-g3 -O0 -Wall
@@ -347,6 +351,14 @@ EU_BACKEND_OBJECTS = \
 	$(BUILDDIR)/$(OBJDIR)/back/be_runtime.o \
 	$(BUILDDIR)/$(OBJDIR)/back/be_symtab.o \
 	$(BUILDDIR)/$(OBJDIR)/back/be_socket.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_context.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_parallel.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_binary.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_walk.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_random.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_hash.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_sort.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_pool.o \
 	$(BUILDDIR)/$(OBJDIR)/back/be_w.o \
 	$(PREFIXED_PCRE_OBJECTS)
 
@@ -359,6 +371,14 @@ EU_LIB_OBJECTS = \
 	$(BUILDDIR)/$(OBJDIR)/back/be_inline.o \
 	$(BUILDDIR)/$(OBJDIR)/back/be_pcre.o \
 	$(BUILDDIR)/$(OBJDIR)/back/be_socket.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_context.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_parallel.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_binary.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_walk.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_random.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_hash.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_sort.o \
+	$(BUILDDIR)/$(OBJDIR)/back/be_pool.o \
 	$(BUILDDIR)/$(OBJDIR)/back/be_syncolor.o \
 	$(BUILDDIR)/$(OBJDIR)/back/be_runtime.o \
 	$(BUILDDIR)/$(OBJDIR)/back/be_task.o \
@@ -1019,41 +1039,42 @@ depend :
 # The dependencies below are automatically generated using the depend target above.
 # DO NOT DELETE
 
-$(BUILDDIR)/intobj/back/be_alloc.o: be_alloc.h  alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/intobj/back/be_alloc.o: be_alloc.h  alldefs.h global.h object.h symtab.h be_context.h
 $(BUILDDIR)/intobj/back/be_alloc.o: be_alloc.h  execute.h reswords.h be_runtime.h
 $(BUILDDIR)/intobj/back/be_alloc.o: be_alloc.h  be_alloc.h
 $(BUILDDIR)/intobj/back/be_callc.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/intobj/back/be_callc.o: execute.h reswords.h be_runtime.h
-$(BUILDDIR)/intobj/back/be_callc.o: be_machine.h be_alloc.h
+$(BUILDDIR)/intobj/back/be_callc.o: be_machine.h be_alloc.h be_context.h
 $(BUILDDIR)/intobj/back/be_coverage.o: be_coverage.h be_machine.h global.h
 $(BUILDDIR)/intobj/back/be_coverage.o: object.h symtab.h execute.h
 $(BUILDDIR)/intobj/back/be_debug.o: execute.h global.h object.h symtab.h
-$(BUILDDIR)/intobj/back/be_debug.o: be_alloc.h be_debug.h be_execute.h
+$(BUILDDIR)/intobj/back/be_debug.o: be_alloc.h be_debug.h be_execute.h be_context.h
 $(BUILDDIR)/intobj/back/be_debug.o: be_machine.h be_rterror.h be_runtime.h
 $(BUILDDIR)/intobj/back/be_debug.o: reswords.h
 $(BUILDDIR)/intobj/back/be_decompress.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/intobj/back/be_decompress.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/intobj/back/be_decompress.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/intobj/back/be_decompress.o: be_runtime.h
 $(BUILDDIR)/intobj/back/be_execute.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/intobj/back/be_execute.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/intobj/back/be_execute.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/intobj/back/be_execute.o: be_runtime.h be_decompress.h
 $(BUILDDIR)/intobj/back/be_execute.o: be_inline.h be_machine.h be_task.h
 $(BUILDDIR)/intobj/back/be_execute.o: be_rterror.h be_symtab.h be_w.h
 $(BUILDDIR)/intobj/back/be_execute.o: be_callc.h be_coverage.h be_execute.h
 $(BUILDDIR)/intobj/back/be_inline.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/intobj/back/be_inline.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/intobj/back/be_inline.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/intobj/back/be_machine.o: global.h object.h symtab.h alldefs.h
 $(BUILDDIR)/intobj/back/be_machine.o: execute.h reswords.h version.h
 $(BUILDDIR)/intobj/back/be_machine.o: be_runtime.h be_rterror.h be_main.h
 $(BUILDDIR)/intobj/back/be_machine.o: be_w.h be_symtab.h be_machine.h
 $(BUILDDIR)/intobj/back/be_machine.o: be_pcre.h pcre/pcre.h be_task.h
-$(BUILDDIR)/intobj/back/be_machine.o: be_alloc.h be_execute.h be_socket.h
+$(BUILDDIR)/intobj/back/be_machine.o: be_alloc.h be_execute.h be_socket.h be_context.h
 $(BUILDDIR)/intobj/back/be_machine.o: be_coverage.h be_syncolor.h be_debug.h
+$(BUILDDIR)/intobj/back/be_machine.o: be_sort.h be_hash.h be_random.h be_walk.h be_binary.h be_parallel.h
 $(BUILDDIR)/intobj/back/be_main.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/intobj/back/be_main.o: execute.h reswords.h be_runtime.h
-$(BUILDDIR)/intobj/back/be_main.o: be_execute.h be_alloc.h be_rterror.h
+$(BUILDDIR)/intobj/back/be_main.o: be_execute.h be_alloc.h be_rterror.h be_context.h
 $(BUILDDIR)/intobj/back/be_main.o: be_w.h
-$(BUILDDIR)/intobj/back/be_pcre.o: be_alloc.h  alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/intobj/back/be_pcre.o: be_alloc.h  alldefs.h global.h object.h symtab.h be_context.h
 $(BUILDDIR)/intobj/back/be_pcre.o: be_alloc.h  execute.h reswords.h be_alloc.h
 $(BUILDDIR)/intobj/back/be_pcre.o: be_alloc.h  be_runtime.h be_pcre.h pcre/pcre.h
 $(BUILDDIR)/intobj/back/be_pcre.o: be_machine.h
@@ -1061,67 +1082,90 @@ $(BUILDDIR)/intobj/back/be_rterror.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/intobj/back/be_rterror.o: execute.h reswords.h be_rterror.h
 $(BUILDDIR)/intobj/back/be_rterror.o: be_runtime.h be_task.h be_w.h
 $(BUILDDIR)/intobj/back/be_rterror.o: be_machine.h be_execute.h be_symtab.h
-$(BUILDDIR)/intobj/back/be_rterror.o: be_alloc.h be_syncolor.h be_debug.h
+$(BUILDDIR)/intobj/back/be_rterror.o: be_alloc.h be_syncolor.h be_debug.h be_parallel.h be_context.h
 $(BUILDDIR)/intobj/back/be_runtime.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/intobj/back/be_runtime.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/intobj/back/be_runtime.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/intobj/back/be_runtime.o: be_runtime.h be_machine.h be_inline.h
 $(BUILDDIR)/intobj/back/be_runtime.o: be_w.h be_callc.h be_task.h
 $(BUILDDIR)/intobj/back/be_runtime.o: be_rterror.h be_coverage.h be_execute.h
 $(BUILDDIR)/intobj/back/be_runtime.o: be_symtab.h
+$(BUILDDIR)/intobj/back/be_runtime.o: be_hash.h be_parallel.h
 $(BUILDDIR)/intobj/back/be_socket.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/intobj/back/be_socket.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/intobj/back/be_socket.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/intobj/back/be_socket.o: be_machine.h be_runtime.h be_socket.h
+$(BUILDDIR)/intobj/back/be_pool.o: be_pool.h
+$(BUILDDIR)/intobj/back/be_sort.o: alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/intobj/back/be_sort.o: execute.h reswords.h be_alloc.h be_runtime.h be_context.h
+$(BUILDDIR)/intobj/back/be_sort.o: be_machine.h be_pool.h be_sort.h
+$(BUILDDIR)/intobj/back/be_hash.o: alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/intobj/back/be_hash.o: execute.h reswords.h be_alloc.h be_runtime.h be_context.h
+$(BUILDDIR)/intobj/back/be_hash.o: be_machine.h be_hash.h
+$(BUILDDIR)/intobj/back/be_random.o: be_random.h be_hash.h alldefs.h global.h
+$(BUILDDIR)/intobj/back/be_random.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/intobj/back/be_random.o: be_alloc.h be_runtime.h be_machine.h be_context.h
+$(BUILDDIR)/intobj/back/be_walk.o: be_walk.h be_pool.h alldefs.h global.h
+$(BUILDDIR)/intobj/back/be_walk.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/intobj/back/be_walk.o: be_alloc.h be_runtime.h be_machine.h be_context.h
+$(BUILDDIR)/intobj/back/be_binary.o: be_binary.h alldefs.h global.h object.h
+$(BUILDDIR)/intobj/back/be_binary.o: symtab.h execute.h reswords.h be_alloc.h be_context.h
+$(BUILDDIR)/intobj/back/be_binary.o: be_runtime.h be_machine.h
+$(BUILDDIR)/intobj/back/be_parallel.o: be_parallel.h be_pool.h alldefs.h global.h
+$(BUILDDIR)/intobj/back/be_parallel.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/intobj/back/be_parallel.o: be_alloc.h be_runtime.h be_machine.h be_context.h
+$(BUILDDIR)/intobj/back/be_context.o: be_context.h be_alloc.h alldefs.h global.h
+$(BUILDDIR)/intobj/back/be_context.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/intobj/back/be_context.o: be_runtime.h be_execute.h be_task.h
 $(BUILDDIR)/intobj/back/be_symtab.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/intobj/back/be_symtab.o: execute.h reswords.h be_execute.h
-$(BUILDDIR)/intobj/back/be_symtab.o: be_alloc.h be_machine.h be_runtime.h
+$(BUILDDIR)/intobj/back/be_symtab.o: be_alloc.h be_machine.h be_runtime.h be_context.h
 $(BUILDDIR)/intobj/back/be_syncolor.o: be_w.h global.h object.h symtab.h
 $(BUILDDIR)/intobj/back/be_syncolor.o: execute.h alldefs.h reswords.h
-$(BUILDDIR)/intobj/back/be_syncolor.o: be_alloc.h be_machine.h be_syncolor.h
+$(BUILDDIR)/intobj/back/be_syncolor.o: be_alloc.h be_machine.h be_syncolor.h be_context.h
 $(BUILDDIR)/intobj/back/be_task.o: global.h object.h symtab.h execute.h
 $(BUILDDIR)/intobj/back/be_task.o: reswords.h be_runtime.h be_task.h
-$(BUILDDIR)/intobj/back/be_task.o: be_alloc.h be_machine.h be_execute.h
+$(BUILDDIR)/intobj/back/be_task.o: be_alloc.h be_machine.h be_execute.h be_context.h
 $(BUILDDIR)/intobj/back/be_task.o: be_symtab.h alldefs.h
-$(BUILDDIR)/intobj/back/be_w.o: be_alloc.h  alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/intobj/back/be_w.o: be_alloc.h  alldefs.h global.h object.h symtab.h be_context.h
 $(BUILDDIR)/intobj/back/be_w.o: be_alloc.h  execute.h reswords.h be_w.h be_machine.h
 $(BUILDDIR)/intobj/back/be_w.o: be_alloc.h  be_runtime.h be_rterror.h be_alloc.h
 $(BUILDDIR)/intobj/back/rbt.o: rbt.h
 
-$(BUILDDIR)/transobj/back/be_alloc.o: be_alloc.h  alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/transobj/back/be_alloc.o: be_alloc.h  alldefs.h global.h object.h symtab.h be_context.h
 $(BUILDDIR)/transobj/back/be_alloc.o: be_alloc.h  execute.h reswords.h be_runtime.h
 $(BUILDDIR)/transobj/back/be_alloc.o: be_alloc.h  be_alloc.h
 $(BUILDDIR)/transobj/back/be_callc.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/transobj/back/be_callc.o: execute.h reswords.h be_runtime.h
-$(BUILDDIR)/transobj/back/be_callc.o: be_machine.h be_alloc.h
+$(BUILDDIR)/transobj/back/be_callc.o: be_machine.h be_alloc.h be_context.h
 $(BUILDDIR)/transobj/back/be_coverage.o: be_coverage.h be_machine.h global.h
 $(BUILDDIR)/transobj/back/be_coverage.o: object.h symtab.h execute.h
 $(BUILDDIR)/transobj/back/be_debug.o: execute.h global.h object.h symtab.h
-$(BUILDDIR)/transobj/back/be_debug.o: be_alloc.h be_debug.h be_execute.h
+$(BUILDDIR)/transobj/back/be_debug.o: be_alloc.h be_debug.h be_execute.h be_context.h
 $(BUILDDIR)/transobj/back/be_debug.o: be_machine.h be_rterror.h be_runtime.h
 $(BUILDDIR)/transobj/back/be_debug.o: reswords.h
 $(BUILDDIR)/transobj/back/be_decompress.o: alldefs.h global.h object.h
 $(BUILDDIR)/transobj/back/be_decompress.o: symtab.h execute.h reswords.h
-$(BUILDDIR)/transobj/back/be_decompress.o: be_alloc.h be_runtime.h
+$(BUILDDIR)/transobj/back/be_decompress.o: be_alloc.h be_runtime.h be_context.h
 $(BUILDDIR)/transobj/back/be_execute.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/transobj/back/be_execute.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/transobj/back/be_execute.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/transobj/back/be_execute.o: be_runtime.h be_decompress.h
 $(BUILDDIR)/transobj/back/be_execute.o: be_inline.h be_machine.h be_task.h
 $(BUILDDIR)/transobj/back/be_execute.o: be_rterror.h be_symtab.h be_w.h
 $(BUILDDIR)/transobj/back/be_execute.o: be_callc.h be_coverage.h be_execute.h
 $(BUILDDIR)/transobj/back/be_inline.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/transobj/back/be_inline.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/transobj/back/be_inline.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/transobj/back/be_machine.o: global.h object.h symtab.h alldefs.h
 $(BUILDDIR)/transobj/back/be_machine.o: execute.h reswords.h version.h
 $(BUILDDIR)/transobj/back/be_machine.o: be_runtime.h be_rterror.h be_main.h
 $(BUILDDIR)/transobj/back/be_machine.o: be_w.h be_symtab.h be_machine.h
 $(BUILDDIR)/transobj/back/be_machine.o: be_pcre.h pcre/pcre.h be_task.h
-$(BUILDDIR)/transobj/back/be_machine.o: be_alloc.h be_execute.h be_socket.h
+$(BUILDDIR)/transobj/back/be_machine.o: be_alloc.h be_execute.h be_socket.h be_context.h
 $(BUILDDIR)/transobj/back/be_machine.o: be_coverage.h be_syncolor.h
-$(BUILDDIR)/transobj/back/be_machine.o: be_debug.h
+$(BUILDDIR)/transobj/back/be_machine.o: be_debug.h be_sort.h be_hash.h be_random.h be_walk.h be_binary.h be_parallel.h
 $(BUILDDIR)/transobj/back/be_main.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/transobj/back/be_main.o: execute.h reswords.h be_runtime.h
-$(BUILDDIR)/transobj/back/be_main.o: be_execute.h be_alloc.h be_rterror.h
+$(BUILDDIR)/transobj/back/be_main.o: be_execute.h be_alloc.h be_rterror.h be_context.h
 $(BUILDDIR)/transobj/back/be_main.o: be_w.h
-$(BUILDDIR)/transobj/back/be_pcre.o: be_alloc.h  alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/transobj/back/be_pcre.o: be_alloc.h  alldefs.h global.h object.h symtab.h be_context.h
 $(BUILDDIR)/transobj/back/be_pcre.o: be_alloc.h  execute.h reswords.h be_alloc.h
 $(BUILDDIR)/transobj/back/be_pcre.o: be_alloc.h  be_runtime.h be_pcre.h pcre/pcre.h
 $(BUILDDIR)/transobj/back/be_pcre.o: be_machine.h
@@ -1129,67 +1173,91 @@ $(BUILDDIR)/transobj/back/be_rterror.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/transobj/back/be_rterror.o: execute.h reswords.h be_rterror.h
 $(BUILDDIR)/transobj/back/be_rterror.o: be_runtime.h be_task.h be_w.h
 $(BUILDDIR)/transobj/back/be_rterror.o: be_machine.h be_execute.h be_symtab.h
-$(BUILDDIR)/transobj/back/be_rterror.o: be_alloc.h be_syncolor.h be_debug.h
+$(BUILDDIR)/transobj/back/be_rterror.o: be_alloc.h be_syncolor.h be_debug.h be_parallel.h be_context.h
 $(BUILDDIR)/transobj/back/be_runtime.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/transobj/back/be_runtime.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/transobj/back/be_runtime.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/transobj/back/be_runtime.o: be_runtime.h be_machine.h be_inline.h
 $(BUILDDIR)/transobj/back/be_runtime.o: be_w.h be_callc.h be_task.h
 $(BUILDDIR)/transobj/back/be_runtime.o: be_rterror.h be_coverage.h
 $(BUILDDIR)/transobj/back/be_runtime.o: be_execute.h be_symtab.h
+$(BUILDDIR)/transobj/back/be_runtime.o: be_hash.h be_parallel.h
 $(BUILDDIR)/transobj/back/be_socket.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/transobj/back/be_socket.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/transobj/back/be_socket.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/transobj/back/be_socket.o: be_machine.h be_runtime.h be_socket.h
+$(BUILDDIR)/transobj/back/be_pool.o: be_pool.h
+$(BUILDDIR)/transobj/back/be_sort.o: alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/transobj/back/be_sort.o: execute.h reswords.h be_alloc.h be_runtime.h be_context.h
+$(BUILDDIR)/transobj/back/be_sort.o: be_machine.h be_pool.h be_sort.h
+$(BUILDDIR)/transobj/back/be_hash.o: alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/transobj/back/be_hash.o: execute.h reswords.h be_alloc.h be_runtime.h be_context.h
+$(BUILDDIR)/transobj/back/be_hash.o: be_machine.h be_hash.h
+$(BUILDDIR)/transobj/back/be_random.o: be_random.h be_hash.h alldefs.h global.h
+$(BUILDDIR)/transobj/back/be_random.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/transobj/back/be_random.o: be_alloc.h be_runtime.h be_machine.h be_context.h
+$(BUILDDIR)/transobj/back/be_walk.o: be_walk.h be_pool.h alldefs.h global.h
+$(BUILDDIR)/transobj/back/be_walk.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/transobj/back/be_walk.o: be_alloc.h be_runtime.h be_machine.h be_context.h
+$(BUILDDIR)/transobj/back/be_binary.o: be_binary.h alldefs.h global.h object.h
+$(BUILDDIR)/transobj/back/be_binary.o: symtab.h execute.h reswords.h be_alloc.h be_context.h
+$(BUILDDIR)/transobj/back/be_binary.o: be_runtime.h be_machine.h
+$(BUILDDIR)/transobj/back/be_parallel.o: be_parallel.h be_pool.h alldefs.h global.h
+$(BUILDDIR)/transobj/back/be_parallel.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/transobj/back/be_parallel.o: be_alloc.h be_runtime.h be_machine.h be_context.h
+$(BUILDDIR)/transobj/back/be_context.o: be_context.h be_alloc.h alldefs.h global.h
+$(BUILDDIR)/transobj/back/be_context.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/transobj/back/be_context.o: be_runtime.h be_execute.h be_task.h
 $(BUILDDIR)/transobj/back/be_symtab.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/transobj/back/be_symtab.o: execute.h reswords.h be_execute.h
-$(BUILDDIR)/transobj/back/be_symtab.o: be_alloc.h be_machine.h be_runtime.h
+$(BUILDDIR)/transobj/back/be_symtab.o: be_alloc.h be_machine.h be_runtime.h be_context.h
 $(BUILDDIR)/transobj/back/be_syncolor.o: be_w.h global.h object.h symtab.h
 $(BUILDDIR)/transobj/back/be_syncolor.o: execute.h alldefs.h reswords.h
-$(BUILDDIR)/transobj/back/be_syncolor.o: be_alloc.h be_machine.h
+$(BUILDDIR)/transobj/back/be_syncolor.o: be_alloc.h be_machine.h be_context.h
 $(BUILDDIR)/transobj/back/be_syncolor.o: be_syncolor.h
 $(BUILDDIR)/transobj/back/be_task.o: global.h object.h symtab.h execute.h
 $(BUILDDIR)/transobj/back/be_task.o: reswords.h be_runtime.h be_task.h
-$(BUILDDIR)/transobj/back/be_task.o: be_alloc.h be_machine.h be_execute.h
+$(BUILDDIR)/transobj/back/be_task.o: be_alloc.h be_machine.h be_execute.h be_context.h
 $(BUILDDIR)/transobj/back/be_task.o: be_symtab.h alldefs.h
-$(BUILDDIR)/transobj/back/be_w.o: be_alloc.h  alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/transobj/back/be_w.o: be_alloc.h  alldefs.h global.h object.h symtab.h be_context.h
 $(BUILDDIR)/transobj/back/be_w.o: be_alloc.h  execute.h reswords.h be_w.h be_machine.h
 $(BUILDDIR)/transobj/back/be_w.o: be_alloc.h  be_runtime.h be_rterror.h be_alloc.h
 $(BUILDDIR)/transobj/back/rbt.o: rbt.h
 
-$(BUILDDIR)/backobj/back/be_alloc.o: be_alloc.h  alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/backobj/back/be_alloc.o: be_alloc.h  alldefs.h global.h object.h symtab.h be_context.h
 $(BUILDDIR)/backobj/back/be_alloc.o: be_alloc.h  execute.h reswords.h be_runtime.h
 $(BUILDDIR)/backobj/back/be_alloc.o: be_alloc.h  be_alloc.h
 $(BUILDDIR)/backobj/back/be_callc.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/backobj/back/be_callc.o: execute.h reswords.h be_runtime.h
-$(BUILDDIR)/backobj/back/be_callc.o: be_machine.h be_alloc.h
+$(BUILDDIR)/backobj/back/be_callc.o: be_machine.h be_alloc.h be_context.h
 $(BUILDDIR)/backobj/back/be_coverage.o: be_coverage.h be_machine.h global.h
 $(BUILDDIR)/backobj/back/be_coverage.o: object.h symtab.h execute.h
 $(BUILDDIR)/backobj/back/be_debug.o: execute.h global.h object.h symtab.h
-$(BUILDDIR)/backobj/back/be_debug.o: be_alloc.h be_debug.h be_execute.h
+$(BUILDDIR)/backobj/back/be_debug.o: be_alloc.h be_debug.h be_execute.h be_context.h
 $(BUILDDIR)/backobj/back/be_debug.o: be_machine.h be_rterror.h be_runtime.h
 $(BUILDDIR)/backobj/back/be_debug.o: reswords.h
 $(BUILDDIR)/backobj/back/be_decompress.o: alldefs.h global.h object.h
 $(BUILDDIR)/backobj/back/be_decompress.o: symtab.h execute.h reswords.h
-$(BUILDDIR)/backobj/back/be_decompress.o: be_alloc.h be_runtime.h
+$(BUILDDIR)/backobj/back/be_decompress.o: be_alloc.h be_runtime.h be_context.h
 $(BUILDDIR)/backobj/back/be_execute.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/backobj/back/be_execute.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/backobj/back/be_execute.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/backobj/back/be_execute.o: be_runtime.h be_decompress.h
 $(BUILDDIR)/backobj/back/be_execute.o: be_inline.h be_machine.h be_task.h
 $(BUILDDIR)/backobj/back/be_execute.o: be_rterror.h be_symtab.h be_w.h
 $(BUILDDIR)/backobj/back/be_execute.o: be_callc.h be_coverage.h be_execute.h
 $(BUILDDIR)/backobj/back/be_inline.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/backobj/back/be_inline.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/backobj/back/be_inline.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/backobj/back/be_machine.o: global.h object.h symtab.h alldefs.h
 $(BUILDDIR)/backobj/back/be_machine.o: execute.h reswords.h version.h
 $(BUILDDIR)/backobj/back/be_machine.o: be_runtime.h be_rterror.h be_main.h
 $(BUILDDIR)/backobj/back/be_machine.o: be_w.h be_symtab.h be_machine.h
 $(BUILDDIR)/backobj/back/be_machine.o: be_pcre.h pcre/pcre.h be_task.h
-$(BUILDDIR)/backobj/back/be_machine.o: be_alloc.h be_execute.h be_socket.h
+$(BUILDDIR)/backobj/back/be_machine.o: be_alloc.h be_execute.h be_socket.h be_context.h
 $(BUILDDIR)/backobj/back/be_machine.o: be_coverage.h be_syncolor.h be_debug.h
+$(BUILDDIR)/backobj/back/be_machine.o: be_sort.h be_hash.h be_random.h be_walk.h be_binary.h be_parallel.h
 $(BUILDDIR)/backobj/back/be_main.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/backobj/back/be_main.o: execute.h reswords.h be_runtime.h
-$(BUILDDIR)/backobj/back/be_main.o: be_execute.h be_alloc.h be_rterror.h
+$(BUILDDIR)/backobj/back/be_main.o: be_execute.h be_alloc.h be_rterror.h be_context.h
 $(BUILDDIR)/backobj/back/be_main.o: be_w.h
-$(BUILDDIR)/backobj/back/be_pcre.o: be_alloc.h  alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/backobj/back/be_pcre.o: be_alloc.h  alldefs.h global.h object.h symtab.h be_context.h
 $(BUILDDIR)/backobj/back/be_pcre.o: be_alloc.h  execute.h reswords.h be_alloc.h
 $(BUILDDIR)/backobj/back/be_pcre.o: be_alloc.h  be_runtime.h be_pcre.h pcre/pcre.h
 $(BUILDDIR)/backobj/back/be_pcre.o: be_machine.h
@@ -1197,66 +1265,90 @@ $(BUILDDIR)/backobj/back/be_rterror.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/backobj/back/be_rterror.o: execute.h reswords.h be_rterror.h
 $(BUILDDIR)/backobj/back/be_rterror.o: be_runtime.h be_task.h be_w.h
 $(BUILDDIR)/backobj/back/be_rterror.o: be_machine.h be_execute.h be_symtab.h
-$(BUILDDIR)/backobj/back/be_rterror.o: be_alloc.h be_syncolor.h be_debug.h
+$(BUILDDIR)/backobj/back/be_rterror.o: be_alloc.h be_syncolor.h be_debug.h be_parallel.h be_context.h
 $(BUILDDIR)/backobj/back/be_runtime.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/backobj/back/be_runtime.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/backobj/back/be_runtime.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/backobj/back/be_runtime.o: be_runtime.h be_machine.h be_inline.h
 $(BUILDDIR)/backobj/back/be_runtime.o: be_w.h be_callc.h be_task.h
 $(BUILDDIR)/backobj/back/be_runtime.o: be_rterror.h be_coverage.h
 $(BUILDDIR)/backobj/back/be_runtime.o: be_execute.h be_symtab.h
+$(BUILDDIR)/backobj/back/be_runtime.o: be_hash.h be_parallel.h
 $(BUILDDIR)/backobj/back/be_socket.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/backobj/back/be_socket.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/backobj/back/be_socket.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/backobj/back/be_socket.o: be_machine.h be_runtime.h be_socket.h
+$(BUILDDIR)/backobj/back/be_pool.o: be_pool.h
+$(BUILDDIR)/backobj/back/be_sort.o: alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/backobj/back/be_sort.o: execute.h reswords.h be_alloc.h be_runtime.h be_context.h
+$(BUILDDIR)/backobj/back/be_sort.o: be_machine.h be_pool.h be_sort.h
+$(BUILDDIR)/backobj/back/be_hash.o: alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/backobj/back/be_hash.o: execute.h reswords.h be_alloc.h be_runtime.h be_context.h
+$(BUILDDIR)/backobj/back/be_hash.o: be_machine.h be_hash.h
+$(BUILDDIR)/backobj/back/be_random.o: be_random.h be_hash.h alldefs.h global.h
+$(BUILDDIR)/backobj/back/be_random.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/backobj/back/be_random.o: be_alloc.h be_runtime.h be_machine.h be_context.h
+$(BUILDDIR)/backobj/back/be_walk.o: be_walk.h be_pool.h alldefs.h global.h
+$(BUILDDIR)/backobj/back/be_walk.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/backobj/back/be_walk.o: be_alloc.h be_runtime.h be_machine.h be_context.h
+$(BUILDDIR)/backobj/back/be_binary.o: be_binary.h alldefs.h global.h object.h
+$(BUILDDIR)/backobj/back/be_binary.o: symtab.h execute.h reswords.h be_alloc.h be_context.h
+$(BUILDDIR)/backobj/back/be_binary.o: be_runtime.h be_machine.h
+$(BUILDDIR)/backobj/back/be_parallel.o: be_parallel.h be_pool.h alldefs.h global.h
+$(BUILDDIR)/backobj/back/be_parallel.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/backobj/back/be_parallel.o: be_alloc.h be_runtime.h be_machine.h be_context.h
+$(BUILDDIR)/backobj/back/be_context.o: be_context.h be_alloc.h alldefs.h global.h
+$(BUILDDIR)/backobj/back/be_context.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/backobj/back/be_context.o: be_runtime.h be_execute.h be_task.h
 $(BUILDDIR)/backobj/back/be_symtab.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/backobj/back/be_symtab.o: execute.h reswords.h be_execute.h
-$(BUILDDIR)/backobj/back/be_symtab.o: be_alloc.h be_machine.h be_runtime.h
+$(BUILDDIR)/backobj/back/be_symtab.o: be_alloc.h be_machine.h be_runtime.h be_context.h
 $(BUILDDIR)/backobj/back/be_syncolor.o: be_w.h global.h object.h symtab.h
 $(BUILDDIR)/backobj/back/be_syncolor.o: execute.h alldefs.h reswords.h
-$(BUILDDIR)/backobj/back/be_syncolor.o: be_alloc.h be_machine.h be_syncolor.h
+$(BUILDDIR)/backobj/back/be_syncolor.o: be_alloc.h be_machine.h be_syncolor.h be_context.h
 $(BUILDDIR)/backobj/back/be_task.o: global.h object.h symtab.h execute.h
 $(BUILDDIR)/backobj/back/be_task.o: reswords.h be_runtime.h be_task.h
-$(BUILDDIR)/backobj/back/be_task.o: be_alloc.h be_machine.h be_execute.h
+$(BUILDDIR)/backobj/back/be_task.o: be_alloc.h be_machine.h be_execute.h be_context.h
 $(BUILDDIR)/backobj/back/be_task.o: be_symtab.h alldefs.h
-$(BUILDDIR)/backobj/back/be_w.o: be_alloc.h  alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/backobj/back/be_w.o: be_alloc.h  alldefs.h global.h object.h symtab.h be_context.h
 $(BUILDDIR)/backobj/back/be_w.o: be_alloc.h  execute.h reswords.h be_w.h be_machine.h
 $(BUILDDIR)/backobj/back/be_w.o: be_alloc.h  be_runtime.h be_rterror.h be_alloc.h
 $(BUILDDIR)/backobj/back/rbt.o: rbt.h
 
-$(BUILDDIR)/libobj/back/be_alloc.o: be_alloc.h  alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/libobj/back/be_alloc.o: be_alloc.h  alldefs.h global.h object.h symtab.h be_context.h
 $(BUILDDIR)/libobj/back/be_alloc.o: be_alloc.h  execute.h reswords.h be_runtime.h
 $(BUILDDIR)/libobj/back/be_alloc.o: be_alloc.h  be_alloc.h
 $(BUILDDIR)/libobj/back/be_callc.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/libobj/back/be_callc.o: execute.h reswords.h be_runtime.h
-$(BUILDDIR)/libobj/back/be_callc.o: be_machine.h be_alloc.h
+$(BUILDDIR)/libobj/back/be_callc.o: be_machine.h be_alloc.h be_context.h
 $(BUILDDIR)/libobj/back/be_coverage.o: be_coverage.h be_machine.h global.h
 $(BUILDDIR)/libobj/back/be_coverage.o: object.h symtab.h execute.h
 $(BUILDDIR)/libobj/back/be_debug.o: execute.h global.h object.h symtab.h
-$(BUILDDIR)/libobj/back/be_debug.o: be_alloc.h be_debug.h be_execute.h
+$(BUILDDIR)/libobj/back/be_debug.o: be_alloc.h be_debug.h be_execute.h be_context.h
 $(BUILDDIR)/libobj/back/be_debug.o: be_machine.h be_rterror.h be_runtime.h
 $(BUILDDIR)/libobj/back/be_debug.o: reswords.h
 $(BUILDDIR)/libobj/back/be_decompress.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/libobj/back/be_decompress.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/libobj/back/be_decompress.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/libobj/back/be_decompress.o: be_runtime.h
 $(BUILDDIR)/libobj/back/be_execute.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/libobj/back/be_execute.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/libobj/back/be_execute.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/libobj/back/be_execute.o: be_runtime.h be_decompress.h
 $(BUILDDIR)/libobj/back/be_execute.o: be_inline.h be_machine.h be_task.h
 $(BUILDDIR)/libobj/back/be_execute.o: be_rterror.h be_symtab.h be_w.h
 $(BUILDDIR)/libobj/back/be_execute.o: be_callc.h be_coverage.h be_execute.h
 $(BUILDDIR)/libobj/back/be_inline.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/libobj/back/be_inline.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/libobj/back/be_inline.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/libobj/back/be_machine.o: global.h object.h symtab.h alldefs.h
 $(BUILDDIR)/libobj/back/be_machine.o: execute.h reswords.h version.h
 $(BUILDDIR)/libobj/back/be_machine.o: be_runtime.h be_rterror.h be_main.h
 $(BUILDDIR)/libobj/back/be_machine.o: be_w.h be_symtab.h be_machine.h
 $(BUILDDIR)/libobj/back/be_machine.o: be_pcre.h pcre/pcre.h be_task.h
-$(BUILDDIR)/libobj/back/be_machine.o: be_alloc.h be_execute.h be_socket.h
+$(BUILDDIR)/libobj/back/be_machine.o: be_alloc.h be_execute.h be_socket.h be_context.h
 $(BUILDDIR)/libobj/back/be_machine.o: be_coverage.h be_syncolor.h be_debug.h
+$(BUILDDIR)/libobj/back/be_machine.o: be_sort.h be_hash.h be_random.h be_walk.h be_binary.h be_parallel.h
 $(BUILDDIR)/libobj/back/be_main.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/libobj/back/be_main.o: execute.h reswords.h be_runtime.h
-$(BUILDDIR)/libobj/back/be_main.o: be_execute.h be_alloc.h be_rterror.h
+$(BUILDDIR)/libobj/back/be_main.o: be_execute.h be_alloc.h be_rterror.h be_context.h
 $(BUILDDIR)/libobj/back/be_main.o: be_w.h
-$(BUILDDIR)/libobj/back/be_pcre.o: be_alloc.h  alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/libobj/back/be_pcre.o: be_alloc.h  alldefs.h global.h object.h symtab.h be_context.h
 $(BUILDDIR)/libobj/back/be_pcre.o: be_alloc.h  execute.h reswords.h be_alloc.h
 $(BUILDDIR)/libobj/back/be_pcre.o: be_alloc.h  be_runtime.h be_pcre.h pcre/pcre.h
 $(BUILDDIR)/libobj/back/be_pcre.o: be_machine.h
@@ -1264,27 +1356,50 @@ $(BUILDDIR)/libobj/back/be_rterror.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/libobj/back/be_rterror.o: execute.h reswords.h be_rterror.h
 $(BUILDDIR)/libobj/back/be_rterror.o: be_runtime.h be_task.h be_w.h
 $(BUILDDIR)/libobj/back/be_rterror.o: be_machine.h be_execute.h be_symtab.h
-$(BUILDDIR)/libobj/back/be_rterror.o: be_alloc.h be_syncolor.h be_debug.h
+$(BUILDDIR)/libobj/back/be_rterror.o: be_alloc.h be_syncolor.h be_debug.h be_parallel.h be_context.h
 $(BUILDDIR)/libobj/back/be_runtime.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/libobj/back/be_runtime.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/libobj/back/be_runtime.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/libobj/back/be_runtime.o: be_runtime.h be_machine.h be_inline.h
 $(BUILDDIR)/libobj/back/be_runtime.o: be_w.h be_callc.h be_task.h
 $(BUILDDIR)/libobj/back/be_runtime.o: be_rterror.h be_coverage.h be_execute.h
 $(BUILDDIR)/libobj/back/be_runtime.o: be_symtab.h
+$(BUILDDIR)/libobj/back/be_runtime.o: be_hash.h be_parallel.h
 $(BUILDDIR)/libobj/back/be_socket.o: alldefs.h global.h object.h symtab.h
-$(BUILDDIR)/libobj/back/be_socket.o: execute.h reswords.h be_alloc.h
+$(BUILDDIR)/libobj/back/be_socket.o: execute.h reswords.h be_alloc.h be_context.h
 $(BUILDDIR)/libobj/back/be_socket.o: be_machine.h be_runtime.h be_socket.h
+$(BUILDDIR)/libobj/back/be_pool.o: be_pool.h
+$(BUILDDIR)/libobj/back/be_sort.o: alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/libobj/back/be_sort.o: execute.h reswords.h be_alloc.h be_runtime.h be_context.h
+$(BUILDDIR)/libobj/back/be_sort.o: be_machine.h be_pool.h be_sort.h
+$(BUILDDIR)/libobj/back/be_hash.o: alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/libobj/back/be_hash.o: execute.h reswords.h be_alloc.h be_runtime.h be_context.h
+$(BUILDDIR)/libobj/back/be_hash.o: be_machine.h be_hash.h
+$(BUILDDIR)/libobj/back/be_random.o: be_random.h be_hash.h alldefs.h global.h
+$(BUILDDIR)/libobj/back/be_random.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/libobj/back/be_random.o: be_alloc.h be_runtime.h be_machine.h be_context.h
+$(BUILDDIR)/libobj/back/be_walk.o: be_walk.h be_pool.h alldefs.h global.h
+$(BUILDDIR)/libobj/back/be_walk.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/libobj/back/be_walk.o: be_alloc.h be_runtime.h be_machine.h be_context.h
+$(BUILDDIR)/libobj/back/be_binary.o: be_binary.h alldefs.h global.h object.h
+$(BUILDDIR)/libobj/back/be_binary.o: symtab.h execute.h reswords.h be_alloc.h be_context.h
+$(BUILDDIR)/libobj/back/be_binary.o: be_runtime.h be_machine.h
+$(BUILDDIR)/libobj/back/be_parallel.o: be_parallel.h be_pool.h alldefs.h global.h
+$(BUILDDIR)/libobj/back/be_parallel.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/libobj/back/be_parallel.o: be_alloc.h be_runtime.h be_machine.h be_context.h
+$(BUILDDIR)/libobj/back/be_context.o: be_context.h be_alloc.h alldefs.h global.h
+$(BUILDDIR)/libobj/back/be_context.o: object.h symtab.h execute.h reswords.h
+$(BUILDDIR)/libobj/back/be_context.o: be_runtime.h be_execute.h be_task.h
 $(BUILDDIR)/libobj/back/be_symtab.o: alldefs.h global.h object.h symtab.h
 $(BUILDDIR)/libobj/back/be_symtab.o: execute.h reswords.h be_execute.h
-$(BUILDDIR)/libobj/back/be_symtab.o: be_alloc.h be_machine.h be_runtime.h
+$(BUILDDIR)/libobj/back/be_symtab.o: be_alloc.h be_machine.h be_runtime.h be_context.h
 $(BUILDDIR)/libobj/back/be_syncolor.o: be_w.h global.h object.h symtab.h
 $(BUILDDIR)/libobj/back/be_syncolor.o: execute.h alldefs.h reswords.h
-$(BUILDDIR)/libobj/back/be_syncolor.o: be_alloc.h be_machine.h be_syncolor.h
+$(BUILDDIR)/libobj/back/be_syncolor.o: be_alloc.h be_machine.h be_syncolor.h be_context.h
 $(BUILDDIR)/libobj/back/be_task.o: global.h object.h symtab.h execute.h
 $(BUILDDIR)/libobj/back/be_task.o: reswords.h be_runtime.h be_task.h
-$(BUILDDIR)/libobj/back/be_task.o: be_alloc.h be_machine.h be_execute.h
+$(BUILDDIR)/libobj/back/be_task.o: be_alloc.h be_machine.h be_execute.h be_context.h
 $(BUILDDIR)/libobj/back/be_task.o: be_symtab.h alldefs.h
-$(BUILDDIR)/libobj/back/be_w.o: be_alloc.h  alldefs.h global.h object.h symtab.h
+$(BUILDDIR)/libobj/back/be_w.o: be_alloc.h  alldefs.h global.h object.h symtab.h be_context.h
 $(BUILDDIR)/libobj/back/be_w.o: be_alloc.h  execute.h reswords.h be_w.h be_machine.h
 $(BUILDDIR)/libobj/back/be_w.o: be_alloc.h  be_runtime.h be_rterror.h be_alloc.h
 $(BUILDDIR)/libobj/back/rbt.o: rbt.h
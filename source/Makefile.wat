@@ -172,6 +172,14 @@ EU_BACKEND_OBJECTS = &
 	$(BUILDDIR)\$(OBJDIR)\back\be_rterror.obj &
 	$(BUILDDIR)\$(OBJDIR)\back\be_runtime.obj &
 	$(BUILDDIR)\$(OBJDIR)\back\be_socket.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_context.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_parallel.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_binary.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_walk.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_random.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_hash.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_sort.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_pool.obj &
 	$(BUILDDIR)\$(OBJDIR)\back\be_symtab.obj &
 	$(BUILDDIR)\$(OBJDIR)\back\be_syncolor.obj &
 	$(BUILDDIR)\$(OBJDIR)\back\be_task.obj &
@@ -188,6 +196,14 @@ EU_LIB_OBJECTS = &
 	$(BUILDDIR)\$(OBJDIR)\back\be_pcre.obj &
 	$(BUILDDIR)\$(OBJDIR)\back\be_runtime.obj &
 	$(BUILDDIR)\$(OBJDIR)\back\be_socket.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_context.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_parallel.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_binary.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_walk.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_random.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_hash.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_sort.obj &
+	$(BUILDDIR)\$(OBJDIR)\back\be_pool.obj &
 	$(BUILDDIR)\$(OBJDIR)\back\be_syncolor.obj &
 	$(BUILDDIR)\$(OBJDIR)\back\be_task.obj &
 	$(BUILDDIR)\$(OBJDIR)\back\be_w.obj &
@@ -802,6 +818,14 @@ $(BUILDDIR)\$(OBJDIR)\back\be_symtab.obj : be_symtab.c *.h $(CONFIG)
 $(BUILDDIR)\$(OBJDIR)\back\be_w.obj : be_w.c *.h $(CONFIG) 
 $(BUILDDIR)\$(OBJDIR)\back\be_socket.obj : be_socket.c *.h $(CONFIG)
 $(BUILDDIR)\$(OBJDIR)\back\be_pcre.obj : be_pcre.c *.h $(CONFIG) 
+$(BUILDDIR)\$(OBJDIR)\back\be_context.obj : be_context.c *.h $(CONFIG)
+$(BUILDDIR)\$(OBJDIR)\back\be_parallel.obj : be_parallel.c *.h $(CONFIG)
+$(BUILDDIR)\$(OBJDIR)\back\be_binary.obj : be_binary.c *.h $(CONFIG)
+$(BUILDDIR)\$(OBJDIR)\back\be_walk.obj : be_walk.c *.h $(CONFIG)
+$(BUILDDIR)\$(OBJDIR)\back\be_random.obj : be_random.c *.h $(CONFIG)
+$(BUILDDIR)\$(OBJDIR)\back\be_hash.obj : be_hash.c *.h $(CONFIG)
+$(BUILDDIR)\$(OBJDIR)\back\be_sort.obj : be_sort.c *.h $(CONFIG)
+$(BUILDDIR)\$(OBJDIR)\back\be_pool.obj : be_pool.c *.h $(CONFIG)
 
 # end of OBJDIR exists
 !endif
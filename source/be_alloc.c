@@ -46,7 +46,6 @@
 /******************/
 /* Local defines  */
 /******************/
-#define NUMBER_OF_FBL 14        /* number of lists in free block set */
 #define STR_CHUNK_SIZE 4096     /* chars */
 #define SYM_CHUNK_SIZE 50       /* entries */
 #define TMP_CHUNK_SIZE 50       /* entries */
@@ -72,8 +71,6 @@ int eu_dll_exists = FALSE; // a Euphoria .dll is being used
 int align4 = 0;
 #endif
 
-int low_on_space = FALSE;  // are we almost out of memory?
-unsigned cache_size = 0;
 symtab_ptr call_back_arg1, call_back_arg2, call_back_arg3, call_back_arg4,
 		   call_back_arg5, call_back_arg6, call_back_arg7, call_back_arg8,
 		   call_back_arg9, call_back_result;
@@ -92,17 +89,9 @@ unsigned long bytes_allocated = 0;       /* current number of object blocks allo
 unsigned long max_bytes_allocated = 0;   /* high water mark */
 #endif
 
-d_ptr d_list = NULL;
-//static int dblcnt = 0;
-static struct block_list *pool_map[MAX_CACHED_SIZE/RESOLUTION+1]; /* maps size desired
-														  to appropriate list */
-
-
-/*******************/
-/* Local variables */
-/*******************/
-static struct block_list freeblk_list[NUMBER_OF_FBL]; /* set of free block lists */
-						 /* elements not power of 2 - but not used much */
+/* d_list, pool_map (which maps the size desired to the appropriate list)
+   and freeblk_list (the set of free block lists) belong to the runtime
+   context - see be_context.h */
 
 /**********************/
 /* Declared functions */
@@ -161,17 +150,12 @@ long getpagesize (void) {
 }
 #endif
 
-void InitEMalloc()
-/* initialize storage allocator */
+void InitStorageCache()
+/* initialize the storage cache of the current runtime context */
 {
 	int i, j, p;
-	static int done = 0 ;
 
-	if (done) return;
-	done = 1;
-	pagesize = getpagesize();
 #ifndef UNIX
-	// DJP // eu_dll_exists = (Argc == 0);  // Argc is 0 only in Euphoria .dll
 	freeblk_list[0].size = 8;
 	freeblk_list[0].first = NULL;
 	p = RESOLUTION * 2;
@@ -192,6 +176,53 @@ void InitEMalloc()
 		pool_map[i] = &freeblk_list[j];
 	}
 #endif
+}
+
+void FreeStorageCache()
+/* release everything in the storage cache of the current runtime context
+   back to the heap, including the blocks that doubles are carved from.
+   Any doubles still in use are freed too. */
+{
+	int i;
+	free_block_ptr p, next;
+	unsigned char *q;
+
+	for (i = 0; i < NUMBER_OF_FBL; i++) {
+		p = freeblk_list[i].first;
+		while (p != NULL) {
+			next = p->next;
+			q = (unsigned char *)p;
+			#if defined(EALIGN4)
+			if (align4 && *(int *)(q-4) == MAGIC_FILLER)
+				q = q - 4;
+			#endif
+			free(q);
+			p = next;
+		}
+		freeblk_list[i].first = NULL;
+	}
+	p = dbl_blocks;
+	while (p != NULL) {
+		next = p->next;
+		EFree((char *)p);
+		p = next;
+	}
+	dbl_blocks = NULL;
+	d_list = NULL;
+	cache_size = 0;
+}
+
+void InitEMalloc()
+/* initialize storage allocator */
+{
+	static int done = 0 ;
+
+	if (done) return;
+	done = 1;
+	pagesize = getpagesize();
+	// DJP // eu_dll_exists = (Argc == 0);  // Argc is 0 only in Euphoria .dll
+	InitStorageCache();
+
 	call_back_arg1 = tmp_alloc();
 	call_back_arg1->mode = M_TEMP;
 	call_back_arg1->obj = NOVALUE;
@@ -984,7 +1015,7 @@ static void new_dbl_block(unsigned int cnt)
 	// Each element in the array must be on an 8-byte boundary.
 	dsize = (D_SIZE + 7) & (~7);
 
-	blksize = cnt * dsize;
+	blksize = (cnt + 1) * dsize;
 	dbl_block = (free_block_ptr)EMalloc( blksize );
 	assert(((uintptr_t)dbl_block & 7) == 0);
 
@@ -998,6 +1029,12 @@ static void new_dbl_block(unsigned int cnt)
 	Allocated(block_size(q));
 #endif
 
+	// The first element links the block into dbl_blocks, so that
+	// FreeStorageCache() can find it again.
+	dbl_block->next = dbl_blocks;
+	dbl_blocks = dbl_block;
+	dbl_block = (free_block_ptr)((char *)dbl_block + dsize);
+
 	chkcnt = 0;
 	d_list = (d_ptr)dbl_block;
 	while(cnt > 1) {
@@ -129,7 +129,6 @@ typedef struct block_list * block_list_ptr;
 	#define FreeD(p) freeD(p)
 	#define Trash(a,n) memset(a, (char)0x11, n)
 #else
-	extern d_ptr d_list;
 	#define FreeD(p){ ((free_block_ptr)p)->next = (free_block_ptr)d_list; \
 					  d_list = (d_ptr)p; \
 					}
@@ -175,7 +174,6 @@ char *malloc_options;
 extern long pagesize;  // needed for Linux only, not FreeBSD
 
 extern int eu_dll_exists; // a Euphoria .dll is being used
-extern int low_on_space;  // are we almost out of memory?
 extern symtab_ptr call_back_arg1, call_back_arg2, call_back_arg3, call_back_arg4,
  		   call_back_arg5, call_back_arg6, call_back_arg7, call_back_arg8,
  		   call_back_arg9, call_back_result;
@@ -195,6 +193,8 @@ extern unsigned long max_bytes_allocated;   /* high water mark */
 #endif
 
 extern void InitEMalloc();
+extern void InitStorageCache();
+extern void FreeStorageCache();
 extern object NewSequence(char *data, int len);
 extern object NewString(char *s);
 extern s1_ptr NewS1(intptr_t size);
@@ -211,4 +211,7 @@ __attribute__ ((noreturn))
 #pragma aux SpaceMessage aborts;
 #endif
 ;
+
+#include "be_context.h"
+
 #endif
@@ -0,0 +1,598 @@
+/*****************************************************************************/
+/*      (c) Copyright - See License.txt       */
+/*****************************************************************************/
+/*                                                                           */
+/*                         Binary Array Conversion                           */
+/*                                                                           */
+/*****************************************************************************/
+
+/* get_integer32(), int_to_bytes(), float64_to_atom() and friends handle one
+   value per call.  These routines convert whole arrays of fixed width
+   numbers - 8, 16, 32 or 64-bit integers, signed or not, and 32 or 64-bit
+   IEEE floating point - between a Euphoria sequence and a file or a
+   sequence of bytes, in either byte order.
+
+   The element type is given with the C_ type constants from std/dll.e:
+   the top byte is the kind of number and the low byte its size.
+
+   The same conversions gather values from, or scatter them to, raw memory:
+   a list of addresses, or a base address with a regular stride, in one
+   call instead of one peek() or poke() per value. */
+
+#define _LARGEFILE64_SOURCE
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "alldefs.h"
+#include "be_alloc.h"
+#include "be_runtime.h"
+#include "be_machine.h"
+#include "be_binary.h"
+
+#define KIND_SIGNED   1
+#define KIND_UNSIGNED 2
+#define KIND_FLOAT    3
+
+
+struct array_type {
+	int width;  // bytes per element
+	int kind;
+	int big;    // TRUE for big endian (most significant byte first)
+	int swap;   // TRUE if that differs from this machine's byte order
+};
+
+static int host_big_endian()
+{
+	uint16_t one = 1;
+
+	return *(unsigned char *)&one == 0;
+}
+
+static void get_array_type(struct array_type *t, object type, object big_endian, char *where)
+{
+	uintptr_t code;
+
+	if (IS_ATOM_INT(type))
+		code = (uintptr_t)type;
+	else if (IS_ATOM_DBL(type))
+		code = (uintptr_t)DBL_PTR(type)->dbl;
+	else
+		code = 0;
+	t->width = (int)(code & 0xFF);
+	t->kind = (int)((code >> 24) & 0xFF);
+
+	if (code == C_LONGLONG) {
+		t->width = 8;
+		t->kind = KIND_SIGNED;
+	}
+	else if (code == C_POINTER) {
+		t->width = sizeof(void *);
+		t->kind = KIND_UNSIGNED;
+	}
+	if (!((t->kind == KIND_SIGNED || t->kind == KIND_UNSIGNED) &&
+		  (t->width == 1 || t->width == 2 || t->width == 4 || t->width == 8)) &&
+		!(t->kind == KIND_FLOAT && (t->width == 4 || t->width == 8)))
+		RTFatal("%s: the element type must be a C_ integer or floating point type", where);
+
+	t->big = (big_endian != ATOM_0);
+	t->swap = (t->width > 1) && (t->big != host_big_endian());
+}
+
+static uint64_t load_bits(const unsigned char *p, struct array_type *t)
+/* the raw bits of one element */
+{
+	uint16_t b16;
+	uint32_t b32;
+	uint64_t b64;
+	int i;
+
+	if (t->swap) {
+		b64 = 0;
+		if (t->big) {
+			for (i = 0; i < t->width; i++) {
+				b64 = (b64 << 8) | p[i];
+			}
+		}
+		else {
+			for (i = t->width - 1; i >= 0; i--) {
+				b64 = (b64 << 8) | p[i];
+			}
+		}
+		return b64;
+	}
+	switch (t->width) {
+		case 1:
+			return *p;
+		case 2:
+			memcpy(&b16, p, 2);
+			return b16;
+		case 4:
+			memcpy(&b32, p, 4);
+			return b32;
+		default:
+			memcpy(&b64, p, 8);
+			return b64;
+	}
+}
+
+static void store_bits(unsigned char *p, uint64_t bits, struct array_type *t)
+{
+	uint16_t b16;
+	uint32_t b32;
+	int i;
+
+	if (t->swap) {
+		if (t->big) {
+			for (i = t->width - 1; i >= 0; i--) {
+				p[i] = (unsigned char)bits;
+				bits >>= 8;
+			}
+		}
+		else {
+			for (i = 0; i < t->width; i++) {
+				p[i] = (unsigned char)bits;
+				bits >>= 8;
+			}
+		}
+		return;
+	}
+	switch (t->width) {
+		case 1:
+			*p = (unsigned char)bits;
+			break;
+		case 2:
+			b16 = (uint16_t)bits;
+			memcpy(p, &b16, 2);
+			break;
+		case 4:
+			b32 = (uint32_t)bits;
+			memcpy(p, &b32, 4);
+			break;
+		default:
+			memcpy(p, &bits, 8);
+			break;
+	}
+}
+
+static int decode_native(object_ptr out, const unsigned char *p, intptr_t n, intptr_t stride, struct array_type *t)
+/* native order integers that always fit in a Euphoria integer, in tight
+   loops the compiler can vectorize. FALSE if t is not one of those */
+{
+	intptr_t i;
+
+	if (t->swap || t->kind == KIND_FLOAT)
+		return FALSE;
+	switch (t->width) {
+		case 1:
+			if (t->kind == KIND_SIGNED) {
+				for (i = 0; i < n; i++) {
+					out[i] = MAKE_INT((signed char)p[i * stride]);
+				}
+			}
+			else {
+				for (i = 0; i < n; i++) {
+					out[i] = MAKE_INT(p[i * stride]);
+				}
+			}
+			return TRUE;
+		case 2:
+			if (t->kind == KIND_SIGNED) {
+				int16_t s16;
+
+				for (i = 0; i < n; i++) {
+					memcpy(&s16, p + i * stride, 2);
+					out[i] = MAKE_INT(s16);
+				}
+			}
+			else {
+				uint16_t u16;
+
+				for (i = 0; i < n; i++) {
+					memcpy(&u16, p + i * stride, 2);
+					out[i] = MAKE_INT(u16);
+				}
+			}
+			return TRUE;
+#if INTPTR_MAX > INT32_MAX
+		case 4:
+			if (t->kind == KIND_SIGNED) {
+				int32_t s32;
+
+				for (i = 0; i < n; i++) {
+					memcpy(&s32, p + i * stride, 4);
+					out[i] = MAKE_INT(s32);
+				}
+			}
+			else {
+				uint32_t u32;
+
+				for (i = 0; i < n; i++) {
+					memcpy(&u32, p + i * stride, 4);
+					out[i] = MAKE_INT(u32);
+				}
+			}
+			return TRUE;
+#endif
+		default:
+			return FALSE;
+	}
+}
+
+static void decode_array(object_ptr out, const unsigned char *p, intptr_t n, intptr_t stride, struct array_type *t)
+/* n elements, stride bytes apart, from p into out[0..n-1] */
+{
+	uint64_t bits;
+	int64_t v;
+	uint32_t f32;
+	float f;
+	double d;
+	intptr_t i;
+
+	if (decode_native(out, p, n, stride, t))
+		return;
+	for (i = 0; i < n; i++, p += stride) {
+		bits = load_bits(p, t);
+		if (t->kind == KIND_FLOAT) {
+			if (t->width == 4) {
+				f32 = (uint32_t)bits;
+				memcpy(&f, &f32, 4);
+				d = f;
+			}
+			else {
+				memcpy(&d, &bits, 8);
+			}
+			out[i] = NewDouble((eudouble)d);
+			continue;
+		}
+		if (t->kind == KIND_SIGNED && t->width < 8) {
+			// sign extend
+			v = (int64_t)(bits << (64 - 8 * t->width)) >> (64 - 8 * t->width);
+		}
+		else if (t->kind == KIND_UNSIGNED && t->width == 8 && (int64_t)bits < 0) {
+			out[i] = NewDouble((eudouble)bits);
+			continue;
+		}
+		else {
+			v = (int64_t)bits;
+		}
+		if (v >= MININT && v <= MAXINT)
+			out[i] = MAKE_INT((intptr_t)v);
+		else
+			out[i] = NewDouble((eudouble)v);
+	}
+}
+
+static void encode_array(unsigned char *p, object_ptr in, intptr_t n, intptr_t stride, struct array_type *t, char *where)
+/* n elements from in[0..n-1] to p, stride bytes apart */
+{
+	uint64_t bits;
+	object x;
+	eudouble d;
+	double d64;
+	float f;
+	uint32_t f32;
+	intptr_t i;
+
+	for (i = 0; i < n; i++, p += stride) {
+		x = in[i];
+		if (IS_ATOM_INT(x))
+			d = (eudouble)INT_VAL(x);
+		else if (IS_ATOM_DBL(x))
+			d = DBL_PTR(x)->dbl;
+		else
+			RTFatal("%s: the values must be atoms", where);
+
+		if (t->kind == KIND_FLOAT) {
+			if (t->width == 4) {
+				f = (float)d;
+				memcpy(&f32, &f, 4);
+				bits = f32;
+			}
+			else {
+				d64 = (double)d;
+				memcpy(&bits, &d64, 8);
+			}
+		}
+		else if (IS_ATOM_INT(x)) {
+			bits = (uint64_t)(int64_t)INT_VAL(x);
+		}
+		else if (d < 0.0) {
+			bits = (uint64_t)(int64_t)d;
+		}
+		else {
+			// like poke4(), large values keep their low bits
+			bits = (d >= 18446744073709551616.0) ? (uint64_t)-1 : (uint64_t)d;
+		}
+		store_bits(p, bits, t);
+	}
+}
+
+static unsigned char byte_of(object x)
+{
+	if (IS_ATOM_INT(x))
+		return (unsigned char)INT_VAL(x);
+	if (IS_ATOM_DBL(x))
+		return (unsigned char)(intptr_t)DBL_PTR(x)->dbl;
+	RTFatal("bytes_to_array(): the bytes must be atoms");
+	return 0;
+}
+
+static intptr_t get_count(object n, char *where)
+/* a number of elements. negative means as many as there are */
+{
+	if (IS_ATOM_INT(n))
+		return (n < 0) ? -1 : INT_VAL(n);
+	if (IS_ATOM_DBL(n)) {
+		if (DBL_PTR(n)->dbl < 0.0)
+			return -1;
+		if (DBL_PTR(n)->dbl > (eudouble)MAXINT)
+			return MAXINT;
+		return (intptr_t)DBL_PTR(n)->dbl;
+	}
+	RTFatal("%s: the number of values must be an atom", where);
+	return 0;
+}
+
+object read_array(object x)
+/* x is {file number, type, n, big endian}. reads up to n values, or all
+   of the rest of the file if n is negative (M_READ_ARRAY) */
+{
+	s1_ptr args, result;
+	struct array_type t;
+	struct stat st;
+	IFILE f;
+	intptr_t n, cap, len, want, got, per_chunk;
+	size_t bytes;
+	off_t pos;
+
+	args = SEQ_PTR(x);
+	get_array_type(&t, args->base[2], args->base[4], "get_array()");
+	n = get_count(args->base[3], "get_array()");
+	if (n < 0)
+		n = MAXINT;
+	f = which_file(args->base[1], EF_READ);
+
+	// a plain file says how much is left
+	cap = ARRAY_CHUNK / t.width;
+	if (fstat(ifileno(f), &st) == 0 && (st.st_mode & S_IFMT) == S_IFREG) {
+		pos = (off_t)itell(f);
+		if (pos >= 0 && st.st_size >= pos && (uintptr_t)((st.st_size - pos) / t.width) < MAX_SEQ_LEN)
+			cap = (intptr_t)((st.st_size - pos) / t.width);
+	}
+	if (cap > n)
+		cap = n;
+
+	result = (s1_ptr)EMalloc((cap + 1) * sizeof(object) + sizeof(struct s1));
+	len = 0;
+	per_chunk = ARRAY_CHUNK / t.width;
+	while (len < n) {
+		if (len == cap) {
+			cap = (cap > n - cap) ? n : 2 * cap + per_chunk;
+			if (cap > n)
+				cap = n;
+			result = (s1_ptr)ERealloc((char *)result, (cap + 1) * sizeof(object) + sizeof(struct s1));
+		}
+		want = cap - len;
+		if (want > per_chunk)
+			want = per_chunk;
+		bytes = iread((char *)array_bytes, 1, want * t.width, f);
+		got = (intptr_t)(bytes / t.width);
+		decode_array((object_ptr)(result + 1) + len, array_bytes, got, t.width, &t);
+		len += got;
+		if (got < want) {
+			if (bytes % t.width != 0) {
+				// step back over a partial value at the end, so that it's
+				// left unread - unless f is a pipe, which can't go back
+				iseek(f, -(off_t)(bytes % t.width), SEEK_CUR);
+			}
+			break;
+		}
+	}
+	if (len < cap)
+		result = (s1_ptr)ERealloc((char *)result, (len + 1) * sizeof(object) + sizeof(struct s1));
+	return NewPreallocSeq(len + 1, result);
+}
+
+object write_array(object x)
+/* x is {file number, type, values, big endian}. writes the values,
+   returning how many were written (M_WRITE_ARRAY) */
+{
+	s1_ptr args, values;
+	struct array_type t;
+	IFILE f;
+	intptr_t done, want, put, per_chunk;
+
+	args = SEQ_PTR(x);
+	get_array_type(&t, args->base[2], args->base[4], "put_array()");
+	if (!IS_SEQUENCE(args->base[3]))
+		RTFatal("put_array(): the values must be a sequence");
+	values = SEQ_PTR(args->base[3]);
+	f = which_file(args->base[1], EF_WRITE);
+
+	per_chunk = ARRAY_CHUNK / t.width;
+	for (done = 0; done < values->length; done += put) {
+		want = values->length - done;
+		if (want > per_chunk)
+			want = per_chunk;
+		encode_array(array_bytes, values->base + 1 + done, want, t.width, &t, "put_array()");
+		put = (intptr_t)iwrite((char *)array_bytes, t.width, want, f);
+		if (put < want)
+			return MAKE_INT(done + put);
+	}
+	return MAKE_INT(done);
+}
+
+object decode_array_from(object x)
+/* x is {bytes, type, n, big endian}. returns up to n values (all of them
+   if n is negative) from a sequence of bytes (M_DECODE_ARRAY) */
+{
+	s1_ptr args, bytes, result;
+	struct array_type t;
+	intptr_t n, i, done, want;
+
+	args = SEQ_PTR(x);
+	get_array_type(&t, args->base[2], args->base[4], "bytes_to_array()");
+	n = get_count(args->base[3], "bytes_to_array()");
+	if (!IS_SEQUENCE(args->base[1]))
+		RTFatal("bytes_to_array(): the bytes must be a sequence");
+	bytes = SEQ_PTR(args->base[1]);
+	if (n < 0 || n > bytes->length / t.width)
+		n = bytes->length / t.width;
+
+	result = NewS1(n);
+	// through the byte buffer, a chunk at a time
+	for (done = 0; done < n; done += want) {
+		want = n - done;
+		if (want > ARRAY_CHUNK / t.width)
+			want = ARRAY_CHUNK / t.width;
+		for (i = 0; i < want * t.width; i++) {
+			array_bytes[i] = byte_of(bytes->base[1 + done * t.width + i]);
+		}
+		decode_array(result->base + 1 + done, array_bytes, want, t.width, &t);
+	}
+	return MAKE_SEQ(result);
+}
+
+object encode_array_to(object x)
+/* x is {type, values, big endian}. returns the values as a sequence
+   of bytes (M_ENCODE_ARRAY) */
+{
+	s1_ptr args, values, result;
+	struct array_type t;
+	object_ptr out;
+	intptr_t done, want, i, nbytes;
+
+	args = SEQ_PTR(x);
+	get_array_type(&t, args->base[1], args->base[3], "array_to_bytes()");
+	if (!IS_SEQUENCE(args->base[2]))
+		RTFatal("array_to_bytes(): the values must be a sequence");
+	values = SEQ_PTR(args->base[2]);
+
+	result = NewS1(values->length * t.width);
+	out = result->base + 1;
+	for (done = 0; done < values->length; done += want) {
+		want = values->length - done;
+		if (want > ARRAY_CHUNK / t.width)
+			want = ARRAY_CHUNK / t.width;
+		encode_array(array_bytes, values->base + 1 + done, want, t.width, &t, "array_to_bytes()");
+		nbytes = want * t.width;
+		for (i = 0; i < nbytes; i++) {
+			*out++ = (object)array_bytes[i];
+		}
+	}
+	return MAKE_SEQ(result);
+}
+
+static unsigned char *get_address(object a, char *where)
+{
+	if (IS_ATOM_INT(a))
+		return (unsigned char *)(uintptr_t)INT_VAL(a);
+	if (IS_ATOM_DBL(a))
+		return (unsigned char *)(uintptr_t)DBL_PTR(a)->dbl;
+	RTFatal("%s: the addresses must be atoms", where);
+	return NULL;
+}
+
+static intptr_t get_stride(object x, char *where)
+{
+	if (IS_ATOM_INT(x))
+		return INT_VAL(x);
+	if (IS_ATOM_DBL(x) && DBL_PTR(x)->dbl >= (eudouble)MININT && DBL_PTR(x)->dbl <= (eudouble)MAXINT)
+		return (intptr_t)DBL_PTR(x)->dbl;
+	RTFatal("%s: the stride must be an integer", where);
+	return 0;
+}
+
+static object native_order()
+{
+	return host_big_endian() ? ATOM_1 : ATOM_0;
+}
+
+object peek_gather(object x)
+/* x is {addresses, type}. returns the value at each address (M_PEEK_GATHER) */
+{
+	s1_ptr args, addrs, result;
+	struct array_type t;
+	intptr_t i;
+
+	args = SEQ_PTR(x);
+	get_array_type(&t, args->base[2], native_order(), "peek_gather()");
+	if (!IS_SEQUENCE(args->base[1]))
+		RTFatal("peek_gather(): the addresses must be a sequence");
+	addrs = SEQ_PTR(args->base[1]);
+
+	result = NewS1(addrs->length);
+	for (i = 1; i <= addrs->length; i++) {
+		decode_array(result->base + i, get_address(addrs->base[i], "peek_gather()"), 1, t.width, &t);
+	}
+	return MAKE_SEQ(result);
+}
+
+object peek_strided(object x)
+/* x is {base, stride, count, type}. returns count values starting at
+   base, stride bytes apart (M_PEEK_STRIDED) */
+{
+	s1_ptr args, result;
+	struct array_type t;
+	unsigned char *base;
+	intptr_t stride, n;
+
+	args = SEQ_PTR(x);
+	get_array_type(&t, args->base[4], native_order(), "peek_strided()");
+	base = get_address(args->base[1], "peek_strided()");
+	stride = get_stride(args->base[2], "peek_strided()");
+	n = get_count(args->base[3], "peek_strided()");
+	if (n < 0)
+		RTFatal("peek_strided(): the count must not be negative");
+
+	result = NewS1(n);
+	decode_array(result->base + 1, base, n, stride, &t);
+	return MAKE_SEQ(result);
+}
+
+object poke_scatter(object x)
+/* x is {addresses, type, values}. stores each value at its
+   address (M_POKE_SCATTER) */
+{
+	s1_ptr args, addrs, values;
+	struct array_type t;
+	intptr_t i;
+
+	args = SEQ_PTR(x);
+	get_array_type(&t, args->base[2], native_order(), "poke_scatter()");
+	if (!IS_SEQUENCE(args->base[1]) || !IS_SEQUENCE(args->base[3]))
+		RTFatal("poke_scatter(): the addresses and the values must be sequences");
+	addrs = SEQ_PTR(args->base[1]);
+	values = SEQ_PTR(args->base[3]);
+	if (addrs->length != values->length)
+		RTFatal("poke_scatter(): there must be one value for each address");
+
+	for (i = 1; i <= addrs->length; i++) {
+		encode_array(get_address(addrs->base[i], "poke_scatter()"), values->base + i, 1, t.width, &t, "poke_scatter()");
+	}
+	return ATOM_1;
+}
+
+object poke_strided(object x)
+/* x is {base, stride, type, values}. stores the values starting at base,
+   stride bytes apart (M_POKE_STRIDED) */
+{
+	s1_ptr args, values;
+	struct array_type t;
+	unsigned char *base;
+	intptr_t stride;
+
+	args = SEQ_PTR(x);
+	get_array_type(&t, args->base[3], native_order(), "poke_strided()");
+	base = get_address(args->base[1], "poke_strided()");
+	stride = get_stride(args->base[2], "poke_strided()");
+	if (!IS_SEQUENCE(args->base[4]))
+		RTFatal("poke_strided(): the values must be a sequence");
+	values = SEQ_PTR(args->base[4]);
+
+	encode_array(base, values->base + 1, values->length, stride, &t, "poke_strided()");
+	return ATOM_1;
+}
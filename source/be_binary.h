@@ -0,0 +1,15 @@
+#ifndef BE_BINARY_H_
+#define BE_BINARY_H_
+
+#include "execute.h"
+
+object read_array(object x);
+object write_array(object x);
+object decode_array_from(object x);
+object encode_array_to(object x);
+object peek_gather(object x);
+object peek_strided(object x);
+object poke_scatter(object x);
+object poke_strided(object x);
+
+#endif
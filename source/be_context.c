@@ -0,0 +1,99 @@
+/*****************************************************************************/
+/*      (c) Copyright - See License.txt       */
+/*****************************************************************************/
+/*                                                                           */
+/*                            Runtime Contexts                               */
+/*                                                                           */
+/*****************************************************************************/
+
+/* An application whose C code uses the runtime on several threads creates
+   a context for each thread with eu_context_new() and calls
+   eu_context_enter() on that thread before using it.  Each context gets a
+   storage cache of its own; a call stack, routine table and tasks are set
+   up in whatever context is current when they are created.  Not all of
+   the runtime's state is in a context yet (be_context.h), so this does not
+   let two Euphoria programs run at once.
+
+   Without EREENTRANT there is only the main context, and the calls below
+   that would switch to another one fail. */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alldefs.h"
+#include "be_alloc.h"
+#include "be_runtime.h"
+#include "be_execute.h"
+#include "be_task.h"
+#include "be_context.h"
+
+struct eu_context eu_main_context;
+
+#ifdef EREENTRANT
+EU_THREAD_LOCAL struct eu_context *eu_current_context = &eu_main_context;
+#endif
+
+struct eu_context *eu_context_new()
+/* a new, empty runtime context, or NULL if there isn't enough memory or
+   the runtime wasn't built with EREENTRANT */
+{
+#ifdef EREENTRANT
+	struct eu_context *ctx, *old;
+
+	// not from the current context's storage cache: the new context may
+	// well outlive it
+	ctx = (struct eu_context *)calloc(1, sizeof(struct eu_context));
+	if (ctx == NULL)
+		return NULL;
+
+	old = eu_current_context;
+	eu_current_context = ctx;
+	InitStorageCache();
+	eu_current_context = old;
+	return ctx;
+#else
+	return NULL;
+#endif
+}
+
+void eu_context_free(struct eu_context *ctx)
+/* release a context made by eu_context_new(), along with everything it
+   allocated.  It must not be in use on any thread */
+{
+#ifdef EREENTRANT
+	struct eu_context *old;
+
+	if (ctx == NULL || ctx == &eu_main_context)
+		return;
+
+	old = eu_current_context;
+	eu_current_context = ctx;
+	FreeTasks();
+#ifndef ERUNTIME
+	FreeStack(expr_segment);
+#endif
+	FreeRuntimeBuffers();
+	FreeStorageCache();
+	eu_current_context = (old == ctx) ? &eu_main_context : old;
+	free(ctx);
+#endif
+}
+
+void eu_context_enter(struct eu_context *ctx)
+/* make ctx the current context of the calling thread.
+   NULL means the main context */
+{
+#ifdef EREENTRANT
+	eu_current_context = (ctx == NULL) ? &eu_main_context : ctx;
+#else
+	if (ctx != NULL && ctx != &eu_main_context)
+		RTFatal("eu_context_enter: the runtime was built without EREENTRANT");
+#endif
+}
+
+struct eu_context *eu_context_current()
+/* the calling thread's current context */
+{
+	return EU_CONTEXT;
+}
@@ -0,0 +1,210 @@
+#ifndef BE_CONTEXT_H_
+#define BE_CONTEXT_H_
+
+/* The state of one instance of the runtime: its storage cache, the
+   interpreter's call stack and program, the routine table and the task
+   scheduler.  Normally there is just one, eu_main_context, and the names
+   below refer straight to its fields, so using them costs no more than
+   using plain globals did.
+
+   When the backend is built with EREENTRANT, each thread has a current
+   context instead, set with eu_context_enter(), and an application can
+   create as many contexts as it likes with eu_context_new() and use each
+   one on a different thread.  A context must only be used by one thread
+   at a time, and objects must not be passed from one context to another
+   except through a channel (be_task.h), as each has its own storage cache
+   and reference counts aren't locked.
+
+   Only what is below is kept per context.  The rest of the runtime's
+   state (TopLevelSub, TempBuff, the call_back() arguments, the last file
+   read, TraceOn, gameover, ...) and a translated program's variables are
+   still process globals, so two contexts can't run two Euphoria programs
+   at the same time: C code on several threads can allocate, convert and
+   schedule tasks in contexts of their own, and pass objects between them
+   through channels.
+
+   The code that uses this state refers to it by the old global names
+   (tpc, expr_top, tcb, d_list, ...), which are defined as macros at the
+   end of this file.  A header that declares a struct member or a local
+   variable with one of these names will not compile. */
+
+#include "be_alloc.h"
+
+#ifdef EREENTRANT
+#if defined(_MSC_VER) || defined(__WATCOMC__)
+#define EU_THREAD_LOCAL __declspec(thread)
+#else
+#define EU_THREAD_LOCAL __thread
+#endif
+#endif
+
+#define NUMBER_OF_FBL 14        /* number of lists in free block set */
+#define OUTPUT_CHUNK 16384      /* bytes converted at a time for a file */
+#define ARRAY_CHUNK 65536       /* bytes of a binary array converted at a time */
+#define FORMAT_CACHE_SIZE 32    /* compiled formats kept; a power of 2 */
+
+struct format_program;
+struct handle_slot;
+struct handle_table {           /* checked handles (be_task.c) */
+	struct handle_slot *slot;   // from malloc(), as tables can be shared
+	int size;
+	int used;                   // slots that have ever been handed out
+	int free_first;             // 1 + the first free slot, or 0
+};
+struct format_slot {
+	s1_ptr seen;                  // last format to miss this slot
+	s1_ptr rejected;              // last format that could not be compiled
+	struct format_program *prog;
+};
+
+struct tcb_entry;
+struct task_context;
+struct io_waiter;
+struct stack_segment;
+
+struct eu_context {
+	/* be_alloc.c: storage cache */
+	d_ptr d_list;             // free blocks for doubles
+	struct free_block *dbl_blocks; // the blocks that doubles are carved from
+	struct block_list *pool_map[MAX_CACHED_SIZE/RESOLUTION+1];
+	struct block_list freeblk_list[NUMBER_OF_FBL];
+	unsigned cache_size;
+	int low_on_space;         // are we almost out of memory?
+
+	/* be_execute.c: the interpreter */
+	intptr_t *tpc;            // Euphoria program counter needed for traceback
+	object_ptr expr_stack;    // runtime call stack (its current segment)
+	struct stack_segment *expr_segment; // the segment expr_stack is in
+	object_ptr expr_max;      // top limit of call stack
+	object_ptr expr_limit;    // don't start a new routine above this
+	object_ptr expr_top;      // expression stack pointer
+	int stack_size;           // current size of call stack
+	struct IL fe;
+	struct sline *slist;
+
+	/* be_symtab.c: routine table */
+	symtab_ptr *e_routine;    // array of symbol table pointers
+	cleanup_ptr *e_cleanup;   // array of cleanup_ptr pointers
+	int e_routine_next;       // index of next available element
+	int e_routine_size;       // number of symbol table pointers allocated
+
+	/* be_task.c: the task scheduler */
+	struct tcb_entry *tcb;
+	int tcb_size;
+	int tcb_alloc;            // number of tcb entries allocated
+	int current_task;
+	int clock_stopped;
+	double save_clock;
+	int id_wrap;              // have task id's wrapped around? (very rare)
+	double next_task_id;
+	int *rt_heap;             // binary min-heap of real-time tasks
+	int rt_count;
+	int rt_heap_size;
+	int ready_first, ready_last;  // time-share queues
+	int spent_first, spent_last;
+	int dead_first;           // ST_DEAD tasks whose entries can be recycled
+	int earliest_task;
+	int *tid_table;           // external task id -> internal task number
+	int tid_table_size;
+	struct io_waiter *io_waiters;
+	int io_waiting;
+	int io_waiters_size;
+	int epoll_fd;
+	struct task_context *main_context;  // task 0's stack, for coroutines
+	struct task_context *free_contexts; // stacks of ended tasks, for reuse
+	int free_context_count;
+	void *stale_task;         // an ended task to release once it's left
+	void *sched_trace;        // FILE * that task_trace() writes to
+	double sched_trace_origin; // when the trace began
+	int sched_trace_count;    // number of events in it so far
+	double wait_spin;         // how long before a wake-up Wait() stops sleeping
+	struct handle_table sync_handles; // semaphores and events
+
+	/* be_runtime.c, be_binary.c: I/O scratch space and the format cache */
+	char *line_buf;           // holds the bytes of the line being read
+	size_t line_buf_size;
+	char *io_buffer;          // a whole sequence's bytes, for one write
+	intptr_t io_buffer_size;
+	char output_bytes[OUTPUT_CHUNK];
+	unsigned char array_bytes[ARRAY_CHUNK];
+	struct format_slot format_cache[FORMAT_CACHE_SIZE];
+};
+
+extern struct eu_context eu_main_context;
+
+#ifdef EREENTRANT
+extern EU_THREAD_LOCAL struct eu_context *eu_current_context;
+#define EU_CONTEXT (eu_current_context)
+#else
+#define EU_CONTEXT (&eu_main_context)
+#endif
+
+struct eu_context *eu_context_new();
+void eu_context_free(struct eu_context *ctx);
+void eu_context_enter(struct eu_context *ctx);
+struct eu_context *eu_context_current();
+
+#define d_list             (EU_CONTEXT->d_list)
+#define dbl_blocks         (EU_CONTEXT->dbl_blocks)
+#define pool_map           (EU_CONTEXT->pool_map)
+#define freeblk_list       (EU_CONTEXT->freeblk_list)
+#define cache_size         (EU_CONTEXT->cache_size)
+#define low_on_space       (EU_CONTEXT->low_on_space)
+
+#define tpc                (EU_CONTEXT->tpc)
+#define expr_stack         (EU_CONTEXT->expr_stack)
+#define expr_segment       (EU_CONTEXT->expr_segment)
+#define expr_max           (EU_CONTEXT->expr_max)
+#define expr_limit         (EU_CONTEXT->expr_limit)
+#define expr_top           (EU_CONTEXT->expr_top)
+#define stack_size         (EU_CONTEXT->stack_size)
+#define fe                 (EU_CONTEXT->fe)
+#define slist              (EU_CONTEXT->slist)
+
+#define e_routine          (EU_CONTEXT->e_routine)
+#define e_cleanup          (EU_CONTEXT->e_cleanup)
+#define e_routine_next     (EU_CONTEXT->e_routine_next)
+#define e_routine_size     (EU_CONTEXT->e_routine_size)
+
+#define tcb                (EU_CONTEXT->tcb)
+#define tcb_size           (EU_CONTEXT->tcb_size)
+#define tcb_alloc          (EU_CONTEXT->tcb_alloc)
+#define current_task       (EU_CONTEXT->current_task)
+#define clock_stopped      (EU_CONTEXT->clock_stopped)
+#define save_clock         (EU_CONTEXT->save_clock)
+#define id_wrap            (EU_CONTEXT->id_wrap)
+#define next_task_id       (EU_CONTEXT->next_task_id)
+#define rt_heap            (EU_CONTEXT->rt_heap)
+#define rt_count           (EU_CONTEXT->rt_count)
+#define rt_heap_size       (EU_CONTEXT->rt_heap_size)
+#define ready_first        (EU_CONTEXT->ready_first)
+#define ready_last         (EU_CONTEXT->ready_last)
+#define spent_first        (EU_CONTEXT->spent_first)
+#define spent_last         (EU_CONTEXT->spent_last)
+#define dead_first         (EU_CONTEXT->dead_first)
+#define earliest_task      (EU_CONTEXT->earliest_task)
+#define tid_table          (EU_CONTEXT->tid_table)
+#define tid_table_size     (EU_CONTEXT->tid_table_size)
+#define io_waiters         (EU_CONTEXT->io_waiters)
+#define io_waiting         (EU_CONTEXT->io_waiting)
+#define io_waiters_size    (EU_CONTEXT->io_waiters_size)
+#define epoll_fd           (EU_CONTEXT->epoll_fd)
+#define main_context       (EU_CONTEXT->main_context)
+#define free_contexts      (EU_CONTEXT->free_contexts)
+#define free_context_count (EU_CONTEXT->free_context_count)
+#define stale_task         (EU_CONTEXT->stale_task)
+#define sched_trace        (EU_CONTEXT->sched_trace)
+#define sched_trace_origin (EU_CONTEXT->sched_trace_origin)
+#define sched_trace_count  (EU_CONTEXT->sched_trace_count)
+#define wait_spin          (EU_CONTEXT->wait_spin)
+#define sync_handles       (EU_CONTEXT->sync_handles)
+
+#define line_buf           (EU_CONTEXT->line_buf)
+#define line_buf_size      (EU_CONTEXT->line_buf_size)
+#define io_buffer          (EU_CONTEXT->io_buffer)
+#define io_buffer_size     (EU_CONTEXT->io_buffer_size)
+#define output_bytes       (EU_CONTEXT->output_bytes)
+#define array_bytes        (EU_CONTEXT->array_bytes)
+#define format_cache       (EU_CONTEXT->format_cache)
+
+#endif
@@ -69,7 +69,7 @@ void ExternalUpdateGlobals(){
 }
 
 void ExternalDebugScreen(){
-	current_stack_depth = expr_top - expr_stack;
+	current_stack_depth = (int)StackDepth();
 	((void (*)())UserDebugScreen)();
 }
 
@@ -289,12 +289,14 @@ int add_to_call_stack( object_ptr stack_seq_ptr, intptr_t *pc, int debugger ){
 // Return the current call stack
 object eu_call_stack( int debugger ){
 	object_ptr stack_top, stack;
+	struct stack_segment *segment;
 	intptr_t *new_pc;
 	s1_ptr stack_s1;
 	object stack_seq;
 	
 	stack_top = expr_top;
 	stack     = expr_stack;
+	segment   = expr_segment;
 	
 	stack_s1 = NewS1(0);
 	stack_seq = MAKE_SEQ( stack_s1 );
@@ -306,6 +308,12 @@ object eu_call_stack( int debugger ){
 	
 	stack_top -= 2;
 	while (stack_top >= stack) {
+		if (stack_top < stack + 3 && segment->prev != NULL) {
+			// the same frame is on top of the segment below
+			stack_top = segment->prev_top - (stack + 3 - stack_top);
+			segment = segment->prev;
+			stack = segment->slots;
+		}
 		// unwind the stack for this task
 		new_pc = (intptr_t *)*stack_top;
 		stack_top -= 2;
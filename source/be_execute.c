@@ -242,11 +242,6 @@ void INT_Handler(int);
 /**********************/
 /* Exported variables */
 /**********************/
-object_ptr expr_stack;  // runtime call stack
-object_ptr expr_max;    // top limit of call stack
-object_ptr expr_limit;  // don't start a new routine above this
-int stack_size;         // current size of call stack
-object_ptr expr_top;    // expression stack pointer
 int SymTabLen;          // avoid > 3 args
 int start_line;         // line number set by STARTLINE
 int TraceBeyond;        // continue tracing after this line
@@ -254,8 +249,9 @@ int TraceStack;         // stack level when down-arrow was pressed
 int Executing = FALSE;  // TRUE if user program is executing
 int ProfileOn;          // TRUE if profile/profile_time is turned on
 
-/* Euphoria program counter needed for traceback */
-intptr_t *tpc;
+/* tpc, the Euphoria program counter needed for traceback, the call stack
+   (expr_stack ...), fe and slist belong to the runtime context - see
+   be_context.h */
 
 /*******************/
 /* Local variables */
@@ -883,17 +879,114 @@ static int recover_lhs_subscript(object subscript, s1_ptr s)
 }
 
 
+static struct stack_segment *NewStackSegment(int size)
+{
+	struct stack_segment *seg;
+
+	seg = (struct stack_segment *)EMalloc(sizeof(struct stack_segment) +
+										  (size - 1) * sizeof(object));
+	seg->spare = NULL;
+	seg->size = size;
+	return seg;
+}
+
+void EnterStackSegment(struct stack_segment *seg)
+// make seg the current segment of the call stack
+{
+	expr_segment = seg;
+	expr_stack = seg->slots;
+	stack_size = seg->size;
+
+	/* must allow for a few extra words */
+	expr_max = expr_stack + (stack_size - 5);
+	expr_limit = expr_max - 3; // we only push two items per call
+}
+
 void InitStack(int size, int toplevel)
 // called to create the initial call stack for a task
 {
-	stack_size = size;
-	expr_stack = (object_ptr) EMalloc(stack_size * sizeof(object));
+	struct stack_segment *seg;
+
+	seg = NewStackSegment(size);
+	seg->prev = NULL;
+	seg->prev_top = NULL;
+	seg->depth = 0;
+	EnterStackSegment(seg);
 	expr_stack[toplevel] = (object)TopLevelSub;
 	expr_top = &expr_stack[toplevel+1];  /* next available place on expr stack */
+}
 
-	/* must allow for a few extra words */
-	expr_max = expr_stack + (stack_size - 5);
-	expr_limit = expr_max - 3; // we only push two items per call
+object_ptr BiggerStack()
+/* continue the runtime call stack in a new segment, without moving
+   what is on it already */
+{
+	struct stack_segment *seg;
+	int size;
+
+	seg = expr_segment->spare;
+	if (seg == NULL) {
+		size = stack_size + stack_size + max_stack_per_call;
+		if (size > EXPR_SEGMENT_MAX)
+			size = EXPR_SEGMENT_MAX;
+		seg = NewStackSegment(size);
+		seg->prev = expr_segment;
+	}
+	expr_segment->spare = NULL;
+	seg->prev_top = expr_top;
+	seg->depth = expr_segment->depth + (expr_top - expr_stack) - 3;
+
+	// copy the frame on top, so it's under the next one
+	seg->slots[1] = expr_top[-2];
+	seg->slots[2] = expr_top[-1];
+	EnterStackSegment(seg);
+	expr_top = expr_stack + 3;
+	return expr_max;
+}
+
+int PopStackSegment()
+/* called when the frame at the bottom of the current segment is the only
+   one left in it. Goes back to the segment below, where the same frame is
+   on top, and returns TRUE, or returns FALSE if there isn't one */
+{
+	struct stack_segment *seg, *prev;
+
+	seg = expr_segment;
+	prev = seg->prev;
+	if (prev == NULL)
+		return FALSE;
+
+	// keep this segment in case the stack grows again, but only this one
+	if (seg->spare != NULL) {
+		EFree((char *)seg->spare);
+		seg->spare = NULL;
+	}
+	prev->spare = seg;
+
+	EnterStackSegment(prev);
+	expr_top = seg->prev_top;
+	return TRUE;
+}
+
+void FreeStack(struct stack_segment *seg)
+/* release a call stack, given any of its segments */
+{
+	struct stack_segment *prev;
+
+	if (seg == NULL)
+		return;
+	while (seg->spare != NULL)
+		seg = seg->spare;
+	while (seg != NULL) {
+		prev = seg->prev;
+		EFree((char *)seg);
+		seg = prev;
+	}
+}
+
+intptr_t StackDepth()
+/* the number of words on the whole call stack */
+{
+	return expr_segment->depth + (expr_top - expr_stack);
 }
 
 
@@ -949,7 +1042,6 @@ extern intptr_t ** jumptab;
 
 
 /* IL data passed from the front end */
-struct IL fe;
 
 #define SET_OPERAND(word) ((intptr_t *)(((word) == 0) ? 0 : (&fe.st[(intptr_t)(word)])))
 
@@ -1613,7 +1705,6 @@ void analyze_switch()
 	}
 }
 
-struct sline *slist;
 
 /* Front-end variables passed via miscellaneous fe.misc */
 char **file_name;
@@ -4008,7 +4099,7 @@ void do_exec(intptr_t *start_pc)
 
 				tpc = pc;
 
-				if (expr_top > expr_stack+3) {
+				if (expr_top > expr_stack+3 || PopStackSegment()) {
 					// stack is not empty
 					pc = (intptr_t *)expr_top[-2];
 					expr_top -= 2;
@@ -5244,7 +5335,7 @@ void do_exec(intptr_t *start_pc)
 					}
 					else {
 						/* stop after down-arrow pressed */
-						i = expr_top - expr_stack;
+						i = (int)StackDepth();
 						b = (top > TraceBeyond && i == TraceStack) ||
 							i < TraceStack;
 					}
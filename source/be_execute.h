@@ -6,11 +6,6 @@
 /**********************/
 /* Exported variables */
 /**********************/
-extern object_ptr expr_stack;  // runtime call stack
-extern object_ptr expr_max;    // top limit of call stack
-extern object_ptr expr_limit;  // don't start a new routine above this
-extern int stack_size;         // current size of call stack
-extern object_ptr expr_top;    // expression stack pointer
 extern int SymTabLen;          // avoid > 3 args
 extern int start_line;         // line number set by STARTLINE
 extern int TraceBeyond;        // continue tracing after this line
@@ -23,15 +18,9 @@ extern int AnyTimeProfile;
 extern int AnyStatementProfile;
 extern int sample_size;
 
-extern struct sline *slist;
-extern struct IL fe;
-
 extern int gline_number;  /* last global line number in program */
 extern int il_file;       /* we are processing a separate .il file */
 
-/* Euphoria program counter needed for traceback */
-extern intptr_t *tpc;
-
 #ifndef INT_CODES
 #if defined(EUNIX) || defined(EMINGW) || defined(EWATCOM)
 extern intptr_t **jumptab; // initialized in do_exec() 
@@ -45,10 +34,30 @@ extern intptr_t **jumptab; // initialized in do_exec()
 #endif // not GNU-C
 #endif //not INT_CODES
 
+/* The call stack is a chain of segments.  expr_stack is the slots of the
+   current one, expr_segment.  A new segment begins with a copy of the frame
+   that was on top of the one below, at slots[1] and slots[2], so the
+   interpreter always finds the caller's frame under the top one.  When that
+   copied frame is all that is left, PopStackSegment() goes back to the
+   segment below. */
+struct stack_segment {
+	struct stack_segment *prev;  // the segment below, or NULL
+	struct stack_segment *spare; // an empty segment above, kept for reuse
+	object_ptr prev_top;         // expr_top in prev when this one was begun
+	intptr_t depth;              // depth of slots[0] in the whole stack
+	int size;                    // number of slots
+	object slots[1];
+};
+
 void do_exec(intptr_t *start_pc);
 void fe_set_pointers( void );
 void Execute(intptr_t *start_index);
 void InitStack(int size, int toplevel);
+void EnterStackSegment(struct stack_segment *seg);
+object_ptr BiggerStack();
+int PopStackSegment();
+void FreeStack(struct stack_segment *seg);
+intptr_t StackDepth();
 void InitExecute( void );
 
 extern int map_new;
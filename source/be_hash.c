@@ -0,0 +1,1006 @@
+/*****************************************************************************/
+/*      (c) Copyright - See License.txt       */
+/*****************************************************************************/
+/*                                                                           */
+/*                         Incremental Hashing                               */
+/*                                                                           */
+/*****************************************************************************/
+
+/* hash() needs the whole object in memory. The routines here keep the
+   state of a hash calculation in a handle instead, so that a large file
+   can be hashed a chunk at a time.  The handle is a Euphoria atom whose
+   cleanup record holds the state, so it is freed along with the atom.
+
+   CRC32C and xxHash64 are also implemented here, both for the handles
+   and for hash(), which feeds them whole objects through hash_object().
+   CRC32C uses the SSE4.2 crc32 instruction when the processor has it. */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HASH_SSE42
+#include <cpuid.h>
+#endif
+
+#include "alldefs.h"
+#include "be_alloc.h"
+#include "be_runtime.h"
+#include "be_machine.h"
+#include "be_hash.h"
+
+/* same codes as the second argument of hash() */
+#define HASH_SHA256     -1
+#define HASH_MD5        -2
+#define HASH_FLETCHER32 -3
+#define HASH_ADLER32    -4
+#define HASH_HSIEH32    -5
+#define HASH_HSIEH30    -6
+#define HASH_CRC32C     -7
+#define HASH_XXHASH64   -8
+
+#define HASH_CHUNK 4096  // bytes converted from a sequence at a time
+
+struct hash_handle {
+	struct cleanup cleanup;  // must be first - freed by cleanup_double()
+	int algo;
+	union {
+		struct md5_context md5;
+		struct sha256_context sha256;
+		struct {
+			uint32_t a, b;
+		} adler;
+		struct {
+			uint32_t a, b;
+			int pending;     // first byte of an incomplete pair, or -1
+		} fletcher;
+		struct {
+			uint32_t hash;
+			int nbuf;        // bytes waiting for a complete 4-byte block
+			char buf[4];
+		} hsieh;
+		struct {
+			uint32_t crc;
+		} crc32c;
+		struct {
+			uint64_t v[4];
+			uint64_t count;  // number of bytes hashed so far
+			int nbuf;        // bytes waiting for a complete 32-byte stripe
+			unsigned char buf[32];
+		} xxh64;
+	} ctx;
+};
+
+/*******/
+/* MD5 */
+/*******/
+
+#define MD5_F(x, y, z) (((x) & (y)) | (~(x) & (z)))
+#define MD5_G(x, y, z) (((x) & (z)) | ((y) & ~(z)))
+#define MD5_H(x, y, z) ((x) ^ (y) ^ (z))
+#define MD5_I(x, y, z) ((y) ^ ((x) | ~(z)))
+#define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define MD5_STEP(f, a, b, c, d, x, t, s) \
+	(a) += f((b), (c), (d)) + (x) + (t); \
+	(a) = ROTL32((a), (s)) + (b);
+
+static void md5_transform(uint32_t state[4], const unsigned char block[64])
+{
+	uint32_t a, b, c, d, x[16];
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		x[i] = (uint32_t)block[i*4] | ((uint32_t)block[i*4+1] << 8) |
+			   ((uint32_t)block[i*4+2] << 16) | ((uint32_t)block[i*4+3] << 24);
+	}
+	a = state[0];
+	b = state[1];
+	c = state[2];
+	d = state[3];
+
+	MD5_STEP(MD5_F, a, b, c, d, x[ 0], 0xd76aa478,  7)
+	MD5_STEP(MD5_F, d, a, b, c, x[ 1], 0xe8c7b756, 12)
+	MD5_STEP(MD5_F, c, d, a, b, x[ 2], 0x242070db, 17)
+	MD5_STEP(MD5_F, b, c, d, a, x[ 3], 0xc1bdceee, 22)
+	MD5_STEP(MD5_F, a, b, c, d, x[ 4], 0xf57c0faf,  7)
+	MD5_STEP(MD5_F, d, a, b, c, x[ 5], 0x4787c62a, 12)
+	MD5_STEP(MD5_F, c, d, a, b, x[ 6], 0xa8304613, 17)
+	MD5_STEP(MD5_F, b, c, d, a, x[ 7], 0xfd469501, 22)
+	MD5_STEP(MD5_F, a, b, c, d, x[ 8], 0x698098d8,  7)
+	MD5_STEP(MD5_F, d, a, b, c, x[ 9], 0x8b44f7af, 12)
+	MD5_STEP(MD5_F, c, d, a, b, x[10], 0xffff5bb1, 17)
+	MD5_STEP(MD5_F, b, c, d, a, x[11], 0x895cd7be, 22)
+	MD5_STEP(MD5_F, a, b, c, d, x[12], 0x6b901122,  7)
+	MD5_STEP(MD5_F, d, a, b, c, x[13], 0xfd987193, 12)
+	MD5_STEP(MD5_F, c, d, a, b, x[14], 0xa679438e, 17)
+	MD5_STEP(MD5_F, b, c, d, a, x[15], 0x49b40821, 22)
+
+	MD5_STEP(MD5_G, a, b, c, d, x[ 1], 0xf61e2562,  5)
+	MD5_STEP(MD5_G, d, a, b, c, x[ 6], 0xc040b340,  9)
+	MD5_STEP(MD5_G, c, d, a, b, x[11], 0x265e5a51, 14)
+	MD5_STEP(MD5_G, b, c, d, a, x[ 0], 0xe9b6c7aa, 20)
+	MD5_STEP(MD5_G, a, b, c, d, x[ 5], 0xd62f105d,  5)
+	MD5_STEP(MD5_G, d, a, b, c, x[10], 0x02441453,  9)
+	MD5_STEP(MD5_G, c, d, a, b, x[15], 0xd8a1e681, 14)
+	MD5_STEP(MD5_G, b, c, d, a, x[ 4], 0xe7d3fbc8, 20)
+	MD5_STEP(MD5_G, a, b, c, d, x[ 9], 0x21e1cde6,  5)
+	MD5_STEP(MD5_G, d, a, b, c, x[14], 0xc33707d6,  9)
+	MD5_STEP(MD5_G, c, d, a, b, x[ 3], 0xf4d50d87, 14)
+	MD5_STEP(MD5_G, b, c, d, a, x[ 8], 0x455a14ed, 20)
+	MD5_STEP(MD5_G, a, b, c, d, x[13], 0xa9e3e905,  5)
+	MD5_STEP(MD5_G, d, a, b, c, x[ 2], 0xfcefa3f8,  9)
+	MD5_STEP(MD5_G, c, d, a, b, x[ 7], 0x676f02d9, 14)
+	MD5_STEP(MD5_G, b, c, d, a, x[12], 0x8d2a4c8a, 20)
+
+	MD5_STEP(MD5_H, a, b, c, d, x[ 5], 0xfffa3942,  4)
+	MD5_STEP(MD5_H, d, a, b, c, x[ 8], 0x8771f681, 11)
+	MD5_STEP(MD5_H, c, d, a, b, x[11], 0x6d9d6122, 16)
+	MD5_STEP(MD5_H, b, c, d, a, x[14], 0xfde5380c, 23)
+	MD5_STEP(MD5_H, a, b, c, d, x[ 1], 0xa4beea44,  4)
+	MD5_STEP(MD5_H, d, a, b, c, x[ 4], 0x4bdecfa9, 11)
+	MD5_STEP(MD5_H, c, d, a, b, x[ 7], 0xf6bb4b60, 16)
+	MD5_STEP(MD5_H, b, c, d, a, x[10], 0xbebfbc70, 23)
+	MD5_STEP(MD5_H, a, b, c, d, x[13], 0x289b7ec6,  4)
+	MD5_STEP(MD5_H, d, a, b, c, x[ 0], 0xeaa127fa, 11)
+	MD5_STEP(MD5_H, c, d, a, b, x[ 3], 0xd4ef3085, 16)
+	MD5_STEP(MD5_H, b, c, d, a, x[ 6], 0x04881d05, 23)
+	MD5_STEP(MD5_H, a, b, c, d, x[ 9], 0xd9d4d039,  4)
+	MD5_STEP(MD5_H, d, a, b, c, x[12], 0xe6db99e5, 11)
+	MD5_STEP(MD5_H, c, d, a, b, x[15], 0x1fa27cf8, 16)
+	MD5_STEP(MD5_H, b, c, d, a, x[ 2], 0xc4ac5665, 23)
+
+	MD5_STEP(MD5_I, a, b, c, d, x[ 0], 0xf4292244,  6)
+	MD5_STEP(MD5_I, d, a, b, c, x[ 7], 0x432aff97, 10)
+	MD5_STEP(MD5_I, c, d, a, b, x[14], 0xab9423a7, 15)
+	MD5_STEP(MD5_I, b, c, d, a, x[ 5], 0xfc93a039, 21)
+	MD5_STEP(MD5_I, a, b, c, d, x[12], 0x655b59c3,  6)
+	MD5_STEP(MD5_I, d, a, b, c, x[ 3], 0x8f0ccc92, 10)
+	MD5_STEP(MD5_I, c, d, a, b, x[10], 0xffeff47d, 15)
+	MD5_STEP(MD5_I, b, c, d, a, x[ 1], 0x85845dd1, 21)
+	MD5_STEP(MD5_I, a, b, c, d, x[ 8], 0x6fa87e4f,  6)
+	MD5_STEP(MD5_I, d, a, b, c, x[15], 0xfe2ce6e0, 10)
+	MD5_STEP(MD5_I, c, d, a, b, x[ 6], 0xa3014314, 15)
+	MD5_STEP(MD5_I, b, c, d, a, x[13], 0x4e0811a1, 21)
+	MD5_STEP(MD5_I, a, b, c, d, x[ 4], 0xf7537e82,  6)
+	MD5_STEP(MD5_I, d, a, b, c, x[11], 0xbd3af235, 10)
+	MD5_STEP(MD5_I, c, d, a, b, x[ 2], 0x2ad7d2bb, 15)
+	MD5_STEP(MD5_I, b, c, d, a, x[ 9], 0xeb86d391, 21)
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+}
+
+void md5_init(struct md5_context *ctx)
+{
+	ctx->state[0] = 0x67452301;
+	ctx->state[1] = 0xefcdab89;
+	ctx->state[2] = 0x98badcfe;
+	ctx->state[3] = 0x10325476;
+	ctx->count = 0;
+}
+
+void md5_update(struct md5_context *ctx, const unsigned char *data, size_t len)
+{
+	size_t used, fill;
+
+	used = (size_t)(ctx->count & 63);
+	ctx->count += len;
+	if (used) {
+		fill = 64 - used;
+		if (len < fill) {
+			memcpy(ctx->buffer + used, data, len);
+			return;
+		}
+		memcpy(ctx->buffer + used, data, fill);
+		md5_transform(ctx->state, ctx->buffer);
+		data += fill;
+		len -= fill;
+	}
+	while (len >= 64) {
+		md5_transform(ctx->state, data);
+		data += 64;
+		len -= 64;
+	}
+	memcpy(ctx->buffer, data, len);
+}
+
+void md5_final(struct md5_context *ctx, uint32_t digest[4])
+/* the digest bytes, read as four big-endian words */
+{
+	unsigned char pad[72];
+	uint64_t bits;
+	size_t used, npad;
+	int i;
+
+	bits = ctx->count << 3;
+	used = (size_t)(ctx->count & 63);
+	npad = (used < 56) ? 56 - used : 120 - used;
+	memset(pad, 0, sizeof(pad));
+	pad[0] = 0x80;
+	for (i = 0; i < 8; i++) {
+		pad[npad + i] = (unsigned char)(bits >> (8 * i));
+	}
+	md5_update(ctx, pad, npad + 8);
+	for (i = 0; i < 4; i++) {
+		digest[i] = ((ctx->state[i] & 0xff) << 24) | ((ctx->state[i] & 0xff00) << 8) |
+					((ctx->state[i] >> 8) & 0xff00) | (ctx->state[i] >> 24);
+	}
+}
+
+/**********/
+/* SHA256 */
+/**********/
+
+static const uint32_t sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+	0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+	0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+	0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+	0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+	0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static void sha256_transform(uint32_t state[8], const unsigned char block[64])
+{
+	uint32_t w[64], a, b, c, d, e, f, g, h, t1, t2;
+	int i;
+
+	for (i = 0; i < 16; i++) {
+		w[i] = ((uint32_t)block[i*4] << 24) | ((uint32_t)block[i*4+1] << 16) |
+			   ((uint32_t)block[i*4+2] << 8) | (uint32_t)block[i*4+3];
+	}
+	for (i = 16; i < 64; i++) {
+		w[i] = (ROTR32(w[i-2], 17) ^ ROTR32(w[i-2], 19) ^ (w[i-2] >> 10)) + w[i-7] +
+			   (ROTR32(w[i-15], 7) ^ ROTR32(w[i-15], 18) ^ (w[i-15] >> 3)) + w[i-16];
+	}
+	a = state[0];
+	b = state[1];
+	c = state[2];
+	d = state[3];
+	e = state[4];
+	f = state[5];
+	g = state[6];
+	h = state[7];
+	for (i = 0; i < 64; i++) {
+		t1 = h + (ROTR32(e, 6) ^ ROTR32(e, 11) ^ ROTR32(e, 25)) +
+			 ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+		t2 = (ROTR32(a, 2) ^ ROTR32(a, 13) ^ ROTR32(a, 22)) +
+			 ((a & b) ^ (a & c) ^ (b & c));
+		h = g;
+		g = f;
+		f = e;
+		e = d + t1;
+		d = c;
+		c = b;
+		b = a;
+		a = t1 + t2;
+	}
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
+
+void sha256_init(struct sha256_context *ctx)
+{
+	ctx->state[0] = 0x6a09e667;
+	ctx->state[1] = 0xbb67ae85;
+	ctx->state[2] = 0x3c6ef372;
+	ctx->state[3] = 0xa54ff53a;
+	ctx->state[4] = 0x510e527f;
+	ctx->state[5] = 0x9b05688c;
+	ctx->state[6] = 0x1f83d9ab;
+	ctx->state[7] = 0x5be0cd19;
+	ctx->count = 0;
+}
+
+void sha256_update(struct sha256_context *ctx, const unsigned char *data, size_t len)
+{
+	size_t used, fill;
+
+	used = (size_t)(ctx->count & 63);
+	ctx->count += len;
+	if (used) {
+		fill = 64 - used;
+		if (len < fill) {
+			memcpy(ctx->buffer + used, data, len);
+			return;
+		}
+		memcpy(ctx->buffer + used, data, fill);
+		sha256_transform(ctx->state, ctx->buffer);
+		data += fill;
+		len -= fill;
+	}
+	while (len >= 64) {
+		sha256_transform(ctx->state, data);
+		data += 64;
+		len -= 64;
+	}
+	memcpy(ctx->buffer, data, len);
+}
+
+void sha256_final(struct sha256_context *ctx, uint32_t digest[8])
+{
+	unsigned char pad[72];
+	uint64_t bits;
+	size_t used, npad;
+	int i;
+
+	bits = ctx->count << 3;
+	used = (size_t)(ctx->count & 63);
+	npad = (used < 56) ? 56 - used : 120 - used;
+	memset(pad, 0, sizeof(pad));
+	pad[0] = 0x80;
+	for (i = 0; i < 8; i++) {
+		pad[npad + i] = (unsigned char)(bits >> (56 - 8 * i));
+	}
+	sha256_update(ctx, pad, npad + 8);
+	for (i = 0; i < 8; i++) {
+		digest[i] = ctx->state[i];
+	}
+}
+
+/***********************************/
+/* Adler-32, Fletcher-32, Hsieh-32 */
+/***********************************/
+
+/* These give the same values as hash() does for a sequence of bytes,
+   except for Hsieh, which hash() seeds with the length of the data.
+   The length isn't known up front here, so the seed is 0. */
+
+static void adler32_update(struct hash_handle *h, const unsigned char *data, size_t len)
+{
+	uint32_t a = h->ctx.adler.a;
+	uint32_t b = h->ctx.adler.b;
+	size_t n;
+
+	while (len > 0) {
+		// 5552 is the most bytes that can be summed before b overflows
+		n = (len < 5552) ? len : 5552;
+		len -= n;
+		while (n-- > 0) {
+			a += *data++;
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+	h->ctx.adler.a = a;
+	h->ctx.adler.b = b;
+}
+
+static void fletcher32_update(struct hash_handle *h, const unsigned char *data, size_t len)
+{
+	uint32_t a = h->ctx.fletcher.a;
+	uint32_t b = h->ctx.fletcher.b;
+	int pending = h->ctx.fletcher.pending;
+
+	while (len-- > 0) {
+		if (pending == -1) {
+			pending = *data++;
+		}
+		else {
+			a += (*data++ + pending) << 8;
+			pending = -1;
+			b += a;
+		}
+	}
+	h->ctx.fletcher.a = a;
+	h->ctx.fletcher.b = b;
+	h->ctx.fletcher.pending = pending;
+}
+
+#define HSIEH_GET16(d) ((((uint32_t)(((const uint8_t *)(d))[1])) << 8) \
+						+ (uint32_t)(((const uint8_t *)(d))[0]))
+
+static void hsieh32_update(struct hash_handle *h, const unsigned char *data, size_t len)
+{
+	uint32_t hash = h->ctx.hsieh.hash;
+	char *buf = h->ctx.hsieh.buf;
+	int nbuf = h->ctx.hsieh.nbuf;
+
+	while (len > 0) {
+		if (nbuf == 0 && len >= 4) {
+			hash += HSIEH_GET16(data);
+			hash = (hash << 16) ^ ((HSIEH_GET16(data + 2) << 11) ^ hash);
+			hash += hash >> 11;
+			data += 4;
+			len -= 4;
+		}
+		else {
+			buf[nbuf++] = *data++;
+			len--;
+			if (nbuf == 4) {
+				hash += HSIEH_GET16(buf);
+				hash = (hash << 16) ^ ((HSIEH_GET16(buf + 2) << 11) ^ hash);
+				hash += hash >> 11;
+				nbuf = 0;
+			}
+		}
+	}
+	h->ctx.hsieh.hash = hash;
+	h->ctx.hsieh.nbuf = nbuf;
+}
+
+static uint32_t hsieh32_final(struct hash_handle *h)
+{
+	uint32_t hash = h->ctx.hsieh.hash;
+	char *buf = h->ctx.hsieh.buf;
+
+	switch (h->ctx.hsieh.nbuf) {
+		case 3: hash += HSIEH_GET16(buf);
+				hash ^= hash << 16;
+				hash ^= buf[2] << 18;
+				hash += hash >> 11;
+				break;
+		case 2: hash += HSIEH_GET16(buf);
+				hash ^= hash << 11;
+				hash += hash >> 17;
+				break;
+		case 1: hash += buf[0];
+				hash ^= hash << 10;
+				hash += hash >> 1;
+	}
+	hash ^= hash << 3;
+	hash += hash >> 5;
+	hash ^= hash << 4;
+	hash += hash >> 17;
+	hash ^= hash << 25;
+	hash += hash >> 6;
+	return hash;
+}
+
+/**********/
+/* CRC32C */
+/**********/
+
+/* Castagnoli polynomial, bit reflected, as used by iSCSI, ext4 and SSE4.2 */
+#define CRC32C_POLY 0x82f63b78
+
+static uint32_t crc32c_table[8][256];
+static int crc32c_ready = 0;  // 1 for the tables, 2 for SSE4.2
+
+static void crc32c_setup()
+/* build the slice-by-8 tables, or find out that they aren't needed */
+{
+	uint32_t crc;
+	int i, j;
+#ifdef HASH_SSE42
+	unsigned int eax, ebx, ecx, edx;
+
+	if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_2)) {
+		crc32c_ready = 2;
+		return;
+	}
+#endif
+	for (i = 0; i < 256; i++) {
+		crc = i;
+		for (j = 0; j < 8; j++) {
+			crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+		}
+		crc32c_table[0][i] = crc;
+	}
+	for (i = 0; i < 256; i++) {
+		crc = crc32c_table[0][i];
+		for (j = 1; j < 8; j++) {
+			crc = crc32c_table[0][crc & 0xff] ^ (crc >> 8);
+			crc32c_table[j][i] = crc;
+		}
+	}
+	crc32c_ready = 1;
+}
+
+static uint32_t crc32c_soft(uint32_t crc, const unsigned char *data, size_t len)
+{
+	uint32_t lo, hi;
+
+	while (len >= 8) {
+		lo = crc ^ ((uint32_t)data[0] | ((uint32_t)data[1] << 8) |
+					((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24));
+		hi = (uint32_t)data[4] | ((uint32_t)data[5] << 8) |
+			 ((uint32_t)data[6] << 16) | ((uint32_t)data[7] << 24);
+		crc = crc32c_table[7][lo & 0xff] ^ crc32c_table[6][(lo >> 8) & 0xff] ^
+			  crc32c_table[5][(lo >> 16) & 0xff] ^ crc32c_table[4][lo >> 24] ^
+			  crc32c_table[3][hi & 0xff] ^ crc32c_table[2][(hi >> 8) & 0xff] ^
+			  crc32c_table[1][(hi >> 16) & 0xff] ^ crc32c_table[0][hi >> 24];
+		data += 8;
+		len -= 8;
+	}
+	while (len-- > 0) {
+		crc = crc32c_table[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+	}
+	return crc;
+}
+
+#ifdef HASH_SSE42
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const unsigned char *data, size_t len)
+{
+#ifdef __x86_64__
+	uint64_t crc64 = crc, word;
+
+	while (len >= 8) {
+		memcpy(&word, data, 8);
+		crc64 = __builtin_ia32_crc32di(crc64, word);
+		data += 8;
+		len -= 8;
+	}
+	crc = (uint32_t)crc64;
+#else
+	uint32_t word;
+
+	while (len >= 4) {
+		memcpy(&word, data, 4);
+		crc = __builtin_ia32_crc32si(crc, word);
+		data += 4;
+		len -= 4;
+	}
+#endif
+	while (len-- > 0) {
+		crc = __builtin_ia32_crc32qi(crc, *data++);
+	}
+	return crc;
+}
+#endif
+
+static uint32_t crc32c_update(uint32_t crc, const unsigned char *data, size_t len)
+/* crc is the running value, before the final inversion */
+{
+	if (crc32c_ready == 0)
+		crc32c_setup();
+#ifdef HASH_SSE42
+	if (crc32c_ready == 2)
+		return crc32c_sse42(crc, data, len);
+#endif
+	return crc32c_soft(crc, data, len);
+}
+
+/************/
+/* xxHash64 */
+/************/
+
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+#define ROTL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+static uint64_t xxh64_read64(const unsigned char *p)
+{
+	return (uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) |
+		   ((uint64_t)p[3] << 24) | ((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40) |
+		   ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56);
+}
+
+static uint64_t xxh64_round(uint64_t acc, uint64_t input)
+{
+	acc += input * XXH_PRIME64_2;
+	acc = ROTL64(acc, 31);
+	return acc * XXH_PRIME64_1;
+}
+
+static uint64_t xxh64_merge_round(uint64_t acc, uint64_t val)
+{
+	acc ^= xxh64_round(0, val);
+	return acc * XXH_PRIME64_1 + XXH_PRIME64_4;
+}
+
+static void xxh64_init(struct hash_handle *h)
+{
+	h->ctx.xxh64.v[0] = XXH_PRIME64_1 + XXH_PRIME64_2;
+	h->ctx.xxh64.v[1] = XXH_PRIME64_2;
+	h->ctx.xxh64.v[2] = 0;
+	h->ctx.xxh64.v[3] = -XXH_PRIME64_1;
+	h->ctx.xxh64.count = 0;
+	h->ctx.xxh64.nbuf = 0;
+}
+
+static void xxh64_stripes(uint64_t v[4], const unsigned char *data, size_t n)
+/* consume n 32-byte stripes */
+{
+	uint64_t v0 = v[0], v1 = v[1], v2 = v[2], v3 = v[3];
+
+	while (n-- > 0) {
+		v0 = xxh64_round(v0, xxh64_read64(data));
+		v1 = xxh64_round(v1, xxh64_read64(data + 8));
+		v2 = xxh64_round(v2, xxh64_read64(data + 16));
+		v3 = xxh64_round(v3, xxh64_read64(data + 24));
+		data += 32;
+	}
+	v[0] = v0;
+	v[1] = v1;
+	v[2] = v2;
+	v[3] = v3;
+}
+
+static void xxh64_update(struct hash_handle *h, const unsigned char *data, size_t len)
+{
+	size_t fill;
+	int nbuf = h->ctx.xxh64.nbuf;
+
+	h->ctx.xxh64.count += len;
+	if (nbuf) {
+		fill = 32 - nbuf;
+		if (len < fill) {
+			memcpy(h->ctx.xxh64.buf + nbuf, data, len);
+			h->ctx.xxh64.nbuf += (int)len;
+			return;
+		}
+		memcpy(h->ctx.xxh64.buf + nbuf, data, fill);
+		xxh64_stripes(h->ctx.xxh64.v, h->ctx.xxh64.buf, 1);
+		data += fill;
+		len -= fill;
+	}
+	xxh64_stripes(h->ctx.xxh64.v, data, len / 32);
+	data += len & ~(size_t)31;
+	len &= 31;
+	memcpy(h->ctx.xxh64.buf, data, len);
+	h->ctx.xxh64.nbuf = (int)len;
+}
+
+static uint64_t xxh64_final(struct hash_handle *h)
+{
+	uint64_t *v = h->ctx.xxh64.v;
+	unsigned char *p = h->ctx.xxh64.buf;
+	int n = h->ctx.xxh64.nbuf;
+	uint64_t hash;
+
+	if (h->ctx.xxh64.count >= 32) {
+		hash = ROTL64(v[0], 1) + ROTL64(v[1], 7) + ROTL64(v[2], 12) + ROTL64(v[3], 18);
+		hash = xxh64_merge_round(hash, v[0]);
+		hash = xxh64_merge_round(hash, v[1]);
+		hash = xxh64_merge_round(hash, v[2]);
+		hash = xxh64_merge_round(hash, v[3]);
+	}
+	else {
+		hash = XXH_PRIME64_5;
+	}
+	hash += h->ctx.xxh64.count;
+
+	for (; n >= 8; n -= 8, p += 8) {
+		hash ^= xxh64_round(0, xxh64_read64(p));
+		hash = ROTL64(hash, 27) * XXH_PRIME64_1 + XXH_PRIME64_4;
+	}
+	if (n >= 4) {
+		hash ^= ((uint64_t)p[0] | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) |
+				 ((uint64_t)p[3] << 24)) * XXH_PRIME64_1;
+		hash = ROTL64(hash, 23) * XXH_PRIME64_2 + XXH_PRIME64_3;
+		n -= 4;
+		p += 4;
+	}
+	while (n-- > 0) {
+		hash ^= (*p++) * XXH_PRIME64_5;
+		hash = ROTL64(hash, 11) * XXH_PRIME64_1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= XXH_PRIME64_2;
+	hash ^= hash >> 29;
+	hash *= XXH_PRIME64_3;
+	hash ^= hash >> 32;
+	return hash;
+}
+
+/********************/
+/* Euphoria handles */
+/********************/
+
+static void hash_handle_clean(object x)
+{
+	// the state lives in the cleanup record itself, which the caller frees
+	UNUSED(x);
+}
+
+static struct hash_handle *get_hash_handle(object x)
+{
+	cleanup_ptr cp = NULL;
+
+	if (IS_ATOM_DBL(x)) {
+		cp = DBL_PTR(x)->cleanup;
+		while (cp != NULL && cp->type != CLEAN_HASH) {
+			cp = cp->next;
+		}
+	}
+	if (cp == NULL)
+		RTFatal("a hash state from hash_init() was expected");
+	return (struct hash_handle *)cp;
+}
+
+static void hash_bytes(struct hash_handle *h, const unsigned char *data, size_t len)
+{
+	switch (h->algo) {
+		case HASH_SHA256:
+			sha256_update(&h->ctx.sha256, data, len);
+			break;
+		case HASH_MD5:
+			md5_update(&h->ctx.md5, data, len);
+			break;
+		case HASH_FLETCHER32:
+			fletcher32_update(h, data, len);
+			break;
+		case HASH_ADLER32:
+			adler32_update(h, data, len);
+			break;
+		case HASH_CRC32C:
+			h->ctx.crc32c.crc = crc32c_update(h->ctx.crc32c.crc, data, len);
+			break;
+		case HASH_XXHASH64:
+			xxh64_update(h, data, len);
+			break;
+		default:
+			hsieh32_update(h, data, len);
+			break;
+	}
+}
+
+object hash_init(object x)
+/* returns a new hash state for algorithm x */
+{
+	struct hash_handle *h;
+	object handle;
+	int algo;
+
+	algo = (int)get_int(x);
+	if (algo < HASH_XXHASH64 || algo > HASH_SHA256)
+		RTFatal("hash_init: unsupported hash algorithm %d", algo);
+
+	h = (struct hash_handle *)EMalloc(sizeof(struct hash_handle));
+	h->cleanup.type = CLEAN_HASH;
+	h->cleanup.func.builtin = &hash_handle_clean;
+	h->cleanup.next = NULL;
+	h->algo = algo;
+	switch (algo) {
+		case HASH_SHA256:
+			sha256_init(&h->ctx.sha256);
+			break;
+		case HASH_MD5:
+			md5_init(&h->ctx.md5);
+			break;
+		case HASH_FLETCHER32:
+			h->ctx.fletcher.a = 1;
+			h->ctx.fletcher.b = 0;
+			h->ctx.fletcher.pending = -1;
+			break;
+		case HASH_ADLER32:
+			h->ctx.adler.a = 1;
+			h->ctx.adler.b = 0;
+			break;
+		case HASH_CRC32C:
+			h->ctx.crc32c.crc = 0xffffffff;
+			break;
+		case HASH_XXHASH64:
+			xxh64_init(h);
+			break;
+		default:
+			h->ctx.hsieh.hash = 0;
+			h->ctx.hsieh.nbuf = 0;
+			break;
+	}
+
+	handle = NewDouble((eudouble)algo);
+	DBL_PTR(handle)->cleanup = (cleanup_ptr)h;
+	return handle;
+}
+
+static int byte_value(object e)
+/* e as a byte, or -1 if it isn't an integer from 0 to 255 */
+{
+	eudouble d;
+
+	if ((uintptr_t)e <= 255)
+		return (int)e;
+	if (IS_ATOM_DBL(e)) {
+		d = DBL_PTR(e)->dbl;
+		if (d >= 0.0 && d <= 255.0 && d == (eudouble)(int)d)
+			return (int)d;
+	}
+	return -1;
+}
+
+static int hash_sequence(struct hash_handle *h, s1_ptr s)
+/* feed the elements of s to h. returns 0, having hashed nothing,
+   if s is not a sequence of bytes */
+{
+	unsigned char chunk[HASH_CHUNK];
+	object_ptr p;
+	object e;
+	intptr_t len;
+	size_t i, n;
+	int b;
+
+	p = s->base;
+	len = s->length;
+	if (len > HASH_CHUNK) {
+		// check everything before the first chunk is hashed
+		for (i = len; i > 0; i--) {
+			e = *(++p);
+			if ((uintptr_t)e > 255 && byte_value(e) < 0)
+				return 0;
+		}
+		p = s->base;
+	}
+	while (len > 0) {
+		n = (len < HASH_CHUNK) ? (size_t)len : HASH_CHUNK;
+		len -= n;
+		for (i = 0; i < n; i++) {
+			e = *(++p);
+			if ((uintptr_t)e > 255) {
+				b = byte_value(e);
+				if (b < 0)
+					return 0;
+				e = b;
+			}
+			chunk[i] = (unsigned char)e;
+		}
+		hash_bytes(h, chunk, n);
+	}
+	return 1;
+}
+
+static void hash_object(struct hash_handle *h, object a, int top)
+/* feed any Euphoria object to h. Integers and doubles with integer values
+   hash the same, as do sequences that are equal().  A sequence of bytes at
+   the top level is hashed as just those bytes */
+{
+	unsigned char b[8];
+	int64_t i64;
+	double d;
+	eudouble ed;
+	object_ptr p;
+	intptr_t len;
+	int k;
+
+	if (IS_ATOM_INT(a)) {
+		i64 = a;
+	}
+	else if (IS_ATOM_DBL(a)) {
+		ed = DBL_PTR(a)->dbl;
+		if (ed >= -9.2e18 && ed <= 9.2e18 && ed == (eudouble)(int64_t)ed) {
+			i64 = (int64_t)ed;
+		}
+		else {
+			d = (double)ed;
+			memcpy(b, &d, 8);
+			hash_bytes(h, b, 8);
+			return;
+		}
+	}
+	else {
+		len = SEQ_PTR(a)->length;
+		if (!top) {
+			// nested sequences include their length so that
+			// {"ab","c"} and {"a","bc"} differ
+			i64 = len;
+			for (k = 0; k < 8; k++) {
+				b[k] = (unsigned char)(i64 >> (8 * k));
+			}
+			hash_bytes(h, b, 8);
+		}
+		if (!hash_sequence(h, SEQ_PTR(a))) {
+			p = SEQ_PTR(a)->base;
+			while (len-- > 0) {
+				hash_object(h, *(++p), 0);
+			}
+		}
+		return;
+	}
+	for (k = 0; k < 8; k++) {
+		b[k] = (unsigned char)(i64 >> (8 * k));
+	}
+	hash_bytes(h, b, 8);
+}
+
+object hash_update(object x)
+/* x is {state, data, count}. data is either a sequence of bytes,
+   or the address of count bytes of memory */
+{
+	struct hash_handle *h;
+	object data;
+	uintptr_t len;
+
+	x = (object)SEQ_PTR(x);
+	h = get_hash_handle(*(((s1_ptr)x)->base+1));
+	data = *(((s1_ptr)x)->base+2);
+
+	if (IS_ATOM(data)) {
+		len = get_pos_int("hash_update", *(((s1_ptr)x)->base+3));
+		if (len > 0)
+			hash_bytes(h, (unsigned char *)get_pos_int("hash_update", data), (size_t)len);
+	}
+	else if (!hash_sequence(h, SEQ_PTR(data))) {
+		RTFatal("hash_update: a sequence of bytes was expected");
+	}
+	return ATOM_1;
+}
+
+static object hash_result(struct hash_handle *h)
+/* finish the calculation in h, which is left unusable */
+{
+	uint32_t digest[8];
+	uint64_t x64;
+	s1_ptr result;
+	int i, n;
+
+	switch (h->algo) {
+		case HASH_SHA256:
+		case HASH_MD5:
+			if (h->algo == HASH_SHA256) {
+				sha256_final(&h->ctx.sha256, digest);
+				n = 8;
+			}
+			else {
+				md5_final(&h->ctx.md5, digest);
+				n = 4;
+			}
+			result = NewS1(n);
+			for (i = 0; i < n; i++) {
+				result->base[i+1] = make_atom32(digest[i]);
+			}
+			return MAKE_SEQ(result);
+
+		case HASH_FLETCHER32:
+			if (h->ctx.fletcher.pending != -1) {
+				h->ctx.fletcher.a += h->ctx.fletcher.pending << 8;
+				h->ctx.fletcher.b += h->ctx.fletcher.a;
+			}
+			return make_atom32((h->ctx.fletcher.b << 16) | h->ctx.fletcher.a);
+
+		case HASH_ADLER32:
+			return make_atom32((h->ctx.adler.b << 16) | h->ctx.adler.a);
+
+		case HASH_HSIEH32:
+			return make_atom32(hsieh32_final(h));
+
+		case HASH_CRC32C:
+			return make_atom32(~h->ctx.crc32c.crc);
+
+		case HASH_XXHASH64:
+			// exact on 64-bit platforms, rounded to a double elsewhere
+			x64 = xxh64_final(h);
+			if (x64 <= (uint64_t)MAXINT)
+				return (object)x64;
+			return NewDouble((eudouble)x64);
+
+		default:
+			digest[0] = hsieh32_final(h);
+			return MAKE_INT(0x3FFFFFFF & (digest[0] + ((0xC0000000 & digest[0]) >> 30)));
+	}
+}
+
+object hash_final(object x)
+/* the hash of everything passed to hash_update() so far, in the same
+   form as hash() returns it. The state can still be updated afterwards */
+{
+	struct hash_handle h;
+
+	memcpy(&h, get_hash_handle(x), sizeof(struct hash_handle));
+	return hash_result(&h);
+}
+
+object hash_value(object a, int algo)
+/* hash(a, algo) for the CRC32C and XXHASH64 algorithms */
+{
+	struct hash_handle h;
+
+	h.algo = algo;
+	if (algo == HASH_CRC32C)
+		h.ctx.crc32c.crc = 0xffffffff;
+	else
+		xxh64_init(&h);
+	hash_object(&h, a, 1);
+	return hash_result(&h);
+}
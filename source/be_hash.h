@@ -0,0 +1,32 @@
+#ifndef BE_HASH_H_
+#define BE_HASH_H_
+
+#include <stdint.h>
+#include "execute.h"
+
+struct md5_context {
+	uint32_t state[4];
+	uint64_t count;          // number of bytes hashed so far
+	unsigned char buffer[64];
+};
+
+struct sha256_context {
+	uint32_t state[8];
+	uint64_t count;          // number of bytes hashed so far
+	unsigned char buffer[64];
+};
+
+void md5_init(struct md5_context *ctx);
+void md5_update(struct md5_context *ctx, const unsigned char *data, size_t len);
+void md5_final(struct md5_context *ctx, uint32_t digest[4]);
+
+void sha256_init(struct sha256_context *ctx);
+void sha256_update(struct sha256_context *ctx, const unsigned char *data, size_t len);
+void sha256_final(struct sha256_context *ctx, uint32_t digest[8]);
+
+object hash_init(object x);
+object hash_update(object x);
+object hash_final(object x);
+object hash_value(object a, int algo);
+
+#endif
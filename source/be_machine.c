@@ -44,6 +44,12 @@
 #include "be_coverage.h"
 #include "be_syncolor.h"
 #include "be_debug.h"
+#include "be_sort.h"
+#include "be_hash.h"
+#include "be_random.h"
+#include "be_walk.h"
+#include "be_binary.h"
+#include "be_parallel.h"
 
 #ifdef ELINUX
 #include <malloc.h>
@@ -1771,10 +1777,19 @@ double current_time()
 /* return value for time() function */
 {
 #ifdef EUNIX
+#ifdef CLOCK_MONOTONIC
+	struct timespec ts;
+#else
 	struct tms buf;
+#endif
 #endif
 	if (clock_frequency == 0.0) {
 		/* no handler */
+#if defined(EUNIX) && defined(CLOCK_MONOTONIC)
+		// precise to well under a microsecond, and never set back
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (double)ts.tv_sec + ts.tv_nsec / 1000000000.0 + clock_adjust;
+#else
 		return (double)
 #ifdef EUNIX
 		times(&buf) / clk_tck
@@ -1782,6 +1797,7 @@ double current_time()
 		clock() / (double)clocks_per_sec
 #endif
 		 + clock_adjust;
+#endif
 	}
 	else {
 		/* our handler is installed */
@@ -2771,7 +2787,6 @@ void Machine_Handler(int sig_no)
 }
 
 #ifndef ERUNTIME
-extern struct IL fe;
 int in_backend = 0;
 object start_backend(object x)
 /* called by Euphoria-written front-end to run the back-end
@@ -3325,6 +3340,147 @@ object machine(object opcode, object x)
 
             case M_KEY_CODES:
                 return key_codes(x);
+
+			case M_PARALLEL_SORT:
+				return parallel_sort(x);
+
+			case M_HASH_INIT:
+				return hash_init(x);
+
+			case M_HASH_UPDATE:
+				return hash_update(x);
+
+			case M_HASH_FINAL:
+				return hash_final(x);
+
+			case M_RNG_NEW:
+				return rng_new(x);
+
+			case M_RNG_SEED:
+				return rng_seed(x);
+
+			case M_RNG_INTS:
+				return rng_ints(x);
+
+			case M_RNG_DOUBLES:
+				return rng_doubles(x);
+
+			case M_RNG_SHUFFLE:
+				return rng_shuffle(x);
+
+			case M_GET_BYTES:
+				return EGetBytes(x);
+
+			case M_GETS_MANY:
+				return EGetsMany(x);
+
+			case M_LINES_OPEN:
+				return LinesOpen(x);
+
+			case M_LINES_NEXT:
+				return LinesNext(x);
+
+			case M_LINES_CLOSE:
+				return LinesClose(x);
+
+			case M_TASK_IO_WAIT:
+				return task_io_wait(x);
+
+			case M_IO_READ:
+				return EReadFd(x);
+
+			case M_IO_WRITE:
+				return EWriteFd(x);
+
+			case M_IO_SPLICE:
+				return ESpliceFd(x);
+
+			case M_SPAWN:
+				return ESpawn(x);
+
+			case M_WALK_OPEN:
+				return walk_open(x);
+
+			case M_WALK_NEXT:
+				return walk_next(x);
+
+			case M_WALK_CLOSE:
+				return walk_close(x);
+
+			case M_READ_ARRAY:
+				return read_array(x);
+
+			case M_WRITE_ARRAY:
+				return write_array(x);
+
+			case M_DECODE_ARRAY:
+				return decode_array_from(x);
+
+			case M_ENCODE_ARRAY:
+				return encode_array_to(x);
+
+			case M_PEEK_GATHER:
+				return peek_gather(x);
+
+			case M_PEEK_STRIDED:
+				return peek_strided(x);
+
+			case M_POKE_SCATTER:
+				return poke_scatter(x);
+
+			case M_POKE_STRIDED:
+				return poke_strided(x);
+
+			case M_TASK_WAIT_SPIN:
+				return task_wait_spin(x);
+
+			case M_FORK_WORKERS:
+				return fork_workers(x);
+
+			case M_WORKER_RETURN:
+				return worker_return(x);
+
+			case M_GATHER_WORKERS:
+				return gather_workers();
+
+			case M_CHANNEL_NEW:
+				return channel_new(x);
+
+			case M_CHANNEL_SEND:
+				return channel_send(x);
+
+			case M_CHANNEL_RECEIVE:
+				return channel_receive(x);
+
+			case M_CHANNEL_CLOSE:
+				return channel_close(x);
+
+			case M_CHANNEL_DELETE:
+				return channel_delete(x);
+
+			case M_SYNC_NEW:
+				return sync_new(x);
+
+			case M_SYNC_WAIT:
+				return sync_wait(x);
+
+			case M_SYNC_POST:
+				return sync_post(x);
+
+			case M_SYNC_CLEAR:
+				return sync_clear(x);
+
+			case M_SYNC_DELETE:
+				return sync_delete(x);
+
+			case M_TASK_STATS:
+				return task_stats(x);
+
+			case M_TASK_TRACE:
+				return task_trace(x);
+
+			case M_SYNC_BROADCAST:
+				return sync_broadcast(x);
 	
 			/* remember to check for MAIN_SCREEN wherever appropriate ! */
 			default:
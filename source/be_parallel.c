@@ -0,0 +1,488 @@
+/*****************************************************************************/
+/*      (c) Copyright - See License.txt       */
+/*****************************************************************************/
+/*                                                                           */
+/*                          Forked Worker Processes                          */
+/*                                                                           */
+/*****************************************************************************/
+
+/* The interpreter and the translated runtime share one heap and don't
+   lock reference counts, so Euphoria code can't run on more than one
+   thread.  A forked child, though, is a complete copy of the program with
+   a heap of its own, and it gets the parent's data copy-on-write without
+   anything being serialized.  parallel_apply() in std/sequence.e uses
+   that to run a routine over parts of a sequence in several processes at
+   once.
+
+   fork_workers() starts the children.  Each one carries on from the same
+   point in the Euphoria code, works out its part from the worker number
+   it was given, and hands its result to worker_return(), which sends it
+   back up a pipe and ends the process.  gather_workers() collects the
+   results in worker order.
+
+   A worker that hits a run-time error sends the error message up the pipe
+   instead, from RTFatal(), before it goes on to fail the usual way.  The
+   parent then stops with an error that names the worker and gives the
+   message, so a failure in a child can't go unnoticed.
+
+   Results go through the pipes in a simple native encoding, which is much
+   cheaper than std/serialize.e: both ends are the same program on the same
+   machine, so integers and doubles are copied as they are in memory.
+
+   Windows has no fork(), so fork_workers() reports that it couldn't start
+   anything and the caller does the work itself. */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdarg.h>
+
+#ifdef EUNIX
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#endif
+
+#include "alldefs.h"
+#include "be_alloc.h"
+#include "be_runtime.h"
+#include "be_machine.h"
+#include "be_pool.h"
+#include "be_parallel.h"
+
+#define PAR_INT   1  // an integer, as an intptr_t
+#define PAR_DBL   2  // an atom, as an eudouble
+#define PAR_SEQ   3  // a length, then that many encoded elements
+#define PAR_BYTES 4  // a length, then that many bytes: a sequence of 0..255
+#define PAR_ERROR 5  // a length, then the message of a worker that failed
+
+#define PAR_READ_CHUNK 65536
+#define PAR_ERROR_MAX 1000  // longest error message passed on
+
+struct par_buffer {
+	char *data;
+	size_t length;
+	size_t size;
+};
+
+static void par_reserve(struct par_buffer *b, size_t n)
+/* make room for n more bytes */
+{
+	size_t size;
+
+	if (b->length + n <= b->size)
+		return;
+	size = b->size ? b->size : 4096;
+	while (size < b->length + n)
+		size *= 2;
+	b->data = (b->data == NULL) ? EMalloc(size) : ERealloc(b->data, size);
+	b->size = size;
+}
+
+static void par_put(struct par_buffer *b, void *p, size_t n)
+{
+	par_reserve(b, n);
+	memcpy(b->data + b->length, p, n);
+	b->length += n;
+}
+
+static void par_put_tag(struct par_buffer *b, char tag, intptr_t n)
+{
+	par_reserve(b, 1 + sizeof(intptr_t));
+	b->data[b->length++] = tag;
+	memcpy(b->data + b->length, &n, sizeof(intptr_t));
+	b->length += sizeof(intptr_t);
+}
+
+static void par_encode(struct par_buffer *b, object x)
+/* append the encoding of x to b */
+{
+	s1_ptr s;
+	object_ptr elem;
+	intptr_t i, n;
+	char *out;
+
+	if (IS_ATOM_INT(x)) {
+		par_put_tag(b, PAR_INT, x);
+	}
+	else if (IS_ATOM_DBL(x)) {
+		par_reserve(b, 1 + sizeof(eudouble));
+		b->data[b->length++] = PAR_DBL;
+		par_put(b, &DBL_PTR(x)->dbl, sizeof(eudouble));
+	}
+	else {
+		s = SEQ_PTR(x);
+		n = s->length;
+		elem = s->base + 1;
+		for (i = 0; i < n; i++) {
+			if (!IS_ATOM_INT(elem[i]) || (uintptr_t)elem[i] > 255)
+				break;
+		}
+		if (i == n) {
+			par_put_tag(b, PAR_BYTES, n);
+			par_reserve(b, n);
+			out = b->data + b->length;
+			for (i = 0; i < n; i++)
+				out[i] = (char)elem[i];
+			b->length += n;
+		}
+		else {
+			par_put_tag(b, PAR_SEQ, n);
+			for (i = 0; i < n; i++)
+				par_encode(b, elem[i]);
+		}
+	}
+}
+
+static int par_decode(char **pp, char *end, object *result)
+/* decode one object at *pp, advancing *pp past it.
+   returns FALSE if the data is cut short or not understood */
+{
+	char *p = *pp;
+	char tag;
+	intptr_t i, n;
+	eudouble d;
+	s1_ptr s;
+
+	if (p >= end)
+		return FALSE;
+	tag = *p++;
+	if (tag == PAR_DBL) {
+		if (end - p < (intptr_t)sizeof(eudouble))
+			return FALSE;
+		memcpy(&d, p, sizeof(eudouble));
+		*result = NewDouble(d);
+		*pp = p + sizeof(eudouble);
+		return TRUE;
+	}
+	if (end - p < (intptr_t)sizeof(intptr_t))
+		return FALSE;
+	memcpy(&n, p, sizeof(intptr_t));
+	p += sizeof(intptr_t);
+
+	switch (tag) {
+		case PAR_INT:
+			*result = n;
+			break;
+
+		case PAR_BYTES:
+			if (n < 0 || end - p < n)
+				return FALSE;
+			s = NewS1(n);
+			for (i = 1; i <= n; i++)
+				s->base[i] = (unsigned char)*p++;
+			*result = MAKE_SEQ(s);
+			break;
+
+		case PAR_SEQ:
+			// every element takes at least one tag byte
+			if (n < 0 || end - p < n)
+				return FALSE;
+			s = NewS1(n);
+			for (i = 1; i <= n; i++)
+				s->base[i] = 0;
+			for (i = 1; i <= n; i++) {
+				if (!par_decode(&p, end, &s->base[i])) {
+					DeRefDS(MAKE_SEQ(s));
+					return FALSE;
+				}
+			}
+			*result = MAKE_SEQ(s);
+			break;
+
+		default:
+			return FALSE;
+	}
+	*pp = p;
+	return TRUE;
+}
+
+#ifdef EUNIX
+
+struct par_worker {
+	pid_t pid;
+	int fd;                  // read end of the worker's result pipe
+	struct par_buffer data;  // what the worker has sent so far
+};
+
+static struct par_worker *workers = NULL;
+static int nworkers = 0;   // children started by this process and not gathered
+static int result_fd = -1; // in a child, where worker_return() writes
+
+static void par_discard_workers()
+/* kill and reap any children that were started, forgetting their output */
+{
+	int i, status;
+
+	for (i = 0; i < nworkers; i++) {
+		kill(workers[i].pid, SIGKILL);
+		close(workers[i].fd);
+		while (waitpid(workers[i].pid, &status, 0) < 0 && errno == EINTR)
+			;
+		if (workers[i].data.data != NULL)
+			EFree(workers[i].data.data);
+	}
+	if (workers != NULL)
+		EFree((char *)workers);
+	workers = NULL;
+	nworkers = 0;
+}
+
+#endif
+
+object fork_workers(object x)
+/* start up to x worker processes (0: one per processor), but no more than
+   the number of items there are to work on.  x is {workers, items}.
+   returns {worker, workers} where worker is 0 in the parent and 1..workers
+   in each child, or -1 if fewer than two workers would be used, or none
+   could be started */
+{
+#ifdef EUNIX
+	s1_ptr s;
+	int n, i, fds[2];
+	intptr_t items;
+	pid_t pid;
+
+	if (!IS_SEQUENCE(x) || SEQ_PTR(x)->length != 2)
+		RTFatal("fork_workers: expected {workers, items}");
+	s = SEQ_PTR(x);
+	n = pool_size((int)get_int(s->base[1]));
+	items = get_int(s->base[2]);
+	if (n > items)
+		n = (int)items;
+	if (n < 2)
+		return -1;  // the caller does it all itself: a child would only add the fork
+	if (nworkers != 0)
+		RTFatal("fork_workers: the last workers have not been gathered");
+
+	// anything still buffered would otherwise be written once by every child
+	fflush(NULL);
+
+	workers = (struct par_worker *)EMalloc(n * sizeof(struct par_worker));
+	for (i = 0; i < n; i++) {
+		if (pipe(fds) != 0)
+			break;
+		pid = fork();
+		if (pid < 0) {
+			close(fds[0]);
+			close(fds[1]);
+			break;
+		}
+		if (pid == 0) {
+			// the child keeps only its own write end
+			close(fds[0]);
+			while (nworkers > 0) {
+				nworkers--;
+				close(workers[nworkers].fd);
+			}
+			EFree((char *)workers);
+			workers = NULL;
+			result_fd = fds[1];
+			s = NewS1(2);
+			s->base[1] = i + 1;
+			s->base[2] = n;
+			return MAKE_SEQ(s);
+		}
+		close(fds[1]);
+		workers[i].pid = pid;
+		workers[i].fd = fds[0];
+		workers[i].data.data = NULL;
+		workers[i].data.length = 0;
+		workers[i].data.size = 0;
+		nworkers++;
+	}
+	if (nworkers < n) {
+		par_discard_workers();
+		return -1;
+	}
+	s = NewS1(2);
+	s->base[1] = 0;
+	s->base[2] = n;
+	return MAKE_SEQ(s);
+#else
+	return -1;
+#endif
+}
+
+#ifdef EUNIX
+static int par_send(char *p, size_t n)
+/* write n bytes at p to the parent. returns FALSE if it couldn't */
+{
+	ssize_t w;
+
+	while (n > 0) {
+		w = write(result_fd, p, n);
+		if (w < 0) {
+			if (errno == EINTR)
+				continue;
+			return FALSE;
+		}
+		p += w;
+		n -= w;
+	}
+	return TRUE;
+}
+#endif
+
+object worker_return(object x)
+/* in a worker process, send x back to the parent and end the process */
+{
+#ifdef EUNIX
+	struct par_buffer b;
+
+	if (result_fd < 0)
+		RTFatal("worker_return: this is not a worker process");
+
+	b.data = NULL;
+	b.length = 0;
+	b.size = 0;
+	par_encode(&b, x);
+
+	fflush(NULL);
+	_exit(par_send(b.data, b.length) ? 0 : 1);
+#endif
+	return ATOM_0;
+}
+
+void worker_error_va(char *msg, va_list ap)
+/* in a worker process, pass a run-time error message on to the parent.
+   does nothing in any other process */
+{
+#ifdef EUNIX
+	char record[1 + sizeof(intptr_t) + PAR_ERROR_MAX];
+	intptr_t n;
+	va_list aq;
+
+	if (result_fd < 0)
+		return;
+	va_copy(aq, ap);
+	n = vsnprintf(record + 1 + sizeof(intptr_t), PAR_ERROR_MAX, msg, aq);
+	va_end(aq);
+	if (n < 0)
+		n = 0;
+	if (n >= PAR_ERROR_MAX)
+		n = PAR_ERROR_MAX - 1;
+	record[0] = PAR_ERROR;
+	memcpy(record + 1, &n, sizeof(intptr_t));
+	par_send(record, 1 + sizeof(intptr_t) + n);
+	// only the first error is passed on
+	close(result_fd);
+	result_fd = -1;
+#endif
+}
+
+void worker_error(char *msg, ...)
+{
+	va_list ap;
+	va_start(ap, msg);
+	worker_error_va(msg, ap);
+	va_end(ap);
+}
+
+object gather_workers()
+/* wait for every worker to finish and return their results, in order */
+{
+#ifdef EUNIX
+	struct pollfd *fds;
+	struct par_buffer *b;
+	int i, open_fds, status, failed, failed_status, n;
+	ssize_t r;
+	char *p;
+	intptr_t length;
+	char message[PAR_ERROR_MAX];
+	s1_ptr result;
+
+	if (nworkers == 0)
+		RTFatal("gather_workers: no workers were started");
+	n = nworkers;
+
+	fds = (struct pollfd *)EMalloc(n * sizeof(struct pollfd));
+	for (i = 0; i < n; i++) {
+		fds[i].fd = workers[i].fd;
+		fds[i].events = POLLIN;
+	}
+	open_fds = n;
+	while (open_fds > 0) {
+		if (poll(fds, n, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+		for (i = 0; i < n; i++) {
+			if (fds[i].fd < 0 || fds[i].revents == 0)
+				continue;
+			b = &workers[i].data;
+			par_reserve(b, PAR_READ_CHUNK);
+			r = read(fds[i].fd, b->data + b->length, PAR_READ_CHUNK);
+			if (r > 0) {
+				b->length += r;
+			}
+			else if (r == 0 || errno != EINTR) {
+				close(fds[i].fd);
+				fds[i].fd = -1;
+				open_fds--;
+			}
+		}
+	}
+	EFree((char *)fds);
+
+	failed = 0;
+	failed_status = -1;
+	message[0] = 0;
+	result = NewS1(n);
+	for (i = 1; i <= n; i++)
+		result->base[i] = 0;
+	for (i = 0; i < n; i++) {
+		while (waitpid(workers[i].pid, &status, 0) < 0 && errno == EINTR)
+			;
+		b = &workers[i].data;
+		p = b->data;
+		if (failed == 0) {
+			if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+				if (!par_decode(&p, b->data + b->length, &result->base[i+1]) ||
+					p != b->data + b->length)
+					failed = i + 1;
+			}
+			else {
+				failed = i + 1;
+				failed_status = status;
+				if (b->length > 1 + sizeof(intptr_t) && b->data[0] == PAR_ERROR) {
+					memcpy(&length, b->data + 1, sizeof(intptr_t));
+					if (length >= 0 && length < PAR_ERROR_MAX &&
+						(size_t)length <= b->length - 1 - sizeof(intptr_t)) {
+						memcpy(message, b->data + 1 + sizeof(intptr_t), length);
+						message[length] = 0;
+					}
+				}
+			}
+		}
+		if (b->data != NULL)
+			EFree(b->data);
+	}
+	EFree((char *)workers);
+	workers = NULL;
+	nworkers = 0;
+
+	if (failed) {
+		DeRefDS(MAKE_SEQ(result));
+		if (message[0] != 0)
+			RTFatal("parallel worker %d failed:\n%s", failed, message);
+		else if (failed_status == -1)
+			RTFatal("parallel worker %d sent back a bad result", failed);
+		else if (WIFSIGNALED(failed_status))
+			RTFatal("parallel worker %d was killed by signal %d", failed,
+					WTERMSIG(failed_status));
+		else
+			RTFatal("parallel worker %d ended with exit code %d", failed,
+					WEXITSTATUS(failed_status));
+	}
+	return MAKE_SEQ(result);
+#else
+	RTFatal("gather_workers: no workers were started");
+	return ATOM_0;
+#endif
+}
@@ -0,0 +1,14 @@
+#ifndef BE_PARALLEL_H_
+#define BE_PARALLEL_H_
+
+#include <stdarg.h>
+
+#include "execute.h"
+
+object fork_workers(object x);
+object worker_return(object x);
+object gather_workers();
+void worker_error(char *msg, ...);
+void worker_error_va(char *msg, va_list ap);
+
+#endif
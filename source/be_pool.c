@@ -0,0 +1,175 @@
+/*****************************************************************************/
+/*      (c) Copyright - See License.txt       */
+/*****************************************************************************/
+/*                                                                           */
+/*                          Native Worker Threads                            */
+/*                                                                           */
+/*****************************************************************************/
+
+/* A small pool of native threads that the runtime can hand self-contained
+   jobs to (sorting, bulk conversions, ...).  The pool is created lazily the
+   first time more than one thread is asked for and is then kept around, so
+   repeated calls don't pay for thread creation.
+
+   The caller of pool_run() takes part in the work and only returns once
+   every job is finished.  Idle workers pull the next job off the batch
+   until none are left, so a thread that gets a cheap job simply goes back
+   for another one.
+
+   On Windows the jobs are run one after the other by the calling thread. */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef EWINDOWS
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+#include "be_pool.h"
+
+#ifndef EWINDOWS
+
+struct pool_batch {
+	pool_job_func fn;
+	char *jobs;       // array of job records
+	size_t job_size;  // size of one job record
+	int njobs;
+	int next;         // index of the next job to hand out
+	int done;         // number of jobs finished
+	int helpers;      // number of workers still allowed to join in
+};
+
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_work = PTHREAD_COND_INITIALIZER;  // new batch posted
+static pthread_cond_t pool_idle = PTHREAD_COND_INITIALIZER;  // batch finished
+static struct pool_batch *pool_current = NULL;
+static int pool_generation = 0;  // incremented for every batch
+static int pool_workers = 0;     // number of worker threads started
+static int pool_fork_handler = 0; // pthread_atfork() handler installed?
+
+static void pool_work_batch(struct pool_batch *b)
+/* run jobs from batch b until there are none left.
+   pool_mutex must be held on entry and is held on exit */
+{
+	int i;
+
+	while (b->next < b->njobs) {
+		i = b->next++;
+		pthread_mutex_unlock(&pool_mutex);
+		(*b->fn)(b->jobs + i * b->job_size);
+		pthread_mutex_lock(&pool_mutex);
+		if (++b->done == b->njobs)
+			pthread_cond_signal(&pool_idle);
+	}
+}
+
+static void *pool_worker(void *arg)
+{
+	int seen = 0;
+	struct pool_batch *b;
+
+	pthread_mutex_lock(&pool_mutex);
+	for (;;) {
+		while (pool_current == NULL || seen == pool_generation)
+			pthread_cond_wait(&pool_work, &pool_mutex);
+		seen = pool_generation;
+		b = pool_current;
+		if (b->helpers > 0) {
+			b->helpers--;
+			pool_work_batch(b);
+		}
+	}
+	return arg;
+}
+
+static void pool_after_fork()
+/* a forked child has none of the parent's workers */
+{
+	pthread_mutex_init(&pool_mutex, NULL);
+	pthread_cond_init(&pool_work, NULL);
+	pthread_cond_init(&pool_idle, NULL);
+	pool_current = NULL;
+	pool_workers = 0;
+}
+
+static void pool_grow(int wanted)
+/* make sure at least wanted workers exist. pool_mutex must be held */
+{
+	pthread_t thread;
+	pthread_attr_t attr;
+
+	if (!pool_fork_handler) {
+		pthread_atfork(NULL, NULL, pool_after_fork);
+		pool_fork_handler = 1;
+	}
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	while (pool_workers < wanted) {
+		if (pthread_create(&thread, &attr, pool_worker, NULL) != 0)
+			break; // carry on with the workers we have
+		pool_workers++;
+	}
+	pthread_attr_destroy(&attr);
+}
+
+#endif
+
+int pool_size(int requested)
+/* number of threads to use when the user asks for requested threads.
+   0 or less means one per online processor */
+{
+#ifdef EWINDOWS
+	return 1;
+#else
+	long ncpu;
+
+	if (requested <= 0) {
+		ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+		requested = (ncpu > 0) ? (int)ncpu : 1;
+	}
+	if (requested > POOL_MAX_THREADS)
+		requested = POOL_MAX_THREADS;
+	return requested;
+#endif
+}
+
+void pool_run(pool_job_func fn, void *jobs, size_t job_size, int njobs, int nthreads)
+/* run fn on each of the njobs records in jobs, using up to nthreads
+   threads (including the caller), and wait for all of them to finish.
+   A job must not call pool_run() itself. */
+{
+	int i;
+#ifndef EWINDOWS
+	struct pool_batch b;
+
+	nthreads = pool_size(nthreads);
+	if (nthreads > njobs)
+		nthreads = njobs;
+	if (nthreads > 1) {
+		b.fn = fn;
+		b.jobs = (char *)jobs;
+		b.job_size = job_size;
+		b.njobs = njobs;
+		b.next = 0;
+		b.done = 0;
+		b.helpers = nthreads - 1;
+
+		pthread_mutex_lock(&pool_mutex);
+		pool_grow(nthreads - 1);
+		pool_current = &b;
+		pool_generation++;
+		pthread_cond_broadcast(&pool_work);
+
+		pool_work_batch(&b);
+		while (b.done < b.njobs)
+			pthread_cond_wait(&pool_idle, &pool_mutex);
+		pool_current = NULL;
+		pthread_mutex_unlock(&pool_mutex);
+		return;
+	}
+#endif
+	for (i = 0; i < njobs; i++) {
+		(*fn)((char *)jobs + i * job_size);
+	}
+}
@@ -0,0 +1,17 @@
+#ifndef BE_POOL_H_
+#define BE_POOL_H_
+
+#include <stddef.h>
+
+/* Native worker threads for runtime operations that can be split into
+   independent jobs.  Jobs run outside of the interpreter, so they must not
+   allocate, free or change the reference count of any Euphoria object. */
+
+#define POOL_MAX_THREADS 64
+
+typedef void (*pool_job_func)(void *job);
+
+int pool_size(int requested);
+void pool_run(pool_job_func fn, void *jobs, size_t job_size, int njobs, int nthreads);
+
+#endif
@@ -0,0 +1,290 @@
+/*****************************************************************************/
+/*      (c) Copyright - See License.txt       */
+/*****************************************************************************/
+/*                                                                           */
+/*                      xoshiro256** Random Numbers                          */
+/*                                                                           */
+/*****************************************************************************/
+
+/* rand() uses the original 32-bit generator, one value per call. This is
+   a faster 64-bit generator (xoshiro256** by Blackman and Vigna) whose
+   routines produce a whole sequence of numbers, or shuffle one, per call.
+
+   Each generator is a handle: a Euphoria atom whose cleanup record holds
+   the 256 bits of state, so a program (or each task in it) can keep as
+   many independent, separately seeded streams as it likes.  Handle 0 is
+   a shared default generator. */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "alldefs.h"
+#include "be_alloc.h"
+#include "be_runtime.h"
+#include "be_machine.h"
+#include "be_hash.h"
+#include "be_random.h"
+
+#define XXHASH64 -8  // hash() algorithm used to seed from a sequence
+
+struct rng_handle {
+	struct cleanup cleanup;  // must be first - freed by cleanup_double()
+	uint64_t s[4];
+};
+
+static uint64_t default_rng[4];
+static int default_rng_seeded = FALSE;
+
+#define ROTL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+static uint64_t rng_next(uint64_t *s)
+{
+	uint64_t result, t;
+
+	result = ROTL64(s[1] * 5, 7) * 9;
+	t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = ROTL64(s[3], 45);
+	return result;
+}
+
+static uint64_t rng_below(uint64_t *s, uint64_t range)
+/* an unbiased number from 0 to range-1. 0 means the full 64 bits */
+{
+	uint64_t x, threshold;
+
+	if (range == 0)
+		return rng_next(s);
+	// values below threshold would make some results more likely
+	threshold = (0 - range) % range;
+	do {
+		x = rng_next(s);
+	} while (x < threshold);
+	return x % range;
+}
+
+static uint64_t splitmix64(uint64_t *x)
+{
+	uint64_t z;
+
+	z = (*x += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+static void rng_set_seed(uint64_t *s, object seed)
+/* an atom or a non-empty sequence gives a repeatable state,
+   {} gives an unpredictable one */
+{
+	static uint64_t counter = 0;
+	uint64_t x;
+	object h;
+	eudouble d;
+	int i;
+
+	if (IS_ATOM_INT(seed)) {
+		x = (uint64_t)(int64_t)seed;
+	}
+	else if (IS_ATOM_DBL(seed)) {
+		d = DBL_PTR(seed)->dbl;
+		if (d >= -9.2e18 && d <= 9.2e18 && d == (eudouble)(int64_t)d) {
+			x = (uint64_t)(int64_t)d;
+		}
+		else {
+			h = hash_value(seed, XXHASH64);
+			x = IS_ATOM_INT(h) ? (uint64_t)h : (uint64_t)DBL_PTR(h)->dbl;
+			DeRef(h);
+		}
+	}
+	else if (SEQ_PTR(seed)->length > 0) {
+		h = hash_value(seed, XXHASH64);
+		x = IS_ATOM_INT(h) ? (uint64_t)h : (uint64_t)DBL_PTR(h)->dbl;
+		DeRef(h);
+	}
+	else {
+		x = (uint64_t)time(NULL) ^ ((uint64_t)clock() << 32) ^
+			(uint64_t)(uintptr_t)&x ^ (uint64_t)(uintptr_t)s ^
+			(++counter * 0xD1342543DE82EF95ULL);
+	}
+	for (i = 0; i < 4; i++) {
+		s[i] = splitmix64(&x);
+	}
+}
+
+static void rng_handle_clean(object x)
+{
+	// the state lives in the cleanup record itself, which the caller frees
+	UNUSED(x);
+}
+
+static uint64_t *get_rng(object x)
+/* the state for generator handle x, or the default generator for 0 */
+{
+	cleanup_ptr cp = NULL;
+	object seed;
+
+	if (x == ATOM_0) {
+		if (!default_rng_seeded) {
+			seed = MAKE_SEQ(NewS1(0));  // {} for an unpredictable state
+			rng_set_seed(default_rng, seed);
+			DeRefDS(seed);
+			default_rng_seeded = TRUE;
+		}
+		return default_rng;
+	}
+	if (IS_ATOM_DBL(x)) {
+		cp = DBL_PTR(x)->cleanup;
+		while (cp != NULL && cp->type != CLEAN_RNG) {
+			cp = cp->next;
+		}
+	}
+	if (cp == NULL)
+		RTFatal("a random generator from rng_new() was expected");
+	return ((struct rng_handle *)cp)->s;
+}
+
+static object make_int64(int64_t v)
+{
+	if (v >= MININT && v <= MAXINT)
+		return MAKE_INT((intptr_t)v);
+	return NewDouble((eudouble)v);
+}
+
+static int64_t get_int64(object x, char *where)
+/* an integer valued atom as a 64-bit integer */
+{
+	eudouble d;
+
+	if (IS_ATOM_INT(x))
+		return (int64_t)x;
+	if (IS_ATOM_DBL(x)) {
+		d = DBL_PTR(x)->dbl;
+		if (d >= -9.2e18 && d <= 9.2e18 && d == (eudouble)(int64_t)d)
+			return (int64_t)d;
+	}
+	RTFatal("%s: the bounds must be integers", where);
+	return 0;
+}
+
+object rng_new(object x)
+/* returns a new generator seeded with x */
+{
+	struct rng_handle *r;
+	object handle;
+
+	r = (struct rng_handle *)EMalloc(sizeof(struct rng_handle));
+	r->cleanup.type = CLEAN_RNG;
+	r->cleanup.func.builtin = &rng_handle_clean;
+	r->cleanup.next = NULL;
+	rng_set_seed(r->s, x);
+
+	handle = NewDouble((eudouble)0.5);
+	DBL_PTR(handle)->cleanup = (cleanup_ptr)r;
+	return handle;
+}
+
+object rng_seed(object x)
+/* x is {rng, seed} */
+{
+	s1_ptr args = SEQ_PTR(x);
+
+	rng_set_seed(get_rng(args->base[1]), args->base[2]);
+	if (args->base[1] == ATOM_0)
+		default_rng_seeded = TRUE;
+	return ATOM_1;
+}
+
+object rng_ints(object x)
+/* x is {rng, n, lo, hi}. returns n random integers from lo to hi */
+{
+	s1_ptr args, result;
+	uint64_t *s;
+	uint64_t range;
+	int64_t lo, hi;
+	object_ptr p;
+	intptr_t n, i;
+
+	args = SEQ_PTR(x);
+	s = get_rng(args->base[1]);
+	n = (intptr_t)get_pos_int("rng_ints", args->base[2]);
+	lo = get_int64(args->base[3], "rng_ints");
+	hi = get_int64(args->base[4], "rng_ints");
+	if (lo > hi)
+		RTFatal("rng_ints: the lower bound is greater than the upper bound");
+	range = (uint64_t)hi - (uint64_t)lo + 1;
+
+	result = NewS1(n);
+	p = result->base;
+	if (lo >= MININT && hi <= MAXINT) {
+		for (i = 0; i < n; i++) {
+			*(++p) = MAKE_INT((intptr_t)(lo + (int64_t)rng_below(s, range)));
+		}
+	}
+	else {
+		for (i = 0; i < n; i++) {
+			*(++p) = make_int64((int64_t)((uint64_t)lo + rng_below(s, range)));
+		}
+	}
+	return MAKE_SEQ(result);
+}
+
+object rng_doubles(object x)
+/* x is {rng, n}. returns n random numbers from 0.0 up to but not including 1.0 */
+{
+	s1_ptr args, result;
+	uint64_t *s;
+	object_ptr p;
+	intptr_t n, i;
+
+	args = SEQ_PTR(x);
+	s = get_rng(args->base[1]);
+	n = (intptr_t)get_pos_int("rng_doubles", args->base[2]);
+
+	result = NewS1(n);
+	p = result->base;
+	for (i = 0; i < n; i++) {
+		// the top 53 bits fill a double's mantissa exactly
+		*(++p) = NewDouble((eudouble)(rng_next(s) >> 11) * (1.0 / 9007199254740992.0));
+	}
+	return MAKE_SEQ(result);
+}
+
+object rng_shuffle(object x)
+/* x is {rng, sequence}. returns a copy of the sequence in random order */
+{
+	s1_ptr args, src, result;
+	uint64_t *s;
+	object_ptr p;
+	object t;
+	intptr_t n, i, j;
+
+	args = SEQ_PTR(x);
+	s = get_rng(args->base[1]);
+	if (!IS_SEQUENCE(args->base[2]))
+		RTFatal("rng_shuffle: a sequence was expected");
+	src = SEQ_PTR(args->base[2]);
+	n = src->length;
+
+	result = NewS1(n);
+	p = result->base;
+	for (i = 1; i <= n; i++) {
+		t = src->base[i];
+		Ref(t);
+		p[i] = t;
+	}
+	// Fisher-Yates
+	for (i = n; i > 1; i--) {
+		j = 1 + (intptr_t)rng_below(s, (uint64_t)i);
+		t = p[i];
+		p[i] = p[j];
+		p[j] = t;
+	}
+	return MAKE_SEQ(result);
+}
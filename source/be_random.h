@@ -0,0 +1,12 @@
+#ifndef BE_RANDOM_H_
+#define BE_RANDOM_H_
+
+#include "execute.h"
+
+object rng_new(object x);
+object rng_seed(object x);
+object rng_ints(object x);
+object rng_doubles(object x);
+object rng_shuffle(object x);
+
+#endif
@@ -52,6 +52,7 @@
 #include "be_syncolor.h"
 #include "be_task.h"
 #include "be_debug.h"
+#include "be_parallel.h"
 
 /******************/
 /* Local defines  */
@@ -858,7 +859,7 @@ static void DebugCommand()
 		else if (c == DOWN_ARROW) {
 			TraceOn = FALSE;
 			TraceBeyond = start_line;
-			TraceStack = expr_top - expr_stack;
+			TraceStack = (int)StackDepth();
 			break;
 		}
 		else if (c == '?') {
@@ -1218,7 +1219,7 @@ static void TraceBack(char *msg, symtab_ptr s_ptr)
 		levels = 0;
 		skipping = 0;
 		
-		while (expr_top > expr_stack+3) {
+		while (expr_top > expr_stack+3 || PopStackSegment()) {
 			// unwind the stack for this task
 			
 			expr_top -= 2;
@@ -1243,7 +1244,7 @@ static void TraceBack(char *msg, symtab_ptr s_ptr)
 #endif          
 				}
 				sf_output(TempBuff);
-				if (expr_top <= expr_stack+3)
+				if (expr_top <= expr_stack+3 && !PopStackSegment())
 					break;
 				expr_top -= 2;
 				new_pc = (intptr_t *)*expr_top;
@@ -1279,10 +1280,10 @@ static void TraceBack(char *msg, symtab_ptr s_ptr)
 		task = current_task;
 		for (i = 0; i < tcb_size; i++) {
 			if (tcb[i].status != ST_DEAD && 
-				tcb[i].impl.interpreted.expr_top > tcb[i].impl.interpreted.expr_stack+2-(tcb[i].tid == 0.0)) {
+				tcb[i].impl.interpreted.stack_top > tcb[i].impl.interpreted.stack+2-(tcb[i].tid == 0.0)) {
 				current_task = i;
-				expr_stack = tcb[i].impl.interpreted.expr_stack;
-				expr_top = tcb[i].impl.interpreted.expr_top;
+				EnterStackSegment(tcb[i].impl.interpreted.segment);
+				expr_top = tcb[i].impl.interpreted.stack_top;
 				tpc = tcb[i].impl.interpreted.pc;
 				screen_err_out = FALSE; // only show offending task on screen
 				break;
@@ -1421,21 +1422,10 @@ void RTFatalType(intptr_t *pc)
 
 	tpc = pc; /* points within the offending assignment/parm setting */
 	s_ptr = *(symtab_ptr *)pc;
+	worker_error("type_check failure, %s", s_ptr->name);
 	CleanUpError(NULL, s_ptr);
 }
 
-object_ptr BiggerStack()
-/* enlarge the runtime call stack */
-{
-	int top;
-
-	top = expr_top - expr_stack;
-	stack_size = stack_size + stack_size + max_stack_per_call;
-	expr_stack = (object_ptr)ERealloc((char *)expr_stack, stack_size * sizeof(object));
-	expr_top = expr_stack + top;
-	return expr_stack + stack_size - 5; /* new expr_max */
-}
-
 void BadSubscript(object subs, int length)
 /* report a subscript violation */
 {
@@ -30,7 +30,6 @@ void DisplayVar(symtab_ptr s_ptr, int user_requested);
 void DebugScreen();
 void UpdateGlobals();
 void ShowDebug();
-object_ptr BiggerStack();
 void atom_condition();
 void MainScreen();
 void RangeReading(object subs, int len);
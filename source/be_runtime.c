@@ -31,6 +31,15 @@
 #  include <time.h>
 #  include <sys/ioctl.h>
 #  include <sys/types.h>
+#  include <sys/uio.h>
+#  include <errno.h>
+#  include <fcntl.h>
+#  include <signal.h>
+#  include <spawn.h>
+#  include <sys/wait.h>
+#  ifdef ELINUX
+#    include <sys/syscall.h>
+#  endif
 #else
 #  include <io.h>
 #  if !defined(EMINGW)
@@ -45,6 +54,7 @@
 #endif
 
 #include <string.h>
+#include <sys/stat.h>
 #ifdef EWINDOWS
 	/* Ensure we set this to 0x400 whether or not it is set. */
 	#include <windows.h>
@@ -63,6 +73,8 @@
 #include "be_w.h"
 #include "be_callc.h"
 #include "be_task.h"
+#include "be_hash.h"
+#include "be_parallel.h"
 
 #ifndef ERUNTIME
 #include "be_rterror.h"
@@ -507,6 +519,8 @@ void call_crash_routines()
 #ifndef ERUNTIME
 	// clear the interpreter call stack
 	if ( expr_stack != NULL ) {
+		while (PopStackSegment())
+			;
 		expr_stack[1] = 0;
 		expr_top = &expr_stack[2];
 	}
@@ -595,6 +609,7 @@ static void SimpleRTFatal(char *msg, va_list ap)
 void RTFatal_va(char *msg, va_list ap)
 /* handle run time fatal errors */
 {
+	worker_error_va(msg, ap);
 #ifndef ERUNTIME
 	if (Executing)
 		CleanUpError_va(msg, NULL, ap);
@@ -1340,6 +1355,17 @@ void udt_clean_rt( object o, int rid ){
 }
 
 #ifndef ERUNTIME
+static void pop_call_back_frame(struct stack_segment *seg)
+/* after do_exec() has run a delete routine or call-back whose frame was
+   pushed on seg: the routine may have continued the call stack in new
+   segments, and it returns in the top one, so go back down to seg before
+   taking the frame off */
+{
+	while (expr_segment != seg && PopStackSegment())
+		;
+	expr_top -= 2;
+}
+
 /**
  * Calls the specified routine id for cleaning up the UDT object.
  */
@@ -1351,6 +1377,7 @@ void udt_clean( object o, uintptr_t rid ){
 	object args;
 	int pre_ref;
 	intptr_t *save_tpc;
+	struct stack_segment *seg;
 
 	// Need to make sure that s is 8-byte aligned
 	s = (s1_ptr)( ((object)&seq[7])  & ~7 );
@@ -1384,13 +1411,14 @@ void udt_clean( object o, uintptr_t rid ){
 	*expr_top++ = (object)tpc;    // needed for traceback
 	*expr_top = *(expr_top-2);  // prevents restore_privates()
 	++expr_top;
+	seg = expr_segment;
 
 	save_tpc = tpc;
 	do_exec(code);  // execute routine without setting up new stack
 	EFree((char *)code);
 
 	tpc = save_tpc;
-	expr_top -= 2;
+	pop_call_back_frame(seg);
 	if( pre_ref == 0 ){
 		SEQ_PTR(o)->ref -= 2;
 	}
@@ -2933,6 +2961,9 @@ object calc_hash(object a, object b)
 
 	IS_DOUBLE_AN_INTEGER(a)
 	if (IS_ATOM_INT(b)) {
+		if (b == -8 || b == -7)
+			return hash_value(a, (int)b);	// xxHash64 or CRC32C
+
 		if (b == -6)
 			return calc_hsieh30(a);	// Will always return a Euphoria integer.
 
@@ -3654,6 +3685,7 @@ object EOpen(object filename, object mode_obj, object cleanup)
 	int i;
 	int mode;
 	cleanup_ptr cup;
+	struct stat st;
 
 	if (IS_ATOM(mode_obj))
 		RTFatal("open mode must be a sequence");
@@ -3726,6 +3758,12 @@ object EOpen(object filename, object mode_obj, object cleanup)
 		else {
 			user_file[i].fptr = fp;
 			user_file[i].mode = mode;
+			// a big buffer for plain files only: a terminal or a pipe
+			// keeps its usual buffering, so its output isn't held back
+			if ((mode & EF_WRITE) && fstat(ifileno(fp), &st) == 0 &&
+				(st.st_mode & S_IFMT) == S_IFREG) {
+				setvbuf(fp, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+			}
 			if (mode & EF_APPEND) {
 				// Ensure that 'append' mode is initially positioned at end of file.
 				fseek(fp, 0, SEEK_END);
@@ -3751,19 +3789,77 @@ object EOpen(object filename, object mode_obj, object cleanup)
 }
 
 
-object EGets(object file_no)
-/* reads a line of text from a file for the user (GETS) */
+static intptr_t read_line_bytes(IFILE f)
+/* reads the next line, with its '\n' if it has one, into line_buf.
+   returns the number of bytes, or -1 at end of file */
 {
-	long i, c;
-	long oldc;
-	IFILE f;
-	object_ptr line_ptr;
+#ifdef EUNIX
+	// getdelim() scans stdio's own buffer for the new line with memchr()
+	ssize_t n;
+
+	n = getdelim(&line_buf, &line_buf_size, '\n', f);
+	return (n <= 0) ? -1 : (intptr_t)n;
+#else
+	size_t n = 0;
+	int c;
+
+	while ((c = igetc(f)) != EOF) {
+		if (n == line_buf_size) {
+			line_buf_size = (line_buf_size == 0) ? 256 : 2 * line_buf_size;
+			line_buf = realloc(line_buf, line_buf_size);
+			if (line_buf == NULL)
+				SpaceMessage();
+		}
+		line_buf[n++] = (char)c;
+		if (c == '\n')
+			break;
+	}
+	return (n == 0) ? -1 : (intptr_t)n;
+#endif
+}
+
+static object read_line(IFILE f, int strip)
+/* the next line of f as an exactly sized sequence, or -1 at end of file.
+   when strip is TRUE the line ending is removed, otherwise the
+   line ends with a single '\n' just as gets() returns it */
+{
+	intptr_t n, len, i;
 	s1_ptr line;
-	object_ptr next_char_ptr;
-	object_ptr last_char_ptr;
-	int bufsize;
-	
-	bufsize = 134;	// Initial value. Assumes most line lengths are less than this.
+	object_ptr obj_ptr;
+	unsigned char *p;
+
+	n = read_line_bytes(f);
+	if (n < 0)
+		return ATOM_M1;
+
+	p = (unsigned char *)line_buf;
+	len = n;
+	if (p[len-1] == '\n') {
+		len--;
+#ifdef EUNIX
+		if (strip && len > 0 && p[len-1] == '\r')
+			len--;
+#endif
+	}
+	else if (p[len-1] == '\r') {
+		// a trailing CR at end of file ends the line
+		len--;
+	}
+
+	line = NewS1(strip ? len : len + 1);
+	obj_ptr = line->base;
+	for (i = 0; i < len; i++) {
+		*(++obj_ptr) = (object)p[i];
+	}
+	if (!strip)
+		*(++obj_ptr) = (object)'\n';
+	return MAKE_SEQ(line);
+}
+
+static IFILE read_file_ptr(object file_no)
+/* the FILE pointer to read from for file number file_no */
+{
+	IFILE f;
 
 	if (file_no == last_r_file_no)
 		f = last_r_file_ptr;
@@ -3779,6 +3875,29 @@ object EGets(object file_no)
 	if (current_screen != MAIN_SCREEN && might_go_screen(last_r_file_no))
 		MainScreen();
 
+	return f;
+}
+
+object EGets(object file_no)
+/* reads a line of text from a file for the user (GETS) */
+{
+	long i, c;
+	long oldc;
+	IFILE f;
+	object_ptr line_ptr;
+	s1_ptr line;
+	object_ptr next_char_ptr;
+	object_ptr last_char_ptr;
+	int bufsize;
+	
+	f = read_file_ptr(file_no);
+
+	if (!((f == stdin) && in_from_keyb)) {
+		return read_line(f, FALSE);
+	}
+
+	bufsize = 134;	// Initial value. Assumes most line lengths are less than this.
+
 	line = (s1_ptr)EMalloc(bufsize * sizeof(object) + sizeof( struct s1 ));
 	line_ptr = (object_ptr)(line + 1);
 	next_char_ptr = line_ptr - 1; // Point to the [-1] object.
@@ -3786,78 +3905,40 @@ object EGets(object file_no)
 	i = 0;
 	oldc = EOF;
 
-	if ((f == stdin) && in_from_keyb) {
+	while (1)
+	{
+		// Move to next location to receive the next input character.
+		next_char_ptr++;
+
+		if (next_char_ptr == last_char_ptr) {
+			// No room in current buffer, so expand it.
+			bufsize = 64;	// Expansions use this value.
+			i = last_char_ptr - line_ptr;
+			line = (s1_ptr)ERealloc((char *)line, (i + bufsize + 2) * sizeof(object) + sizeof( struct s1) );
+			line_ptr = (object_ptr)(line + 1);
+			next_char_ptr = line_ptr + i;
+			last_char_ptr = next_char_ptr + bufsize; // Leave room for final NL and NOVALUE
+		}
+		
+		/* read a character */
+		c = getKBchar();
+		if (c == EOF) {
+			break;
+		}
 
-		while (1)
-		{
-			// Move to next location to receive the next input character.
-			next_char_ptr++;
-	
-			if (next_char_ptr == last_char_ptr) {
-				// No room in current buffer, so expand it.
-				bufsize = 64;	// Expansions use this value.
-				i = last_char_ptr - line_ptr;
-				line = (s1_ptr)ERealloc((char *)line, (i + bufsize + 2) * sizeof(object) + sizeof( struct s1) );
-				line_ptr = (object_ptr)(line + 1);
-				next_char_ptr = line_ptr + i;
-				last_char_ptr = next_char_ptr + bufsize; // Leave room for final NL and NOVALUE
-			}
-			
-			/* read a character */
-			c = getKBchar();
-			if (c == EOF) {
-				break;
-			}
-	
-			// Save the current character.
-			oldc = c;
+		// Save the current character.
+		oldc = c;
+		
+		if (c == '\n') {
+			screen_col = 1;
+			break;
+		}
+					
 			
-			if (c == '\n') {
-				screen_col = 1;
-				break;
-			}
-						
-				
-			*next_char_ptr = c;
-
-		}	// end while
-	}
-	else {
-		do
-		{
-			// Move to next location to receive the next input character.
-			next_char_ptr++;
-
-			if (next_char_ptr == last_char_ptr) {
-				// No room in current buffer, so expand it.
-				bufsize = 64;	// Expansions use this value.
-				i = last_char_ptr - line_ptr;
-				line = (s1_ptr)ERealloc((char *)line, (i + bufsize + 2) * sizeof(object) + sizeof( struct s1 ) );
-				line_ptr = (object_ptr)(line + 1);
-				next_char_ptr = line_ptr + i;
-				last_char_ptr = next_char_ptr + bufsize;
-			}
+		*next_char_ptr = c;
 
-			/* read a character */
-			c = getc(f);
+	}	// end while
 
-			if (c == EOF) {
-				break;
-			}	
-			// Save the current character.
-			oldc = c;
-
-			if (c == '\n') {
-				break;
-			}
-
-			*next_char_ptr = c;
-
-		} while(TRUE);
-		
-	} // end if
-	
-	
 	if (oldc == EOF) {
 		// No input characters where actually read.
 		return (object)ATOM_M1;
@@ -3884,6 +3965,263 @@ object EGets(object file_no)
 
 }
 
+#define GETS_MANY_PREALLOC 1024
+
+static object read_line_batch(IFILE f, object file_no, intptr_t n)
+/* up to n lines from f, without their line endings */
+{
+	s1_ptr s;
+	object lines, line;
+
+	// room for the first lines up front, Append() grows it if need be
+	s = NewS1(n < GETS_MANY_PREALLOC ? n : GETS_MANY_PREALLOC);
+	s->postfill = s->length;
+	s->length = 0;
+	s->base[1] = NOVALUE;
+	lines = MAKE_SEQ(s);
+
+	while (n-- > 0) {
+		if ((f == stdin) && in_from_keyb) {
+			line = EGets(file_no);
+			if (IS_SEQUENCE(line)) {
+				// drop the '\n'
+				s = SEQ_PTR(line);
+				s->base[s->length] = NOVALUE;
+				s->length--;
+				s->postfill++;
+			}
+		}
+		else {
+			line = read_line(f, TRUE);
+		}
+		if (line == ATOM_M1)
+			break;
+		Append(&lines, lines, line);
+	}
+	return lines;
+}
+
+object EGetsMany(object x)
+/* x is {file number, n}. returns up to n lines, without their
+   line endings, in one sequence (M_GETS_MANY) */
+{
+	s1_ptr args;
+	IFILE f;
+	intptr_t n;
+
+	args = SEQ_PTR(x);
+	f = read_file_ptr(args->base[1]);
+	n = (intptr_t)get_pos_int("gets_many()", args->base[2]);
+
+	return read_line_batch(f, args->base[1], n);
+}
+
+/* A line stream reads a file that it opened itself, one batch of lines
+   at a time, so that however big the file is only one batch is ever in
+   memory. It is an atom whose cleanup record holds the file. */
+
+#define LINES_BUFFER_SIZE (1 << 20)
+
+struct line_stream {
+	struct cleanup cleanup;  // must be first - freed by cleanup_double()
+	IFILE f;
+	intptr_t batch;
+};
+
+static void line_stream_close(struct line_stream *ls)
+{
+	if (ls->f != NULL) {
+		iclose(ls->f);
+		ls->f = NULL;
+	}
+}
+
+static struct line_stream *get_line_stream(object x)
+{
+	cleanup_ptr cp = NULL;
+
+	if (IS_ATOM_DBL(x)) {
+		cp = DBL_PTR(x)->cleanup;
+		while (cp != NULL && cp->type != CLEAN_LINES) {
+			cp = cp->next;
+		}
+	}
+	if (cp == NULL)
+		RTFatal("a line stream from open_lines() was expected");
+	return (struct line_stream *)cp;
+}
+
+static void line_stream_clean(object x)
+{
+	line_stream_close(get_line_stream(x));
+}
+
+object LinesOpen(object x)
+/* x is {file name, lines per batch}. returns a new line stream,
+   or -1 if the file can't be opened (M_LINES_OPEN) */
+{
+	char cname[MAX_FILE_NAME+1];
+	s1_ptr args;
+	struct line_stream *ls;
+	IFILE f;
+	intptr_t batch;
+	object handle;
+
+	args = SEQ_PTR(x);
+	if (!IS_SEQUENCE(args->base[1]))
+		RTFatal("open_lines(): the file name must be a sequence");
+	batch = (intptr_t)get_pos_int("open_lines()", args->base[2]);
+	if (batch < 1)
+		RTFatal("open_lines(): the batch size must be at least 1");
+
+	if (SEQ_PTR(args->base[1])->length >= MAX_FILE_NAME)
+		return ATOM_M1;
+	MakeCString(cname, args->base[1], MAX_FILE_NAME+1);
+	f = iopen(cname, "r");
+	if (f == NULL)
+		return ATOM_M1;
+	// lines are read through one large buffer
+	setvbuf(f, NULL, _IOFBF, LINES_BUFFER_SIZE);
+#ifdef ELINUX
+	posix_fadvise(ifileno(f), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+	ls = (struct line_stream *)EMalloc(sizeof(struct line_stream));
+	ls->cleanup.type = CLEAN_LINES;
+	ls->cleanup.func.builtin = &line_stream_clean;
+	ls->cleanup.next = NULL;
+	ls->f = f;
+	ls->batch = batch;
+
+	handle = NewDouble((eudouble)0.0);
+	DBL_PTR(handle)->cleanup = (cleanup_ptr)ls;
+	return handle;
+}
+
+object LinesNext(object x)
+/* x is a line stream. returns its next batch of lines, which
+   is empty once the whole file has been read (M_LINES_NEXT) */
+{
+	struct line_stream *ls;
+	object lines;
+
+	ls = get_line_stream(x);
+	if (ls->f == NULL)
+		return MAKE_SEQ(NewS1(0));
+
+	lines = read_line_batch(ls->f, NOVALUE, ls->batch);
+	if (SEQ_PTR(lines)->length < ls->batch) {
+		// the file has been read, no need to keep it open
+		line_stream_close(ls);
+	}
+	return lines;
+}
+
+object LinesClose(object x)
+/* x is a line stream. closes its file (M_LINES_CLOSE) */
+{
+	line_stream_close(get_line_stream(x));
+	return ATOM_1;
+}
+
+#define GET_BYTES_CHUNK 65536
+
+static void expand_bytes(object_ptr dest, intptr_t n)
+/* the first n bytes at dest become n objects, in place. Working from
+   the end, each object only covers bytes that have already been done */
+{
+	unsigned char *bytes = (unsigned char *)dest;
+
+	while (n > 0) {
+		n--;
+		dest[n] = (object)bytes[n];
+	}
+}
+
+object EGetBytes(object x)
+/* x is {file number, n}. reads up to n bytes from a file for the user,
+   or the rest of the file when n is negative (M_GET_BYTES) */
+{
+	s1_ptr args;
+	IFILE f;
+	object file_no, n_obj;
+	s1_ptr line;
+	object_ptr data;
+	intptr_t n, len, cap, want, got;
+	int c;
+	struct stat st;
+
+	args = SEQ_PTR(x);
+	file_no = args->base[1];
+	n_obj = args->base[2];
+
+	if (IS_ATOM_INT(n_obj))
+		n = n_obj;
+	else if (IS_ATOM_DBL(n_obj))
+		n = (DBL_PTR(n_obj)->dbl > (eudouble)MAXINT) ? MAXINT : (intptr_t)DBL_PTR(n_obj)->dbl;
+	else
+		RTFatal("get_bytes(): the number of bytes must be an atom");
+	if (n < 0)
+		n = MAXINT;
+	if (n == 0)
+		return MAKE_SEQ(NewS1(0));
+
+	f = read_file_ptr(file_no);
+
+	// For a plain file the size is a good guess at how much there is to read.
+	// Anything else starts small and grows.
+	cap = GET_BYTES_CHUNK;
+	if (fstat(ifileno(f), &st) == 0 && (st.st_mode & S_IFMT) == S_IFREG
+		&& st.st_size > 0 && (uintptr_t)st.st_size < MAX_SEQ_LEN) {
+		cap = (intptr_t)st.st_size;
+	}
+	if (cap > n)
+		cap = n;
+
+	line = (s1_ptr)EMalloc((cap + 1) * sizeof(object) + sizeof(struct s1));
+	data = (object_ptr)(line + 1);
+	len = 0;
+
+	if ((f == stdin) && in_from_keyb) {
+		while (len < n) {
+			if (len == cap) {
+				cap = (cap > n - cap) ? n : 2 * cap;
+				line = (s1_ptr)ERealloc((char *)line, (cap + 1) * sizeof(object) + sizeof(struct s1));
+				data = (object_ptr)(line + 1);
+			}
+			c = getKBchar();
+			if (c == EOF)
+				break;
+			data[len++] = c;
+		}
+	}
+	else {
+		while (len < n) {
+			if (len == cap) {
+				cap = (cap > n - cap) ? n : 2 * cap;
+				line = (s1_ptr)ERealloc((char *)line, (cap + 1) * sizeof(object) + sizeof(struct s1));
+				data = (object_ptr)(line + 1);
+			}
+			// read the bytes straight into the unused end of the sequence
+			want = cap - len;
+			got = (intptr_t)iread((char *)(data + len), 1, want, f);
+			expand_bytes(data + len, got);
+			len += got;
+			if (got < want)
+				break;
+		}
+	}
+
+	if (len == 0) {
+		EFree((char *)line);
+		return MAKE_SEQ(NewS1(0));
+	}
+	if (len < cap) {
+		line = (s1_ptr)ERealloc((char *)line, (len + 1) * sizeof(object) + sizeof(struct s1));
+	}
+	return NewPreallocSeq(len + 1, line);
+}
+
 void set_text_color(int c)
 /* set the foreground color for color displays
    or just set to white for mono displays */
@@ -4159,13 +4497,99 @@ void StdPrint(object fn, object a, int new_lines)
 		screen_output(print_file, "\n");
 }
 
+#define OUTPUT_DIRECT (4 * OUTPUT_BUFFER_SIZE)  // bigger writes bypass stdio
+#define OUTPUT_IOV 16          // chunks passed to each writev()
+
+static intptr_t sequence_bytes(char *out, object_ptr elem, intptr_t n)
+/* copies the next n elements after elem into out as bytes */
+{
+	intptr_t i;
+	object x;
+
+	for (i = 0; i < n; i++) {
+		x = *(++elem);
+		out[i] = IS_ATOM_INT(x) ? (char)INT_VAL(x) : doChar(x);
+	}
+	return n;
+}
+
+#ifdef EUNIX
+static void write_direct(IFILE f, object_ptr elem, intptr_t len)
+/* writes a long sequence of bytes straight to f's file descriptor,
+   OUTPUT_IOV chunks at a time with writev() */
+{
+	static char *chunks = NULL;
+	struct iovec iov[OUTPUT_IOV];
+	int fd, count, first;
+	intptr_t n;
+	ssize_t done;
+
+	if (chunks == NULL)
+		chunks = EMalloc(OUTPUT_IOV * OUTPUT_CHUNK);
+
+	// anything already in stdio's buffer goes first
+	iflush(f);
+	fd = ifileno(f);
+
+	while (len > 0) {
+		for (count = 0; count < OUTPUT_IOV && len > 0; count++) {
+			n = (len < OUTPUT_CHUNK) ? len : OUTPUT_CHUNK;
+			iov[count].iov_base = chunks + count * OUTPUT_CHUNK;
+			iov[count].iov_len = sequence_bytes(iov[count].iov_base, elem, n);
+			elem += n;
+			len -= n;
+		}
+		first = 0;
+		while (first < count) {
+			done = writev(fd, iov + first, count - first);
+			if (done < 0) {
+				if (errno == EINTR)
+					continue;
+				return;  // like fwrite(), errors are not reported
+			}
+			// skip whatever was written, which may end mid-chunk
+			while (first < count && (size_t)done >= iov[first].iov_len) {
+				done -= iov[first].iov_len;
+				first++;
+			}
+			if (first < count) {
+				iov[first].iov_base = (char *)iov[first].iov_base + done;
+				iov[first].iov_len -= done;
+			}
+		}
+	}
+
+	// let stdio know where the file position is now
+	iseek(f, 0, SEEK_CUR);
+}
+#endif
+
+static void write_bytes(IFILE f, object_ptr elem, intptr_t len)
+/* writes the len elements after elem to file f as bytes */
+{
+	intptr_t n;
+
+#ifdef EUNIX
+	if (len >= OUTPUT_DIRECT) {
+		write_direct(f, elem, len);
+		return;
+	}
+#endif
+	while (len > 0) {
+		n = (len < OUTPUT_CHUNK) ? len : OUTPUT_CHUNK;
+		iwrite(output_bytes, sequence_bytes(output_bytes, elem, n), 1, f);  /* allow for 0's */
+		elem += n;
+		len -= n;
+	}
+}
+
 void EPuts(object file_no, object obj)
 /* print out a string of characters */
 {
 	object_ptr elem;
 	char *out_ptr;
 	long n;
-	int c, size;
+	int c;
 	long len;
 	IFILE f;
 
@@ -4181,7 +4605,7 @@ void EPuts(object file_no, object obj)
 	}
 	if (IS_ATOM(obj)) {
 		c = Char(obj);
-		if (f == stdout || f == stderr || f == NULL) {
+		if (output_to_screen(f)) {
 			/* might be going to screen, won't be binary mode */
 			TempBuff[0] = c;
 			TempBuff[1] = '\0';
@@ -4198,41 +4622,258 @@ void EPuts(object file_no, object obj)
 		obj = (object)SEQ_PTR(obj);
 		elem = ((s1_ptr)obj)->base;
 		len = ((s1_ptr)obj)->length;
+		if (!output_to_screen(f)) {
+			// a file, or redirected output: the bytes go straight to stdio
+			if (current_screen != MAIN_SCREEN && might_go_screen(file_no))
+				MainScreen();
+			write_bytes(f, elem, len);
+			return;
+		}
 		while (len > 0) {
 			n = len;
 			if (n >= TEMP_SIZE)
 				n = TEMP_SIZE - 1; /* need space for 0 */
 			len = len - n;
 			out_ptr = TempBuff;
-			size = n;
 			do {
 				elem++;
 				*out_ptr++ = Char(*elem);
 			} while (--n > 0);
-			if (f == stdout || f == stderr || f == NULL) {
-				*out_ptr = '\0';
-				screen_output(f, TempBuff);
-			}
-			else {
-				if (current_screen != MAIN_SCREEN && might_go_screen(file_no))
-					MainScreen();
-				iwrite(TempBuff, size, 1, f);  /* allow for 0's */
-			}
+			*out_ptr = '\0';
+			screen_output(f, TempBuff);
 		}
 	}
 }
 
 
-static object_ptr FormatItem(f, cstring, f_elem, f_last, v_elem)
-/* print one format item from printf */
-IFILE f;
-char *cstring;
-object_ptr f_elem;
-object_ptr f_last;
-object_ptr v_elem;
+#define IO_READ_MAX (1 << 22)  // most bytes io_read() asks for at once
+
+#ifdef EUNIX
+#define IO_SPLICE_CHUNK (1 << 16)  // bytes moved at a time by io_splice()
+
+#if defined(ELINUX) && !defined(SPLICE_F_MOVE)
+// glibc only declares splice() for _GNU_SOURCE, so it is called directly
+#define SPLICE_F_MOVE 1
+#define SPLICE_F_MORE 4
+#define splice(fd_in, off_in, fd_out, off_out, len, flags) \
+	syscall(SYS_splice, fd_in, off_in, fd_out, off_out, len, flags)
+#endif
+
+#define IO_BUFFER_KEEP (4 * IO_READ_MAX)  // bigger buffers aren't kept
+
+static char *io_buffer_for(intptr_t n)
+/* a byte buffer of at least n bytes, reused from call to call */
 {
-	int flen, sbuff_len=0;
-	char c;
+	if (n <= OUTPUT_CHUNK)
+		return output_bytes;
+	if (n > io_buffer_size) {
+		if (io_buffer != NULL)
+			EFree(io_buffer);
+		io_buffer = EMalloc(n);
+		io_buffer_size = n;
+	}
+	return io_buffer;
+}
+
+static void io_buffer_done()
+/* after a call that used io_buffer_for(): one huge io_write() mustn't
+   leave a buffer its size behind for the rest of the run */
+{
+	if (io_buffer_size > IO_BUFFER_KEEP) {
+		EFree(io_buffer);
+		io_buffer = NULL;
+		io_buffer_size = 0;
+	}
+}
+
+static object byte_total(int64_t total)
+/* a count of bytes moved, which may not fit in an integer */
+{
+	if (total <= MAXINT)
+		return MAKE_INT((intptr_t)total);
+	return NewDouble((eudouble)total);
+}
+#endif
+
+object EReadFd(object x)
+/* x is {fd, n}. one read(2) of up to n bytes from a file descriptor.
+   returns the bytes, {} at end of file, or -1 on error (M_IO_READ) */
+{
+#ifdef EUNIX
+	s1_ptr args, result;
+	object_ptr elem;
+	char *buff;
+	int fd;
+	intptr_t n, i;
+	ssize_t got;
+
+	args = SEQ_PTR(x);
+	fd = (int)get_pos_int("io_read", args->base[1]);
+	n = (intptr_t)get_pos_int("io_read", args->base[2]);
+	if (n > IO_READ_MAX)
+		n = IO_READ_MAX;
+
+	// pipes often return less than was asked for, so read into the
+	// reusable buffer and size the sequence for what actually came
+	buff = io_buffer_for(n);
+	do {
+		got = read(fd, buff, n);
+	} while (got < 0 && errno == EINTR);
+	if (got < 0)
+		return ATOM_M1;
+	result = NewS1(got);
+	elem = result->base;
+	for (i = 0; i < got; i++) {
+		*(++elem) = (unsigned char)buff[i];
+	}
+	return MAKE_SEQ(result);
+#else
+	UNUSED(x);
+	RTFatal("io_read is not supported on this platform");
+	return ATOM_M1;
+#endif
+}
+
+object EWriteFd(object x)
+/* x is {fd, bytes}. one write(2) to a file descriptor. returns the
+   number of bytes written, or -1 on error (M_IO_WRITE) */
+{
+#ifdef EUNIX
+	s1_ptr args, s;
+	int fd;
+	intptr_t n;
+	ssize_t done;
+	char *buff;
+
+	args = SEQ_PTR(x);
+	fd = (int)get_pos_int("io_write", args->base[1]);
+	if (IS_ATOM(args->base[2])) {
+		output_bytes[0] = Char(args->base[2]);
+		buff = output_bytes;
+		n = 1;
+	}
+	else {
+		s = SEQ_PTR(args->base[2]);
+		n = s->length;
+		buff = io_buffer_for(n);
+		sequence_bytes(buff, s->base, n);
+	}
+	do {
+		done = write(fd, buff, n);
+	} while (done < 0 && errno == EINTR);
+	io_buffer_done();
+	if (done < 0)
+		return ATOM_M1;
+	return MAKE_INT(done);
+#else
+	UNUSED(x);
+	RTFatal("io_write is not supported on this platform");
+	return ATOM_M1;
+#endif
+}
+
+#ifdef EUNIX
+static int64_t copy_fd(int fd_in, int fd_out, intptr_t n)
+/* move up to n bytes (all of them if n < 0) from fd_in to fd_out through
+   the reusable buffer. returns the number moved, or -1 if nothing could be */
+{
+	char *buff;
+	int64_t total;
+	intptr_t want;
+	ssize_t got, done, put;
+
+	buff = io_buffer_for(IO_SPLICE_CHUNK);
+	total = 0;
+	while (n < 0 || total < n) {
+		want = (n < 0 || n - total > IO_SPLICE_CHUNK) ? IO_SPLICE_CHUNK : (intptr_t)(n - total);
+		do {
+			got = read(fd_in, buff, want);
+		} while (got < 0 && errno == EINTR);
+		if (got <= 0)
+			return (got < 0 && total == 0) ? -1 : total;
+		for (done = 0; done < got; done += put) {
+			do {
+				put = write(fd_out, buff + done, got - done);
+			} while (put < 0 && errno == EINTR);
+			if (put < 0)
+				return (total + done == 0) ? -1 : total + done;
+		}
+		total += got;
+	}
+	return total;
+}
+#endif
+
+object ESpliceFd(object x)
+/* x is {fd_in, fd_out, n}. moves up to n bytes (all of them, up to the end
+   of file, if n is negative) from one file descriptor to the other without
+   making Euphoria sequences of them. On Linux, when either end is a pipe,
+   splice(2) moves the data inside the kernel. returns the number of bytes
+   moved, or -1 on error (M_IO_SPLICE) */
+{
+#ifdef EUNIX
+	s1_ptr args;
+	int fd_in, fd_out;
+	intptr_t n;
+	int64_t copied;
+	eudouble d;
+#ifdef ELINUX
+	int64_t total;  // can pass MAXINT on a 32-bit build when n is -1
+	intptr_t want;
+	ssize_t moved;
+#endif
+
+	args = SEQ_PTR(x);
+	fd_in = (int)get_pos_int("io_splice", args->base[1]);
+	fd_out = (int)get_pos_int("io_splice", args->base[2]);
+	if (IS_ATOM_INT(args->base[3]))
+		n = INT_VAL(args->base[3]);
+	else if (IS_ATOM_DBL(args->base[3])) {
+		d = DBL_PTR(args->base[3])->dbl;
+		n = (d < 0.0) ? -1 : (d > (eudouble)MAXINT) ? MAXINT : (intptr_t)d;
+	}
+	else {
+		RTFatal("io_splice: the byte count must be an atom");
+	}
+	if (n < 0)
+		n = -1;
+
+#ifdef ELINUX
+	total = 0;
+	while (n < 0 || total < n) {
+		want = (n < 0 || n - total > IO_READ_MAX) ? IO_READ_MAX : (intptr_t)(n - total);
+		do {
+			moved = splice(fd_in, NULL, fd_out, NULL, (size_t)want,
+						   SPLICE_F_MOVE | SPLICE_F_MORE);
+		} while (moved < 0 && errno == EINTR);
+		if (moved == 0)
+			return byte_total(total);  // end of file
+		if (moved < 0) {
+			if (errno == EINVAL && total == 0)
+				break;  // neither end is a pipe - copy it instead
+			return (total == 0) ? ATOM_M1 : byte_total(total);
+		}
+		total += moved;
+	}
+	if (total > 0)
+		return byte_total(total);
+#endif
+	copied = copy_fd(fd_in, fd_out, n);
+	return (copied < 0) ? ATOM_M1 : byte_total(copied);
+#else
+	UNUSED(x);
+	RTFatal("io_splice is not supported on this platform");
+	return ATOM_M1;
+#endif
+}
+
+
+static void FormatValue(IFILE f, char *cstring, int flen, char c, object_ptr v_elem)
+/* print one value for a format item. cstring holds the flen characters
+   of the item before the conversion character c, and must have room for
+   a few more */
+{
+	int sbuff_len=0;
 	intptr_t dval;
 	uintptr_t uval;
 	eudouble gval;
@@ -4243,17 +4884,6 @@ object_ptr v_elem;
 	int free_sv;
 	int free_sb;
 
-	c = '%';
-	flen = 0;
-	do {
-		cstring[flen++] = c;
-		if (++f_elem > f_last) {
-			cstring[flen] = '\0';
-			RTFatal("format specifier is incomplete (%s)", cstring);
-		}
-		c = Char(*f_elem);
-	} while (IsDigit(c) || c == '.' || c == '-' || c == '+');
-
 	free_sb = FALSE;
 	if (c == 's') {
 		int len_used;
@@ -4378,10 +5008,285 @@ object_ptr v_elem;
 	}
 	if (free_sb)
 		EFree(sbuff);
+}
+
+static object_ptr FormatItem(f, cstring, f_elem, f_last, v_elem)
+/* print one format item from printf */
+IFILE f;
+char *cstring;
+object_ptr f_elem;
+object_ptr f_last;
+object_ptr v_elem;
+{
+	int flen;
+	char c;
+
+	c = '%';
+	flen = 0;
+	do {
+		cstring[flen++] = c;
+		if (++f_elem > f_last) {
+			cstring[flen] = '\0';
+			RTFatal("format specifier is incomplete (%s)", cstring);
+		}
+		c = Char(*f_elem);
+	} while (IsDigit(c) || c == '.' || c == '-' || c == '+');
+
+	FormatValue(f, cstring, flen, c, v_elem);
 	return(f_elem);
 }
 
 
+/* Compiled printf() formats.
+   Programs tend to use the same few literal formats over and over, so the
+   second time a format sequence is seen it is compiled into a list of
+   literal text and format items, which is kept in a small cache keyed on
+   the sequence. A cached program is only used while the sequence still
+   holds exactly the characters it was compiled from. Plain %d of an
+   integer and plain %s are written out directly, without snprintf(). */
+
+#define FORMAT_MAX_LENGTH 1024 // longer formats are not compiled
+
+enum format_op_kinds {
+	FMT_TEXT,  // literal text
+	FMT_ITEM,  // general format item
+	FMT_INT,   // plain %d
+	FMT_STR    // plain %s
+};
+
+struct format_op {
+	int kind;
+	char conv;   // conversion character of a format item
+	int flen;    // length of str, for a format item
+	char *str;   // the text, or the format item up to the conversion
+};
+
+struct format_program {
+	s1_ptr key;           // the format sequence this was compiled from
+	intptr_t length;
+	object *chars;        // its elements, to check that it hasn't changed
+	int nops;
+	struct format_op *ops;
+};
+
+static struct format_program *format_compile(s1_ptr format)
+/* compile format, or return NULL if it has anything unusual in it.
+   Those formats are left to EPrintf(), which also reports any errors */
+{
+	struct format_program *prog;
+	object_ptr fp;
+	char *strings;
+	intptr_t len, i, j;
+	int c, n;
+
+	len = format->length;
+	fp = format->base;
+	for (i = 1; i <= len; i++) {
+		if (!IS_ATOM_INT(fp[i]) || fp[i] < 1 || fp[i] > 255)
+			return NULL; // 0 ends the text early in screen_output()
+	}
+
+	prog = (struct format_program *)EMalloc(sizeof(struct format_program) +
+											len * sizeof(object) +
+											(len + 1) * sizeof(struct format_op) +
+											2 * len + 2);
+	prog->key = format;
+	prog->length = len;
+	prog->chars = (object *)(prog + 1);
+	memcpy(prog->chars, fp + 1, len * sizeof(object));
+	prog->ops = (struct format_op *)(prog->chars + len);
+	strings = (char *)(prog->ops + len + 1);
+	prog->nops = 0;
+
+	i = 1;
+	while (i <= len) {
+		n = prog->nops;
+		c = (int)fp[i];
+		if (c != '%' || (i < len && fp[i+1] == '%')) {
+			if (n == 0 || prog->ops[n-1].kind != FMT_TEXT) {
+				prog->ops[n].kind = FMT_TEXT;
+				prog->ops[n].str = strings;
+				prog->nops++;
+			}
+			else {
+				strings--; // append to the previous text
+			}
+			*strings++ = (char)c;
+			*strings++ = '\0';
+			i += (c == '%') ? 2 : 1;
+			continue;
+		}
+
+		j = i;
+		do {
+			if (++j > len) {
+				EFree((char *)prog);
+				return NULL;
+			}
+			c = (int)fp[j];
+		} while (IsDigit(c) || c == '.' || c == '-' || c == '+');
+		if (strchr("sdxoefg", c) == NULL || j - i > LOCAL_SPACE - 8) {
+			EFree((char *)prog);
+			return NULL;
+		}
+
+		prog->ops[n].kind = FMT_ITEM;
+		prog->ops[n].conv = (char)c;
+		prog->ops[n].flen = (int)(j - i);
+		prog->ops[n].str = strings;
+		for (; i < j; i++) {
+			*strings++ = (char)fp[i];
+		}
+		*strings++ = '\0';
+		if (prog->ops[n].flen == 1 && c == 'd')
+			prog->ops[n].kind = FMT_INT;
+		else if (prog->ops[n].flen == 1 && c == 's')
+			prog->ops[n].kind = FMT_STR;
+		prog->nops++;
+		i = j + 1;
+	}
+	return prog;
+}
+
+static struct format_program *format_lookup(s1_ptr format)
+/* the compiled program for format, or NULL */
+{
+	int slot;
+	struct format_program *prog;
+
+	slot = (int)(((uintptr_t)format >> 4) & (FORMAT_CACHE_SIZE - 1));
+	prog = format_cache[slot].prog;
+	if (prog != NULL && prog->key == format && prog->length == format->length &&
+		memcmp(prog->chars, format->base + 1, format->length * sizeof(object)) == 0)
+		return prog;
+
+	if (format_cache[slot].seen != format || format->length > FORMAT_MAX_LENGTH ||
+		format_cache[slot].rejected == format) {
+		format_cache[slot].seen = format;
+		return NULL;
+	}
+
+	// seen before - worth compiling
+	prog = format_compile(format);
+	if (prog == NULL) {
+		format_cache[slot].rejected = format;
+		return NULL;
+	}
+	if (format_cache[slot].prog != NULL)
+		EFree((char *)format_cache[slot].prog);
+	format_cache[slot].prog = prog;
+	return prog;
+}
+
+void FreeRuntimeBuffers()
+/* releases the current context's line buffer, I/O buffer and compiled
+   formats, before its storage cache goes */
+{
+	int i;
+
+	if (line_buf != NULL) {
+		free(line_buf);  // grown by getdelim() or realloc()
+		line_buf = NULL;
+		line_buf_size = 0;
+	}
+	if (io_buffer != NULL) {
+		EFree(io_buffer);
+		io_buffer = NULL;
+		io_buffer_size = 0;
+	}
+	for (i = 0; i < FORMAT_CACHE_SIZE; i++) {
+		if (format_cache[i].prog != NULL)
+			EFree((char *)format_cache[i].prog);
+		format_cache[i].prog = NULL;
+		format_cache[i].seen = NULL;
+		format_cache[i].rejected = NULL;
+	}
+}
+
+static void format_int(IFILE f, intptr_t val)
+/* same as %d, without going through snprintf() */
+{
+	char buff[NUM_SIZE];
+	char *p;
+	uintptr_t u;
+
+	p = buff + NUM_SIZE - 1;
+	*p = '\0';
+	u = (val < 0) ? -(uintptr_t)val : (uintptr_t)val;
+	do {
+		*--p = (char)('0' + u % 10);
+		u /= 10;
+	} while (u != 0);
+	if (val < 0)
+		*--p = '-';
+	screen_output(f, p);
+}
+
+static void format_str(IFILE f, object val)
+/* same as %s, without going through snprintf() */
+{
+	char quick_alloc[LOCAL_SPACE];
+	char *sval;
+	int slength;
+
+	if (IS_SEQUENCE(val)) {
+		slength = SEQ_PTR(val)->length + 1;
+		sval = (slength > LOCAL_SPACE) ? EMalloc(slength) : quick_alloc;
+		MakeCString(sval, val, slength > LOCAL_SPACE ? slength : LOCAL_SPACE);
+		screen_output(f, sval);
+		if (sval != quick_alloc)
+			EFree(sval);
+	}
+	else {
+		quick_alloc[0] = Char(val);
+		quick_alloc[1] = '\0';
+		screen_output(f, quick_alloc);
+	}
+}
+
+static void format_run(IFILE f, struct format_program *prog, object file_no, object values)
+/* print values using a compiled format */
+{
+	struct format_op *op, *last;
+	object_ptr v_elem, v_last;
+	char cstring[LOCAL_SPACE];
+
+	if (IS_ATOM(values)) {
+		v_elem = &values;
+		v_last = v_elem;
+	}
+	else {
+		v_elem = SEQ_PTR(values)->base;
+		v_last = v_elem + SEQ_PTR(values)->length;
+		v_elem++;
+	}
+	last = prog->ops + prog->nops;
+	for (op = prog->ops; op < last; op++) {
+		if (op->kind == FMT_TEXT) {
+			screen_output(f, op->str);
+			continue;
+		}
+		if (v_elem > v_last) {
+			if (file_no == DOING_SPRINTF)
+				RTFatal("not enough values to print in sprintf()");
+			else
+				RTFatal("not enough values to print in printf()");
+		}
+		if (op->kind == FMT_INT && IS_ATOM_INT(*v_elem)) {
+			format_int(f, INT_VAL(*v_elem));
+		}
+		else if (op->kind == FMT_STR) {
+			format_str(f, *v_elem);
+		}
+		else {
+			memcpy(cstring, op->str, op->flen);
+			FormatValue(f, cstring, op->flen, op->conv, v_elem);
+		}
+		if (IS_SEQUENCE(values))
+			v_elem++;
+	}
+}
+
 object EPrintf(object file_no, object format_obj, object values)
 /* formatted print */
 /* file_no could be DOING_SPRINTF (for sprintf) */
@@ -4398,6 +5303,7 @@ object EPrintf(object file_no, object format_obj, object values)
 	IFILE f;
 	object result;
 	s1_ptr format;
+	struct format_program *prog;
 
 	if (file_no == DOING_SPRINTF) {
 		f = (IFILE )DOING_SPRINTF;
@@ -4427,6 +5333,9 @@ object EPrintf(object file_no, object format_obj, object values)
 		if (flen == 0) {
 			screen_output(f, "");
 		}
+		else if ((prog = format_lookup(format)) != NULL) {
+			format_run(f, prog, file_no, values);
+		}
 		else {
 			f_elem = format->base;
 			f_last = f_elem + flen;
@@ -4956,6 +5865,160 @@ char **make_arg_cv(char *cmdline, int *argc)
 }
 
 
+#ifdef EUNIX
+extern char **environ;
+
+static int shell_command(char *command)
+/* like system(), but the shell is started with posix_spawn(), which
+   doesn't have to copy the page tables of a large interpreter process the
+   way fork() does. returns the shell's wait status, or -1 */
+{
+	pid_t pid;
+	int status;
+	char *argv[4];
+	posix_spawnattr_t attr;
+	sigset_t defaults;
+	struct sigaction ignore, old_int, old_quit;
+
+	argv[0] = "sh";
+	argv[1] = "-c";
+	argv[2] = command;
+	argv[3] = NULL;
+
+	// as system() does, the shell gets ^C while we wait for it
+	ignore.sa_handler = SIG_IGN;
+	sigemptyset(&ignore.sa_mask);
+	ignore.sa_flags = 0;
+	sigaction(SIGINT, &ignore, &old_int);
+	sigaction(SIGQUIT, &ignore, &old_quit);
+
+	posix_spawnattr_init(&attr);
+	sigemptyset(&defaults);
+	sigaddset(&defaults, SIGINT);
+	sigaddset(&defaults, SIGQUIT);
+	posix_spawnattr_setsigdefault(&attr, &defaults);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
+
+	if (posix_spawn(&pid, "/bin/sh", NULL, &attr, argv, environ) != 0) {
+		status = -1;
+	}
+	else {
+		while (waitpid(pid, &status, 0) == -1) {
+			if (errno != EINTR) {
+				status = -1;
+				break;
+			}
+		}
+	}
+	posix_spawnattr_destroy(&attr);
+
+	sigaction(SIGINT, &old_int, NULL);
+	sigaction(SIGQUIT, &old_quit, NULL);
+	return status;
+}
+
+static char *spawn_string(object x, char *where)
+/* a C copy of a Euphoria string, to be EFree'd */
+{
+	char *str;
+	intptr_t len;
+
+	if (!IS_SEQUENCE(x))
+		RTFatal("%s: a string was expected", where);
+	len = SEQ_PTR(x)->length + 1;
+	str = EMalloc(len);
+	MakeCString(str, x, len);
+	return str;
+}
+#endif
+
+object ESpawn(object x)
+/* x is {path, args, fds, closing}. starts the program at path with the
+   arguments args (a sequence of strings, not including the program name),
+   with its standard input, output and error connected to the three file
+   descriptors fds. the descriptors in closing are closed in the child.
+   returns the process id, or -1 (M_SPAWN) */
+{
+#ifdef EUNIX
+	s1_ptr args, list, fds, closing;
+	char *path;
+	char **argv;
+	posix_spawn_file_actions_t actions;
+	posix_spawnattr_t attr;
+	sigset_t defaults;
+	pid_t pid;
+	intptr_t i;
+	int r, std_fd[3];
+
+	args = SEQ_PTR(x);
+	if (!IS_SEQUENCE(args->base[2]) || !IS_SEQUENCE(args->base[3]) ||
+		!IS_SEQUENCE(args->base[4]))
+		RTFatal("spawn: the arguments, handles and handles to close must be sequences");
+	list = SEQ_PTR(args->base[2]);
+	fds = SEQ_PTR(args->base[3]);
+	closing = SEQ_PTR(args->base[4]);
+	if (fds->length != 3)
+		RTFatal("spawn: three handles were expected");
+
+	path = spawn_string(args->base[1], "spawn");
+	argv = (char **)EMalloc((list->length + 2) * sizeof(char *));
+	argv[0] = path;
+	for (i = 1; i <= list->length; i++) {
+		argv[i] = spawn_string(list->base[i], "spawn");
+	}
+	argv[list->length + 1] = NULL;
+
+	posix_spawn_file_actions_init(&actions);
+	for (i = 1; i <= closing->length; i++) {
+		posix_spawn_file_actions_addclose(&actions, (int)get_pos_int("spawn", closing->base[i]));
+	}
+	for (i = 1; i <= 3; i++) {
+		std_fd[i - 1] = (int)get_pos_int("spawn", fds->base[i]);
+		if (std_fd[i - 1] != i - 1)
+			posix_spawn_file_actions_adddup2(&actions, std_fd[i - 1], (int)(i - 1));
+	}
+	for (i = 0; i < 3; i++) {
+		// once each, and only after all the dup2's
+		if (std_fd[i] > 2 && (i == 0 || std_fd[i] != std_fd[0]) &&
+			(i != 2 || std_fd[2] != std_fd[1]))
+			posix_spawn_file_actions_addclose(&actions, std_fd[i]);
+	}
+
+	// the child shouldn't inherit ignored signals, such as SIGTERM for kill()
+	posix_spawnattr_init(&attr);
+	sigemptyset(&defaults);
+	sigaddset(&defaults, SIGTERM);
+	sigaddset(&defaults, SIGINT);
+	sigaddset(&defaults, SIGQUIT);
+	sigaddset(&defaults, SIGHUP);
+	sigaddset(&defaults, SIGPIPE);
+	posix_spawnattr_setsigdefault(&attr, &defaults);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGDEF);
+
+	r = posix_spawn(&pid, path, &actions, &attr, argv, environ);
+
+	posix_spawnattr_destroy(&attr);
+	posix_spawn_file_actions_destroy(&actions);
+	for (i = 0; i <= list->length; i++) {
+		EFree(argv[i]);
+	}
+	EFree((char *)argv);
+
+	if (r != 0) {
+		errno = r;
+		return ATOM_M1;
+	}
+	if (pid > MAXINT)
+		return NewDouble((eudouble)pid);
+	return MAKE_INT(pid);
+#else
+	UNUSED(x);
+	RTFatal("spawn is not supported on this platform");
+	return ATOM_M1;
+#endif
+}
+
+
 void system_call(object command, object wait)
 /* Open a new shell. Run a command, then restore the graphics mode.
    Will wait for user to hit key if desired */
@@ -4986,7 +6049,11 @@ void system_call(object command, object wait)
 	}
 
 	MakeCString(string_ptr, command, len_used);
+#ifdef EUNIX
+	shell_command(string_ptr);
+#else
 	system(string_ptr);
+#endif
 	if (len > TEMP_SIZE)
 		EFree(string_ptr);
 
@@ -5036,7 +6103,7 @@ object system_exec_call(object command, object wait)
 
 #ifdef EUNIX
 	// this runs the shell - not really supposed to, but it gets exit code
-	exit_code = system(string_ptr);
+	exit_code = shell_command(string_ptr);
 #else
 	argv = make_arg_cv(string_ptr, &exit_code);
 	exit_code = spawnvp(P_WAIT, argv[0], (char * const *)argv);
@@ -5238,6 +6305,7 @@ uintptr_t general_call_back(
 #else
 	object *code[4+9]; // place to put IL: max 9 args
 	object *save_tpc;
+	struct stack_segment *seg;
 #endif
 
 	if (gameover)
@@ -5398,8 +6466,13 @@ uintptr_t general_call_back(
 	code[num_args+2] = (object *)call_back_result;
 	code[num_args+3] = (object *)opcode(CALL_BACK_RETURN);
 
+	if (expr_top >= expr_limit) {
+		expr_max = BiggerStack();
+		expr_limit = expr_max - 3;
+	}
 	*expr_top++ = (object)tpc;    // needed for traceback
 	*expr_top++ = (object)NULL;   // prevents restore_privates()
+	seg = expr_segment;
 
 	// Save the tpc value across do_exec. Sometimes Windows
 	// makes two or more call-backs in a row without returning
@@ -5409,7 +6482,7 @@ uintptr_t general_call_back(
 	do_exec((intptr_t *)code);  // execute routine without setting up new stack
 
 	tpc = save_tpc;
-	expr_top -= 2;
+	pop_call_back_frame(seg);
 #endif
 	// Don't do get_pos_int() for crash handler
 	if (crash_call_back) {
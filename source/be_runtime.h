@@ -119,6 +119,15 @@ int show_ascii_char(IFILE print_file, int iv);
 
 int get_key(int wait);
 object EGets(object file_no);
+object EGetBytes(object x);
+object EGetsMany(object x);
+object LinesOpen(object x);
+object LinesNext(object x);
+object LinesClose(object x);
+object EReadFd(object x);
+object EWriteFd(object x);
+object ESpliceFd(object x);
+object ESpawn(object x);
 void EClose(object a);
 int CheckFileNumber(object a);
 int NumberOpen();
@@ -222,6 +231,7 @@ object DRandom(d_ptr a);
 object e_floor(object a);  // not used anymore
 
 int memcopy( void *dest, size_t avail, void *src, size_t len);
+void FreeRuntimeBuffers();
 
 object eu_sizeof( object data_type );
 int getKBchar();
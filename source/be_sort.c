@@ -0,0 +1,358 @@
+/*****************************************************************************/
+/*      (c) Copyright - See License.txt       */
+/*****************************************************************************/
+/*                                                                           */
+/*                            Native Sorting                                 */
+/*                                                                           */
+/*****************************************************************************/
+
+/* A multi-threaded merge sort for sequences whose elements are all
+   integers, all doubles or all flat sequences of integers (strings).
+   For these kinds of elements compare() has no side effects, and elements
+   that compare as equal can't be told apart, so the result is the same as
+   the one given by sort() in std/sort.e.
+
+   The sequence is copied, the copy is split into one run per thread and
+   each run is merge sorted on its own.  The runs are then merged pairwise,
+   with every pairwise merge cut into independent pieces so that all
+   threads stay busy right up to the final merge.  The worker threads only
+   move element pointers around - reference counts are updated by the
+   calling thread before any work is handed out. */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "alldefs.h"
+#include "be_alloc.h"
+#include "be_runtime.h"
+#include "be_machine.h"
+#include "be_pool.h"
+#include "be_sort.h"
+
+#define SORT_INSERTION 24      // runs this short get an insertion sort
+#define SORT_MIN_CHUNK 8192    // don't split into runs shorter than this
+
+enum sort_kinds {
+	SORT_NONE,
+	SORT_INTS,
+	SORT_DBLS,
+	SORT_STRS
+};
+
+struct sort_ops {
+	void (*msort)(object_ptr a, object_ptr tmp, intptr_t n);
+	void (*merge)(object_ptr dst, object_ptr l, intptr_t nl, object_ptr r, intptr_t nr);
+	intptr_t (*lower_bound)(object_ptr a, intptr_t n, object key);
+};
+
+static int str_less(object a, object b)
+/* a < b for two sequences that contain only integers */
+{
+	s1_ptr sa, sb;
+	object_ptr ap, bp;
+	intptr_t n;
+
+	sa = SEQ_PTR(a);
+	sb = SEQ_PTR(b);
+	ap = sa->base;
+	bp = sb->base;
+	n = (sa->length < sb->length) ? sa->length : sb->length;
+	while (--n >= 0) {
+		ap++;
+		bp++;
+		if (*ap != *bp)
+			return *ap < *bp;
+	}
+	return sa->length < sb->length;
+}
+
+#define INT_LESS(a, b) ((a) < (b))
+#define DBL_LESS(a, b) (DBL_PTR(a)->dbl < DBL_PTR(b)->dbl)
+#define STR_LESS(a, b) str_less(a, b)
+
+/* Generates the stable merge sort primitives for one kind of element.
+   LESS(a, b) must be a strict weak ordering on that kind. */
+#define SORT_FUNCTIONS(kind, LESS) \
+ \
+static void kind##_insertion(object_ptr a, intptr_t n) \
+{ \
+	intptr_t i, j; \
+	object t; \
+ \
+	for (i = 1; i < n; i++) { \
+		t = a[i]; \
+		for (j = i; j > 0 && LESS(t, a[j-1]); j--) \
+			a[j] = a[j-1]; \
+		a[j] = t; \
+	} \
+} \
+ \
+static void kind##_merge(object_ptr dst, object_ptr l, intptr_t nl, \
+						 object_ptr r, intptr_t nr) \
+{ \
+	object_ptr lstop = l + nl; \
+	object_ptr rstop = r + nr; \
+ \
+	while (l < lstop && r < rstop) { \
+		if (LESS(*r, *l)) \
+			*dst++ = *r++; \
+		else \
+			*dst++ = *l++; \
+	} \
+	while (l < lstop) \
+		*dst++ = *l++; \
+	while (r < rstop) \
+		*dst++ = *r++; \
+} \
+ \
+static void kind##_msort(object_ptr a, object_ptr tmp, intptr_t n) \
+{ \
+	intptr_t h; \
+ \
+	if (n <= SORT_INSERTION) { \
+		kind##_insertion(a, n); \
+		return; \
+	} \
+	h = n / 2; \
+	kind##_msort(a, tmp, h); \
+	kind##_msort(a + h, tmp + h, n - h); \
+	if (!LESS(a[h], a[h-1])) \
+		return; /* already in order */ \
+	memcpy(tmp, a, h * sizeof(object)); \
+	kind##_merge(a, tmp, h, a + h, n - h); \
+} \
+ \
+static intptr_t kind##_lower_bound(object_ptr a, intptr_t n, object key) \
+{ \
+	intptr_t lo = 0, mid; \
+ \
+	while (lo < n) { \
+		mid = lo + (n - lo) / 2; \
+		if (LESS(a[mid], key)) \
+			lo = mid + 1; \
+		else \
+			n = mid; \
+	} \
+	return lo; \
+}
+
+SORT_FUNCTIONS(ints, INT_LESS)
+SORT_FUNCTIONS(dbls, DBL_LESS)
+SORT_FUNCTIONS(strs, STR_LESS)
+
+static struct sort_ops sort_table[] = {
+	{NULL, NULL, NULL},
+	{ints_msort, ints_merge, ints_lower_bound},
+	{dbls_msort, dbls_merge, dbls_lower_bound},
+	{strs_msort, strs_merge, strs_lower_bound}
+};
+
+/* one run to sort, or one piece of a pairwise merge */
+struct sort_job {
+	struct sort_ops *ops;
+	object_ptr dst;
+	object_ptr l;
+	intptr_t nl;
+	object_ptr r;
+	intptr_t nr;
+};
+
+static void sort_run_job(void *p)
+{
+	struct sort_job *job = (struct sort_job *)p;
+
+	(*job->ops->msort)(job->l, job->dst, job->nl);
+}
+
+static void sort_merge_job(void *p)
+{
+	struct sort_job *job = (struct sort_job *)p;
+
+	(*job->ops->merge)(job->dst, job->l, job->nl, job->r, job->nr);
+}
+
+static int sort_kind(s1_ptr s)
+/* which kind of elements does s have? SORT_NONE if they are mixed */
+{
+	object_ptr p, sp;
+	object e;
+	intptr_t i, j;
+	int kind;
+
+	if (s->length == 0)
+		return SORT_INTS;
+	p = s->base;
+	e = p[1];
+	kind = IS_ATOM_INT(e) ? SORT_INTS : IS_ATOM(e) ? SORT_DBLS : SORT_STRS;
+	for (i = 1; i <= s->length; i++) {
+		e = p[i];
+		switch (kind) {
+			case SORT_INTS:
+				if (!IS_ATOM_INT(e))
+					return SORT_NONE;
+				break;
+			case SORT_DBLS:
+				if (IS_ATOM_INT(e) || !IS_ATOM(e))
+					return SORT_NONE;
+				break;
+			default:
+				if (!IS_SEQUENCE(e))
+					return SORT_NONE;
+				sp = SEQ_PTR(e)->base;
+				for (j = SEQ_PTR(e)->length; j > 0; j--) {
+					if (!IS_ATOM_INT(*(++sp)))
+						return SORT_NONE;
+				}
+				break;
+		}
+	}
+	return kind;
+}
+
+static object_ptr sort_runs(struct sort_ops *ops, object_ptr a, object_ptr tmp,
+							intptr_t n, int nruns, int nthreads)
+/* sort a[0..n-1] using nruns runs, tmp as scratch space.
+   returns whichever of a or tmp ended up holding the result */
+{
+	struct sort_job *jobs;
+	intptr_t *bound, *next_bound;
+	intptr_t nl, nr, li, ri, prev_li, prev_ri;
+	object_ptr src, dst, swap;
+	int i, k, pieces, njobs, npairs;
+
+	bound = (intptr_t *)EMalloc((nruns + 1) * sizeof(intptr_t));
+	next_bound = (intptr_t *)EMalloc((nruns + 1) * sizeof(intptr_t));
+	jobs = (struct sort_job *)EMalloc((nruns + nthreads + 1) * sizeof(struct sort_job));
+
+	for (i = 0; i <= nruns; i++) {
+		bound[i] = (n * i) / nruns;
+	}
+	for (i = 0; i < nruns; i++) {
+		jobs[i].ops = ops;
+		jobs[i].l = a + bound[i];
+		jobs[i].nl = bound[i+1] - bound[i];
+		jobs[i].dst = tmp + bound[i];
+	}
+	pool_run(sort_run_job, jobs, sizeof(struct sort_job), nruns, nthreads);
+
+	src = a;
+	dst = tmp;
+	while (nruns > 1) {
+		npairs = nruns / 2;
+		pieces = nthreads / npairs;
+		if (pieces < 1)
+			pieces = 1;
+		njobs = 0;
+		for (i = 0; i < npairs; i++) {
+			nl = bound[2*i+1] - bound[2*i];
+			nr = bound[2*i+2] - bound[2*i+1];
+			prev_li = 0;
+			prev_ri = 0;
+			for (k = 1; k <= pieces; k++) {
+				if (k == pieces) {
+					li = nl;
+					ri = nr;
+				}
+				else {
+					// everything in the right run that is less than the
+					// left split element goes into this piece
+					li = (nl * k) / pieces;
+					ri = (*ops->lower_bound)(src + bound[2*i+1], nr,
+											 src[bound[2*i] + li]);
+				}
+				jobs[njobs].ops = ops;
+				jobs[njobs].dst = dst + bound[2*i] + prev_li + prev_ri;
+				jobs[njobs].l = src + bound[2*i] + prev_li;
+				jobs[njobs].nl = li - prev_li;
+				jobs[njobs].r = src + bound[2*i+1] + prev_ri;
+				jobs[njobs].nr = ri - prev_ri;
+				njobs++;
+				prev_li = li;
+				prev_ri = ri;
+			}
+			next_bound[i] = bound[2*i];
+		}
+		if (nruns & 1) {
+			// odd run out is carried over as is
+			jobs[njobs].ops = ops;
+			jobs[njobs].dst = dst + bound[nruns-1];
+			jobs[njobs].l = src + bound[nruns-1];
+			jobs[njobs].nl = n - bound[nruns-1];
+			jobs[njobs].r = NULL;
+			jobs[njobs].nr = 0;
+			njobs++;
+			next_bound[npairs++] = bound[nruns-1];
+		}
+		next_bound[npairs] = n;
+		pool_run(sort_merge_job, jobs, sizeof(struct sort_job), njobs, nthreads);
+
+		memcpy(bound, next_bound, (npairs + 1) * sizeof(intptr_t));
+		nruns = npairs;
+		swap = src;
+		src = dst;
+		dst = swap;
+	}
+
+	EFree((char *)jobs);
+	EFree((char *)next_bound);
+	EFree((char *)bound);
+	return src;
+}
+
+object parallel_sort(object x)
+/* x is {sequence, order, threads}. Returns a sorted copy of the sequence,
+   or 0 if its elements are not all integers, all doubles or all strings */
+{
+	s1_ptr args, s, result;
+	object_ptr elems, tmp, sorted, p, q;
+	object order, t;
+	intptr_t n, i;
+	int kind, nthreads, nruns;
+
+	args = SEQ_PTR(x);
+	if (args->length != 3 || !IS_SEQUENCE(args->base[1]))
+		RTFatal("parallel_sort: expected {sequence, order, threads}");
+	s = SEQ_PTR(args->base[1]);
+	order = get_int(args->base[2]);
+	nthreads = pool_size((int)get_int(args->base[3]));
+
+	kind = sort_kind(s);
+	if (kind == SORT_NONE)
+		return ATOM_0;
+
+	n = s->length;
+	result = NewS1(n);
+	elems = result->base + 1;
+	p = s->base;
+	for (i = 0; i < n; i++) {
+		t = *(++p);
+		Ref(t);
+		elems[i] = t;
+	}
+	if (n < 2)
+		return MAKE_SEQ(result);
+
+	nruns = (int)(n / SORT_MIN_CHUNK);
+	if (nruns > nthreads)
+		nruns = nthreads;
+	if (nruns < 1)
+		nruns = 1;
+
+	tmp = (object_ptr)EMalloc(n * sizeof(object));
+	sorted = sort_runs(&sort_table[kind], elems, tmp, n, nruns, nruns);
+	if (sorted != elems)
+		memcpy(elems, sorted, n * sizeof(object));
+	EFree((char *)tmp);
+
+	if (order < 0) {
+		p = elems;
+		q = elems + n - 1;
+		while (p < q) {
+			t = *p;
+			*p++ = *q;
+			*q-- = t;
+		}
+	}
+	return MAKE_SEQ(result);
+}
@@ -0,0 +1,8 @@
+#ifndef BE_SORT_H_
+#define BE_SORT_H_
+
+#include "execute.h"
+
+object parallel_sort(object x);
+
+#endif
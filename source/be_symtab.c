@@ -33,15 +33,6 @@
 symtab_ptr TopLevelSub;   /* symbol table pointer of top level procedure. */
 						  /* All user-defined symbols come after this */
 
-symtab_ptr *e_routine = NULL;  /* array of symbol table pointers */
-cleanup_ptr *e_cleanup = NULL; /* array of cleanup_ptr pointers */ 
-int e_routine_next = 0;       /* index of next available element */
-
-/*******************/
-/* Local variables */
-/*******************/
-static int e_routine_size = 0;   /* number of symbol table pointers allocated */
-
 /**********************/
 /* Declared functions */
 /**********************/
@@ -7,9 +7,6 @@
 extern symtab_ptr TopLevelSub; /* symbol table pointer of top level procedure. */
 						/* All user-defined symbols come after this */
 
-extern symtab_ptr *e_routine;  /* array of symbol table pointers */
-extern cleanup_ptr *e_cleanup; /* array of cleanup_ptr pointers */ 
-extern intptr_t e_routine_next;     /* index of next available element */
 symtab_ptr Locate(intptr_t *pc);
 symtab_ptr RTLookup(char *name, int file, intptr_t *pc, symtab_ptr routine, int stlen, unsigned long current_line);
 int FindLine(intptr_t *pc, symtab_ptr proc);
@@ -16,6 +16,7 @@
 #endif
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <math.h>
 #include <time.h>
 
@@ -23,6 +24,19 @@
 #include <windows.h> /* for Sleep(), Fibers */
 #endif
 
+#ifdef EUNIX
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef ELINUX
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+#endif
+
 #include "global.h"
 #include "execute.h"
 #include "symtab.h"
@@ -39,7 +53,40 @@
 /*********************/
 /* Local definitions */
 /*********************/
-#ifndef EWINDOWS
+#ifdef TASK_COROUTINES
+
+#if defined(__x86_64__) && defined(__GNUC__)
+// switch by swapping stack pointers - no system calls
+#define TASK_SWITCH_ASM
+#else
+#include <ucontext.h>
+#endif
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+// only the pages a task actually touches take up memory, so a task gets
+// as much stack as the main thread usually has
+#define TASK_STACK_SIZE (8 * 1024 * 1024)
+#define TASK_STACK_CACHE 64  // stacks of ended tasks kept for new ones
+
+struct task_context {
+#ifdef TASK_SWITCH_ASM
+	void *sp;                // saved stack pointer
+#else
+	ucontext_t uc;
+#endif
+	char *stack;             // mmap'd, with a guard page at the bottom
+	struct task_context *next_free;
+};
+
+static size_t page_size = 0;
+
+#elif !defined(EWINDOWS)
 
 pthread_mutex_t task_mutex;
 pthread_cond_t  task_condition;
@@ -49,19 +96,36 @@ pthread_t       task_thread;
 /**********************/
 /* Exported variables */
 /**********************/
-struct tcb *tcb;
-int tcb_size;
-int current_task;
 // Windows/Linux/FreeBSD
-double clock_period = 0.01;  // should check this at run-time
+double clock_period = 0.01;  // checked at run-time on Unix
 
 /*******************/
 /* Local variables */
 /*******************/
-static int rt_first, ts_first;
-static int clock_stopped = FALSE;
-static int id_wrap = FALSE; // have task id's wrapped around? (very rare)
-static double next_task_id = 1.0;
+// scheduler queues (tcb.queue)
+#define Q_NONE      0  // suspended, dead, or not yet scheduled
+#define Q_REAL_TIME 1  // in rt_heap, ordered by max_time
+#define Q_READY     2  // time-share, with runs left in this round
+#define Q_SPENT     3  // time-share, waiting for the next round
+#define Q_WAIT      4  // suspended on a semaphore's, event's or channel's
+					   // wait queue (tcb.waiting)
+
+// The run queues are rt_heap, a binary min-heap of real-time tasks, and
+// the ready_first/spent_first lists of time-share tasks.  tid_table maps
+// external task ids to internal task numbers by open addressing; its size
+// is a power of 2, at least twice tcb_size.  These and the rest of the
+// scheduler's state are fields of the runtime context (be_context.h).
+
+#ifdef EUNIX
+// tasks suspended by task_io_wait() until a file descriptor is ready
+struct io_waiter {
+	int task;    // internal task number
+	int fd;
+	int events;  // TASK_IO_READ and/or TASK_IO_WRITE
+	int type;    // the task's type, T_REAL_TIME or T_TIME_SHARE, to restore
+};
+// io_waiters has io_waiters_size entries, io_waiting of them in use
+#endif
 
 
 /*********************/
@@ -71,17 +135,362 @@ static double next_task_id = 1.0;
 #include "alldefs.h"
 static void init_task( intptr_t tx );
 static void run_current_task( int task );
+static void sync_unwake( int task );
 
 /*********************/
 /* Defined functions */
 /*********************/
 
+static unsigned int tid_hash(double tid)
+{
+	return (unsigned int)(((uint64_t)tid * 0x9E3779B97F4A7C15ULL) >> 32);
+}
+
+static void tid_add(int task)
+// make tcb[task].tid findable
+{
+	unsigned int mask, i;
+	int j;
+
+	if (2 * tcb_size > tid_table_size) {
+		// grow, and put every entry back
+		if (tid_table != NULL)
+			EFree((char *)tid_table);
+		tid_table_size = (tid_table_size == 0) ? 64 : 2 * tid_table_size;
+		tid_table = (int *)EMalloc(tid_table_size * sizeof(int));
+		for (i = 0; i < (unsigned int)tid_table_size; i++) {
+			tid_table[i] = -1;
+		}
+		for (j = 0; j < tcb_size; j++) {
+			if (j != task)
+				tid_add(j);
+		}
+	}
+	mask = tid_table_size - 1;
+	for (i = tid_hash(tcb[task].tid) & mask; tid_table[i] != -1; i = (i + 1) & mask)
+		;
+	tid_table[i] = task;
+}
+
+static int tid_find(double tid)
+// internal task number for an external task id, or -1
+{
+	unsigned int mask, i;
+
+	mask = tid_table_size - 1;
+	for (i = tid_hash(tid) & mask; tid_table[i] != -1; i = (i + 1) & mask) {
+		if (tcb[tid_table[i]].tid == tid)
+			return tid_table[i];
+	}
+	return -1;
+}
+
+static void tid_remove(int task)
+// forget tcb[task].tid, before the entry is recycled
+{
+	unsigned int mask, i, j, home;
+
+	mask = tid_table_size - 1;
+	for (i = tid_hash(tcb[task].tid) & mask; tid_table[i] != task; i = (i + 1) & mask)
+		;
+	// close the gap, so later entries in the same run can still be found
+	j = i;
+	for (;;) {
+		tid_table[i] = -1;
+		do {
+			j = (j + 1) & mask;
+			if (tid_table[j] == -1)
+				return;
+			home = tid_hash(tcb[tid_table[j]].tid) & mask;
+		} while (i <= j ? (i < home && home <= j) : (i < home || home <= j));
+		tid_table[i] = tid_table[j];
+		i = j;
+	}
+}
+
+static void rt_place(int pos, int task)
+{
+	rt_heap[pos] = task;
+	tcb[task].heap_pos = pos;
+}
+
+static void rt_sift_up(int pos)
+{
+	int task, parent;
+
+	task = rt_heap[pos];
+	while (pos > 0) {
+		parent = (pos - 1) / 2;
+		if (tcb[rt_heap[parent]].max_time <= tcb[task].max_time)
+			break;
+		rt_place(pos, rt_heap[parent]);
+		pos = parent;
+	}
+	rt_place(pos, task);
+}
+
+static void rt_sift_down(int pos)
+{
+	int task, child;
+
+	task = rt_heap[pos];
+	for (;;) {
+		child = 2 * pos + 1;
+		if (child >= rt_count)
+			break;
+		if (child + 1 < rt_count &&
+			tcb[rt_heap[child + 1]].max_time < tcb[rt_heap[child]].max_time)
+			child++;
+		if (tcb[task].max_time <= tcb[rt_heap[child]].max_time)
+			break;
+		rt_place(pos, rt_heap[child]);
+		pos = child;
+	}
+	rt_place(pos, task);
+}
+
+static void rt_fix(int task)
+// restore the heap order after tcb[task].max_time changed
+{
+	rt_sift_up(tcb[task].heap_pos);
+	rt_sift_down(tcb[task].heap_pos);
+}
+
+static void ts_append(int *first, int *last, int task)
+{
+	tcb[task].prev = *last;
+	tcb[task].next = -1;
+	if (*last == -1)
+		*first = task;
+	else
+		tcb[*last].next = task;
+	*last = task;
+}
+
+static void ts_prepend(int *first, int *last, int task)
+{
+	tcb[task].prev = -1;
+	tcb[task].next = *first;
+	if (*first == -1)
+		*last = task;
+	else
+		tcb[*first].prev = task;
+	*first = task;
+}
+
+static void ts_unlink(int *first, int *last, int task)
+{
+	if (tcb[task].prev == -1)
+		*first = tcb[task].next;
+	else
+		tcb[tcb[task].prev].next = tcb[task].next;
+	if (tcb[task].next == -1)
+		*last = tcb[task].prev;
+	else
+		tcb[tcb[task].next].prev = tcb[task].prev;
+}
+
+static void task_enqueue(int task)
+// put an active task on the queue for its type
+{
+	if (tcb[task].type == T_REAL_TIME) {
+		if (rt_count == rt_heap_size) {
+			if (rt_heap_size == 0) {
+				rt_heap_size = 64;
+				rt_heap = (int *)EMalloc(rt_heap_size * sizeof(int));
+			}
+			else {
+				rt_heap_size *= 2;
+				rt_heap = (int *)ERealloc((char *)rt_heap, rt_heap_size * sizeof(int));
+			}
+		}
+		tcb[task].queue = Q_REAL_TIME;
+		rt_place(rt_count++, task);
+		rt_sift_up(tcb[task].heap_pos);
+	}
+	else if (tcb[task].runs_left > 0) {
+		// a newly scheduled task goes first, as it always has
+		tcb[task].queue = Q_READY;
+		ts_prepend(&ready_first, &ready_last, task);
+	}
+	else {
+		tcb[task].queue = Q_SPENT;
+		ts_append(&spent_first, &spent_last, task);
+	}
+}
+
+static void task_dequeue(int task)
+// take a task off whichever queue it's on
+{
+	int pos, last;
+
+	switch (tcb[task].queue) {
+		case Q_REAL_TIME:
+			pos = tcb[task].heap_pos;
+			last = rt_heap[--rt_count];
+			if (last != task) {
+				rt_place(pos, last);
+				rt_fix(last);
+			}
+			tcb[task].heap_pos = -1;
+			break;
+		case Q_READY:
+			ts_unlink(&ready_first, &ready_last, task);
+			break;
+		case Q_SPENT:
+			ts_unlink(&spent_first, &spent_last, task);
+			break;
+		case Q_WAIT:
+			ts_unlink(&tcb[task].waiting->first, &tcb[task].waiting->last, task);
+			tcb[task].waiting = NULL;
+			break;
+	}
+	tcb[task].queue = Q_NONE;
+}
+
+static void wait_park(struct wait_queue *q)
+// suspend the current task at the end of wait queue q, until wait_wake()
+// reaches it. the caller must then task_yield()
+{
+	task_dequeue(current_task);
+	tcb[current_task].status = ST_SUSPENDED;
+	tcb[current_task].max_time = TASK_NEVER;
+	tcb[current_task].woken = FALSE;
+	tcb[current_task].unit_of = 0;
+	tcb[current_task].queue = Q_WAIT;
+	tcb[current_task].waiting = q;
+	ts_append(&q->first, &q->last, current_task);
+}
+
+static int wait_wake(struct wait_queue *q, int woken)
+// reschedule the task that has waited longest on q, setting its woken flag
+// to say whether it was handed what it waited for. returns FALSE if no
+// task was waiting
+{
+	int task;
+	double now;
+
+	task = q->first;
+	if (task == -1)
+		return FALSE;
+	task_dequeue(task);
+	tcb[task].woken = woken;
+	tcb[task].status = ST_ACTIVE;
+	if (tcb[task].type == T_REAL_TIME) {
+		now = current_time();
+		tcb[task].min_time = now;
+		tcb[task].max_time = now + tcb[task].max_inc;
+	}
+	else {
+		tcb[task].runs_left = tcb[task].runs_max;
+	}
+	task_enqueue(task);
+	return TRUE;
+}
+
+static void ts_recharge()
+// start a new round: every time-share task gets its runs back
+{
+	int p;
+
+	for (p = spent_first; p != -1; p = tcb[p].next) {
+		tcb[p].runs_left = tcb[p].runs_max;
+		tcb[p].queue = Q_READY;
+	}
+	ready_first = spent_first;
+	ready_last = spent_last;
+	spent_first = spent_last = -1;
+}
+
+static int tcb_new_entry()
+// a fresh tcb entry at the end of the table
+{
+	if (tcb_size == tcb_alloc) {
+		tcb_alloc *= 2;
+		// n.b. tcb could get moved because of this:
+		tcb = (struct tcb_entry *)ERealloc((char *)tcb, sizeof(struct tcb_entry) * tcb_alloc);
+	}
+	return tcb_size++;
+}
+
+#define RECYCLE_LOOK 8  // ended tasks compared when choosing one to recycle
+
+static int dead_take(int by_stack)
+// take an ST_DEAD task off the dead list so its entry can be recycled
+// (but not its external task id). -1 if there are none.
+// by_stack picks the one with the most stack space among the most
+// recently ended
+{
+	int *link, *best_link;
+	int n;
+
+	if (dead_first == -1)
+		return -1;
+	best_link = &dead_first;
+	if (by_stack) {
+		n = 0;
+		for (link = &tcb[dead_first].next; *link != -1 && ++n < RECYCLE_LOOK;
+			 link = &tcb[*link].next) {
+			if (tcb[*link].impl.interpreted.stack_length >
+				tcb[*best_link].impl.interpreted.stack_length)
+				best_link = link;
+		}
+	}
+	n = *best_link;
+	*best_link = tcb[n].next;
+	return n;
+}
+
+static void choose_next_task_id()
+{
+	double t;
+
+	if (!id_wrap && next_task_id < TASK_ID_MAX) {
+		next_task_id += 1.0;
+	}
+	else {
+		// extremely rare
+		id_wrap = TRUE;  // id's have wrapped
+		for (t = 1.0; t <= TASK_ID_MAX; t += 1.0) { 
+			if (tid_find(t) == -1) {
+				next_task_id = t;
+				break;   // found unused id for next time
+			}
+		}
+		// must have found one - couldn't have trillions of non-dead tasks!
+	}
+}
+
 void InitTask()
 // initialize the first (top-level) task - task id 0
 {   
+#if defined(EUNIX) && defined(CLOCK_MONOTONIC)
+	struct timespec res;
+
+	// current_time() is as precise as this
+	if (clock_getres(CLOCK_MONOTONIC, &res) == 0) {
+		clock_period = res.tv_sec + res.tv_nsec / 1000000000.0;
+	}
+#endif
 	
+	// a new runtime context starts out zeroed
+	clock_stopped = FALSE;
+	save_clock = -1.0;
+	id_wrap = FALSE;
+	next_task_id = 1.0;
+	rt_count = 0;
+	ready_first = ready_last = -1;
+	spent_first = spent_last = -1;
+	dead_first = -1;
+	// the last part of a Wait() that is spun rather than slept, to make up
+	// for the system waking a sleeper late
+	wait_spin = 0.0002;
+#ifdef ELINUX
+	epoll_fd = -1;
+#endif
 	
-	tcb = (struct tcb *)EMalloc(sizeof(struct tcb)); // allocate one entry
+	tcb_alloc = 16;
+	tcb = (struct tcb_entry *)EMalloc(tcb_alloc * sizeof(struct tcb_entry));
 	tcb[0].rid = -1;
 	tcb[0].tid = 0.0;
 	tcb[0].type = T_TIME_SHARE;
@@ -94,12 +503,28 @@ void InitTask()
 	tcb[0].runs_left = 1;
 	tcb[0].runs_max = 1;
 	tcb[0].next = -1; // end marker
+	tcb[0].prev = -1;
+	tcb[0].queue = Q_NONE;
+	tcb[0].heap_pos = -1;
+	tcb[0].waiting = NULL;
+	tcb[0].woken = FALSE;
+	tcb[0].unit_of = 0;
+	tcb[0].run_start = current_time();
+	tcb[0].cpu_time = 0.0;
+	tcb[0].runs = 1.0;
+	tcb[0].late_total = 0.0;
+	tcb[0].late_max = 0.0;
+	tcb[0].waited = 0.0;
 	tcb[0].args = 0;
 	
 #ifdef ERUNTIME 
 	tcb[0].mode = TRANSLATED_TASK;
 #ifdef EWINDOWS
 	tcb[0].impl.translated.task = ConvertThreadToFiber( 0 );
+#elif defined(TASK_COROUTINES)
+	if (main_context == NULL)
+		main_context = (struct task_context *)EMalloc(sizeof(struct task_context));
+	tcb[0].impl.translated.task = (TASK_HANDLE)main_context;
 #else
 	tcb[0].impl.translated.task = pthread_self();
 	pthread_mutex_init( &task_mutex, NULL );
@@ -116,115 +541,168 @@ void InitTask()
 	tcb[0].mode = INTERPRETED_TASK;
 	// these things will be set when task 0 yields for the first time
 	tcb[0].impl.interpreted.pc = (intptr_t *)1; 
-	tcb[0].impl.interpreted.expr_max = NULL;
-	tcb[0].impl.interpreted.expr_limit = NULL;
-	tcb[0].impl.interpreted.expr_top = NULL;
-	tcb[0].impl.interpreted.expr_stack = NULL;
-	tcb[0].impl.interpreted.stack_size = 0; 
+	tcb[0].impl.interpreted.stack_max = NULL;
+	tcb[0].impl.interpreted.stack_limit = NULL;
+	tcb[0].impl.interpreted.stack_top = NULL;
+	tcb[0].impl.interpreted.stack = NULL;
+	tcb[0].impl.interpreted.segment = NULL;
+	tcb[0].impl.interpreted.stack_length = 0; 
 #endif  
 
 
 
 	tcb_size = 1;
+	tid_add(0);
 	
-	ts_first = 0;    // this ts task only
-	rt_first = -1;   // no rt tasks
+	task_enqueue(0); // this ts task only
 	
 	current_task = 0;
 }
 
-static int task_delete(int first, int task)
-// Remove a task from a list of tasks (if it's there).
-// Return the new first element of the list.    
+#ifdef EUNIX
+#ifdef ELINUX
+static void io_arm(int fd);
+#endif
+
+static void io_forget(int task)
+// a task that has ended is no longer waiting for anything
 {
-	int p, prev_p;
-	
-	prev_p = -1;
-	p = first;
-	while (p != -1) {
-		if (p == task) {
-			if (prev_p == -1) {
-				// it was first on list
-				return tcb[p].next;
-			}
-			else {
-				// skip around it
-				tcb[prev_p].next = tcb[p].next;
-				return first;
-			}
+	int i;
+#ifdef ELINUX
+	int fd;
+#endif
+
+	i = 0;
+	while (i < io_waiting) {
+		if (io_waiters[i].task == task) {
+#ifdef ELINUX
+			fd = io_waiters[i].fd;
+			io_waiters[i] = io_waiters[--io_waiting];
+			io_arm(fd);
+#else
+			io_waiters[i] = io_waiters[--io_waiting];
+#endif
+		}
+		else {
+			i++;
 		}
-		prev_p = p;
-		p = tcb[p].next;
 	}
-	// couldn't find it
-	return first;
 }
+#endif
 
 void terminate_task(int task)
 // mark a task for deletion (task is the internal task number)
 {
-	if (tcb[task].type == T_REAL_TIME) {
-		rt_first = task_delete(rt_first, task);
-	}
-	else {    
-		ts_first = task_delete(ts_first, task);
+#ifdef EUNIX
+	if (io_waiting)
+		io_forget(task);
+#endif
+	if (tcb[task].woken)
+		sync_unwake(task);
+	task_dequeue(task);
+	if (tcb[task].status != ST_DEAD) {
+		tcb[task].status = ST_DEAD; // its tcb entry will be recycled later
+		tcb[task].next = dead_first;
+		dead_first = task;
 	}
-	tcb[task].status = ST_DEAD; // its tcb entry will be recycled later
+#ifndef TASK_COROUTINES
+	// (a coroutine's stack is kept, to be reused when the entry is)
 	if( tcb[task].mode == TRANSLATED_TASK ){
 		tcb[task].impl.translated.task = (TASK_HANDLE) 0;
 	}
+#endif
+}
+
+#ifdef EUNIX
+static void sleep_until(double until)
+// sleep until current_time() reaches until
+{
+	struct timespec req;
+	double d;
+
+	d = until - current_time();
+	if (d <= 0.0)
+		return;
+	if (d > 1.0e9)
+		d = 1.0e9;
+#if defined(CLOCK_MONOTONIC) && defined(TIMER_ABSTIME)
+	// current_time() runs on CLOCK_MONOTONIC, so sleep to an absolute time
+	// on it - a sleep interrupted by a signal just starts again
+	if (clock_gettime(CLOCK_MONOTONIC, &req) == 0) {
+		req.tv_sec += (time_t)d;
+		req.tv_nsec += (long)((d - EUFLOOR(d)) * 1000000000.0);
+		if (req.tv_nsec >= 1000000000L) {
+			req.tv_sec += 1;
+			req.tv_nsec -= 1000000000L;
+		}
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &req, NULL) == EINTR)
+			;
+		return;
+	}
+#endif
+	while (d > 0.0) {
+		req.tv_sec = (time_t)d;
+		req.tv_nsec = (long)((d - EUFLOOR(d)) * 1000000000.0);
+		if (nanosleep(&req, NULL) == 0)
+			break;
+		d = until - current_time();
+	}
 }
+#endif
 
 double Wait(double t)
 // Wait for a while 
 {   
-	double t1, t2, now;
-	int it;
+	double now, until;
+
 #ifdef EUNIX
-	double t3;
-	long itsme;
-	struct timespec req;
-#endif // EUNIX
-	
-#ifdef EWINDOWS
+	now = current_time();
+	until = now + t;
+	// sleep through most of it, and spin for the rest, since the
+	// system may wake us a little late
+	if (t > wait_spin) {
+		sleep_until(until - wait_spin);
+	}
+#else
+	double t1, t2;
+	int it;
+
 	t1 = EUFLOOR(1000.0 * t);
 	t2 = t1 / 1000.0;
-#else // EWINDOWS
-	t1 = EUFLOOR(t);
-#endif // EWINDOWS
-#ifdef EUNIX
-	t2 = t - t1;
-	t3 = EUFLOOR(1000000000.0 * t2);
-#endif // EUNIX
 	if (t1 >= 1.0) {
 		it = t1; // overflow?
-#ifdef EWINDOWS
 		Sleep(it);
 		t -= t2;
-#else // EWINDOWS
-#ifdef EUNIX
-		itsme = (long)t3;
-		req.tv_sec = it;
-		req.tv_nsec = itsme;
-		nanosleep(&req, NULL);
-		t3 = t3 / 1000000000.0;
-		t = t2 - t3;
-#else
-		sleep(it);
-		t -= t1;
-#endif  // EUNIX
-#endif // EWINDOWS
 	}
 	
-	// busy Wait for the last bit, < 1 sec
+	// busy Wait for the last bit, < 1 ms
 	now = current_time();
-	t2 = now + t;
-	while (now < t2) {
+	until = now + t;
+#endif
+	while (now < until) {
 		now = current_time();
 	}
 	return now;
 }
 
+object task_wait_spin(object x)
+/* x is how many seconds at the end of each wait to spin rather than
+   sleep, or negative to leave it as it is. returns the old setting */
+{
+	double old, d;
+
+	old = wait_spin;
+	if (IS_ATOM_INT(x))
+		d = (double)INT_VAL(x);
+	else if (IS_ATOM_DBL(x))
+		d = (double)DBL_PTR(x)->dbl;
+	else
+		RTFatal("task_wait_spin: the time must be an atom");
+	if (d >= 0.0)
+		wait_spin = d;
+	return NewDouble((eudouble)old);
+}
+
 // Created by the translator:
 extern struct routine_list _00[];
 static void call_task(int rid, object args) 
@@ -441,29 +919,30 @@ void task_yield()
 											 tcb[current_task].max_inc;
 			}
 		}
+		if (tcb[current_task].queue == Q_REAL_TIME) {
+			rt_fix(current_task);
+		}
+		else if (tcb[current_task].queue == Q_READY &&
+				 tcb[current_task].runs_left == 0) {
+			// its turn is over until the next round
+			ts_unlink(&ready_first, &ready_last, current_task);
+			tcb[current_task].queue = Q_SPENT;
+			ts_append(&spent_first, &spent_last, current_task);
+		}
 	}
 	scheduler(now);
 }
 
-static int task_insert(int first, int task)
-// add a task to the appropriate list of tasks
-{   
-	tcb[task].next = first;
-	return task;
-}
-
 static int which_task(double tid)
 // find internal task number, given external task id
 {   
 	int i;
 
-	
-	for (i = 0; i < tcb_size; i++) {
-		if (tcb[i].tid == tid) {
-			return i;
-		}
+	i = tid_find(tid);
+	if (i == -1) {
+		RTFatal("Invalid task id: %10.3g", tid);
 	}
-	RTFatal("Invalid task id: %10.3g", tid);
+	return i;
 }
 
 
@@ -485,6 +964,9 @@ void task_schedule(object task, object sparams)
 		RTFatal("task id must not be a sequence");
 	
 	task = (object)which_task(dtask);
+	if (tcb[task].status == ST_DEAD) {
+		return; // it has already finished
+	}
 	
 	if IS_ATOM(sparams) {
 		// time-sharing
@@ -506,12 +988,11 @@ void task_schedule(object task, object sparams)
 			
 		//tcb[task].runs_left = repeats;  // current execution count
 		tcb[task].runs_max = repeats;   // max execution count
-		if (tcb[task].type == T_REAL_TIME) {
-			rt_first = task_delete(rt_first, task);
-		}
 		if (tcb[task].type == T_REAL_TIME ||
 			tcb[task].status == ST_SUSPENDED) {
-			ts_first = task_insert(ts_first, task);
+			task_dequeue(task);
+			tcb[task].type = T_TIME_SHARE;
+			task_enqueue(task);
 		}
 		tcb[task].type = T_TIME_SHARE;
 	}
@@ -563,12 +1044,14 @@ void task_schedule(object task, object sparams)
 		tcb[task].max_time = now + max_dbl;
 		tcb[task].start = now; // not exact
 			
-		if (tcb[task].type == T_TIME_SHARE) {
-			ts_first = task_delete(ts_first, task);
-		}
 		if (tcb[task].type == T_TIME_SHARE ||
 			   tcb[task].status == ST_SUSPENDED) {
-			rt_first = task_insert(rt_first, task);
+			task_dequeue(task);
+			tcb[task].type = T_REAL_TIME;
+			task_enqueue(task);
+		}
+		else if (tcb[task].queue == Q_REAL_TIME) {
+			rt_fix(task);
 		}
 		tcb[task].type = T_REAL_TIME;
 	}
@@ -593,15 +1076,11 @@ void task_suspend(object a)
 
 	task = which_task(tid);
 	
+	if (tcb[task].woken)
+		sync_unwake(task);  // it mustn't keep a unit it won't use
+	task_dequeue(task);
 	tcb[task].status = ST_SUSPENDED;
 	tcb[task].max_time = TASK_NEVER;
-	
-	if (tcb[task].type == T_REAL_TIME) {
-		rt_first = task_delete(rt_first, task);
-	}    
-	else {  
-		ts_first = task_delete(ts_first, task);
-	}
 }
 
 object task_list()
@@ -624,6 +1103,12 @@ object task_list()
 	return ss;
 }
 
+object task_self()
+/* the external id of the current task */
+{
+	return NewDouble(tcb[current_task].tid);
+}
+
 object task_status(object a)
 {
 	int r, t;
@@ -640,22 +1125,19 @@ object task_status(object a)
 	}
 	r = -1;
 	
-	for (t = 0; t < tcb_size; t++) {
-		if (tcb[t].tid == tid) {
-			if (tcb[t].status == ST_ACTIVE) {
-				r = 1;
-			}
-			else if (tcb[t].status == ST_SUSPENDED) {
-				r = 0;
-			}
-			break;
+	t = tid_find(tid);
+	if (t != -1) {
+		if (tcb[t].status == ST_ACTIVE) {
+			r = 1;
+		}
+		else if (tcb[t].status == ST_SUSPENDED) {
+			r = 0;
 		}
 	}
 	
 	return r;
 }
 
-static double save_clock = -1.0;
 
 void task_clock_stop()
 // stop the scheduler clock 
@@ -684,68 +1166,1119 @@ void task_clock_start()
 	}
 }
 
-#ifndef ERUNTIME
-object task_create(object r_id, object args)
-// Create a new task for the interpreter - return a double task id - assumed by Translator
+#ifdef EUNIX
+static int io_ready_now(int fd, int events)
+/* TRUE if fd can be used for events without blocking */
 {
-	symtab_ptr sub;
-	struct tcb *new_entry;
-	int recycle, recycle_size, i, j, proc_args;
-	double id, t;
-	
-	
-	
-	r_id = (object)get_pos_int("task_create", r_id);
+	struct pollfd pfd;
+	int r;
+
+	pfd.fd = fd;
+	pfd.events = ((events & TASK_IO_READ) ? POLLIN : 0) |
+				 ((events & TASK_IO_WRITE) ? POLLOUT : 0);
+	pfd.revents = 0;
+	do {
+		r = poll(&pfd, 1, 0);
+	} while (r < 0 && errno == EINTR);
+	// errors and hang ups count as ready - the read or write will report them
+	return r != 0;
+}
 
-  
-	if ( r_id >= e_routine_next)
-		RTFatal("invalid routine id");
-	sub = e_routine[r_id];
-	
-	if (sub->token != PROC) {
-		RTFatal("specify the routine id of a procedure, not a function or type");
-	} 
-	
-	if (!IS_SEQUENCE(args))
-		RTFatal("Argument list must be a sequence");
+#ifdef ELINUX
+static void io_arm(int fd)
+/* (re)register fd with epoll for what its waiting tasks need */
+{
+	struct epoll_event ev;
+	int i, events;
 
-	proc_args = sub->u.subp.num_args; 
-	
-	if (SEQ_PTR(args)->length != proc_args) {
-		RTFatal("Incorrect number of arguments (passing %d where %d are expected)",
-				SEQ_PTR(args)->length, proc_args);
+	events = 0;
+	for (i = 0; i < io_waiting; i++) {
+		if (io_waiters[i].fd == fd)
+			events |= io_waiters[i].events;
 	}
-	
-	recycle = -1;
-	recycle_size = -1;
- 
-	for (i = 0; i < tcb_size; i++) {  
-		if (tcb[i].status == ST_DEAD) {
-			// this task is dead, can recycle its entry 
-			// (but not its external task id)
-			// try to pick ST_DEAD task with biggest stack space
-			// (this mainly helps translated code, but also helps interpeter)
-			if (tcb[i].impl.interpreted.stack_size > recycle_size) {
-				recycle_size = tcb[i].impl.interpreted.stack_size;
-				recycle = i;
+	if (events == 0) {
+		epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &ev);
+		return;
+	}
+	ev.events = EPOLLONESHOT |
+				((events & TASK_IO_READ) ? EPOLLIN : 0) |
+				((events & TASK_IO_WRITE) ? EPOLLOUT : 0);
+	ev.data.fd = fd;
+	if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev) == -1 && errno == ENOENT) {
+		epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+	}
+}
+#endif
+
+static void io_wake(int fd, int ready)
+/* reschedule the tasks waiting on fd for any of the ready events */
+{
+	int i, task;
+	double now;
+
+	now = current_time();
+	i = 0;
+	while (i < io_waiting) {
+		if (io_waiters[i].fd != fd || !(io_waiters[i].events & ready)) {
+			i++;
+			continue;
+		}
+		task = io_waiters[i].task;
+		if (tcb[task].status == ST_SUSPENDED) {
+			tcb[task].status = ST_ACTIVE;
+			tcb[task].type = io_waiters[i].type;
+			if (tcb[task].type == T_REAL_TIME) {
+				tcb[task].min_time = now;
+				tcb[task].max_time = now + tcb[task].max_inc;
+			}
+			else {
+				tcb[task].runs_left = tcb[task].runs_max;
 			}
+			task_enqueue(task);
 		}
+		// else it was rescheduled or killed in the meantime
+		io_waiters[i] = io_waiters[--io_waiting];
 	}
-	
+}
+
+static int io_poll(double timeout)
+/* wait up to timeout seconds (forever if negative) for a file descriptor
+   that a task is waiting on to become ready, and reschedule its tasks.
+   returns the number of file descriptors that were ready */
+{
+	int ms, n, i, ready;
+#ifdef ELINUX
+	struct epoll_event events[64];
+#else
+	struct pollfd *fds;
+	int count;
+#endif
+
+	if (timeout < 0.0)
+		ms = -1;
+	else if (timeout > 1.0e6)
+		ms = 1000000000;
+	else
+		ms = (int)(timeout * 1000.0 + 0.999);
+
+#ifdef ELINUX
+	n = epoll_wait(epoll_fd, events, 64, ms);
+	for (i = 0; i < n; i++) {
+		ready = 0;
+		if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+			ready |= TASK_IO_READ;
+		if (events[i].events & (EPOLLOUT | EPOLLHUP | EPOLLERR))
+			ready |= TASK_IO_WRITE;
+		io_wake(events[i].data.fd, ready);
+		// the others waiting on this fd still need it
+		io_arm(events[i].data.fd);
+	}
+#else
+	fds = (struct pollfd *)EMalloc(io_waiting * sizeof(struct pollfd));
+	for (i = 0; i < io_waiting; i++) {
+		fds[i].fd = io_waiters[i].fd;
+		fds[i].events = ((io_waiters[i].events & TASK_IO_READ) ? POLLIN : 0) |
+						((io_waiters[i].events & TASK_IO_WRITE) ? POLLOUT : 0);
+		fds[i].revents = 0;
+	}
+	count = io_waiting;
+	n = poll(fds, count, ms);
+	for (i = 0; n > 0 && i < count; i++) {
+		ready = 0;
+		if (fds[i].revents & (POLLIN | POLLHUP | POLLERR | POLLNVAL))
+			ready |= TASK_IO_READ;
+		if (fds[i].revents & (POLLOUT | POLLHUP | POLLERR | POLLNVAL))
+			ready |= TASK_IO_WRITE;
+		if (ready)
+			io_wake(fds[i].fd, ready);
+	}
+	EFree((char *)fds);
+#endif
+	return (n < 0) ? 0 : n;
+}
+#endif
+
+#ifdef EUNIX
+static int io_park(int fd, int events)
+/* if fd isn't ready for events, suspend the current task until it is and
+   return TRUE - the caller must then task_yield() */
+{
+	struct io_waiter *w;
+
+	if (io_ready_now(fd, events))
+		return FALSE;
+
+#ifdef ELINUX
+	if (epoll_fd == -1) {
+		epoll_fd = epoll_create(64);
+		if (epoll_fd == -1)
+			return FALSE;  // just block in the read or write
+		fcntl(epoll_fd, F_SETFD, FD_CLOEXEC);
+	}
+#endif
+	if (io_waiting == io_waiters_size) {
+		if (io_waiters_size == 0) {
+			io_waiters_size = 16;
+			io_waiters = (struct io_waiter *)EMalloc(
+									io_waiters_size * sizeof(struct io_waiter));
+		}
+		else {
+			io_waiters_size *= 2;
+			io_waiters = (struct io_waiter *)ERealloc((char *)io_waiters,
+									io_waiters_size * sizeof(struct io_waiter));
+		}
+	}
+	w = &io_waiters[io_waiting++];
+	w->task = current_task;
+	w->fd = fd;
+	w->events = events;
+	w->type = tcb[current_task].type;
+#ifdef ELINUX
+	io_arm(fd);
+#endif
+
+	// suspend it, like task_suspend()
+	task_dequeue(current_task);
+	tcb[current_task].status = ST_SUSPENDED;
+	tcb[current_task].max_time = TASK_NEVER;
+	return TRUE;
+}
+#endif
+
+object task_io_wait(object x)
+/* x is {fd, events}. if fd isn't ready, suspend the current task until it
+   is and return 1 - the caller must then task_yield(). returns 0 if fd
+   is ready already */
+{
+#ifdef EUNIX
+	s1_ptr args;
+	int fd, events;
+
+	args = SEQ_PTR(x);
+	fd = (int)get_pos_int("task_io_wait", args->base[1]);
+	events = (int)get_pos_int("task_io_wait", args->base[2]) &
+			 (TASK_IO_READ | TASK_IO_WRITE);
+	if (events == 0)
+		RTFatal("task_io_wait: the events must include TASK_IO_READ or TASK_IO_WRITE");
+
+	return io_park(fd, events) ? ATOM_1 : ATOM_0;
+#else
+	// no waiting - the read or write will simply block
+	UNUSED(x);
+	return ATOM_0;
+#endif
+}
+
+/***********/
+/* Handles */
+/***********/
+
+// Euphoria code refers to a channel, semaphore or event by a handle, which
+// is checked before it is used: the low HANDLE_SLOT_BITS of a handle are
+// the index of a slot in a table, and the bits above them are the slot's
+// generation, which goes up each time the slot is freed.  So a number that
+// was never a handle, or the handle of something that has been deleted,
+// is caught rather than followed.
+
+#define HANDLE_SLOT_BITS 16
+#define HANDLE_SLOTS_MAX (1 << HANDLE_SLOT_BITS)
+#define HANDLE_GEN_MAX ((uintptr_t)MAXINT >> HANDLE_SLOT_BITS)
+
+struct handle_slot {
+	void *obj;                 // NULL while the slot is free
+	uintptr_t gen;             // from 1 to HANDLE_GEN_MAX
+	int next_free;             // 1 + the next free slot, or 0
+};
+
+static uintptr_t handle_add(struct handle_table *t, void *obj)
+/* a new handle for obj, or 0 if the table is full */
+{
+	struct handle_slot *slot;
+	int i, size;
+
+	if (t->free_first != 0) {
+		i = t->free_first - 1;
+		t->free_first = t->slot[i].next_free;
+	}
+	else {
+		if (t->used == t->size) {
+			if (t->size == HANDLE_SLOTS_MAX)
+				return 0;
+			size = (t->size == 0) ? 16 : 2 * t->size;
+			slot = (struct handle_slot *)realloc(t->slot,
+											size * sizeof(struct handle_slot));
+			if (slot == NULL)
+				return 0;
+			t->slot = slot;
+			t->size = size;
+		}
+		i = t->used++;
+		t->slot[i].gen = 1;
+	}
+	t->slot[i].obj = obj;
+	return (t->slot[i].gen << HANDLE_SLOT_BITS) | (uintptr_t)i;
+}
+
+static void *handle_obj(struct handle_table *t, uintptr_t h)
+/* what handle h refers to, or NULL if it isn't a live handle */
+{
+	uintptr_t i;
+
+	i = h & (HANDLE_SLOTS_MAX - 1);
+	if (i >= (uintptr_t)t->used || t->slot[i].obj == NULL ||
+		t->slot[i].gen != h >> HANDLE_SLOT_BITS)
+		return NULL;
+	return t->slot[i].obj;
+}
+
+static void handle_remove(struct handle_table *t, uintptr_t h)
+/* free the slot of live handle h */
+{
+	int i;
+
+	i = (int)(h & (HANDLE_SLOTS_MAX - 1));
+	t->slot[i].obj = NULL;
+	t->slot[i].gen = (t->slot[i].gen == HANDLE_GEN_MAX) ? 1 : t->slot[i].gen + 1;
+	t->slot[i].next_free = t->free_first;
+	t->free_first = i + 1;
+}
+
+/**********************************************/
+/* Semaphores, events and condition variables */
+/**********************************************/
+
+// A task that waits for a semaphore, an event or a condition variable is
+// taken off the run queues and parked on the object's wait queue, and
+// signalling it puts the task that has waited longest straight back on
+// its run queue, so neither costs more than a few list operations however
+// many tasks there are.  A semaphore hands its unit to the task it wakes,
+// so no other task can take it first, and if that task is suspended or
+// ends before it runs, the unit goes on to the next waiter; so does a
+// condition variable's signal.  A condition variable keeps no state:
+// waiting always waits, and a signal with no task waiting is lost.  As
+// tasks only switch when they yield, it needs no mutex.  All three belong
+// to the runtime context that made them, and their handles are only good
+// in that context.
+
+#define SYNC_SEMAPHORE 1
+#define SYNC_EVENT     2
+#define SYNC_CONDITION 3
+
+struct task_sync {
+	int kind;                  // SYNC_SEMAPHORE or SYNC_EVENT
+	int count;                 // units available, 1 if the event is set,
+	                           // always 0 for a condition variable
+	struct wait_queue waiting;
+};
+
+static struct task_sync *get_sync(char *where, uintptr_t h)
+/* the semaphore or event that handle h refers to */
+{
+	struct task_sync *s;
+
+	s = (struct task_sync *)handle_obj(&sync_handles, h);
+	if (s == NULL)
+		RTFatal("%s: not a semaphore, event or condition variable", where);
+	return s;
+}
+
+static int sync_wake(struct task_sync *s, uintptr_t h)
+/* wake the task that has waited longest for s (handle h), handing it a
+   semaphore's unit or a condition variable's signal. returns FALSE if no
+   task was waiting */
+{
+	int task;
+
+	task = s->waiting.first;
+	if (!wait_wake(&s->waiting, TRUE))
+		return FALSE;
+	tcb[task].unit_of = (s->kind != SYNC_EVENT) ? h : 0;
+	return TRUE;
+}
+
+static void sync_unwake(int task)
+/* task was woken by a semaphore, event or condition variable but hasn't
+   run since. if it was handed a unit or a signal, pass it on */
+{
+	struct task_sync *s;
+	uintptr_t h;
+
+	h = tcb[task].unit_of;
+	tcb[task].woken = FALSE;
+	tcb[task].unit_of = 0;
+	if (h == 0)
+		return;
+	s = (struct task_sync *)handle_obj(&sync_handles, h);
+	if (s != NULL && !sync_wake(s, h) && s->kind == SYNC_SEMAPHORE)
+		s->count++;
+}
+
+object sync_new(object x)
+/* x is {SYNC_SEMAPHORE, units}, {SYNC_EVENT, is_set} or
+   {SYNC_CONDITION, 0}. returns the new object's handle */
+{
+	s1_ptr args;
+	struct task_sync *s;
+	uintptr_t h;
+	int kind, count;
+
+	args = SEQ_PTR(x);
+	kind = get_int(args->base[1]);
+	count = get_int(args->base[2]);
+	if (kind != SYNC_SEMAPHORE && kind != SYNC_EVENT && kind != SYNC_CONDITION)
+		RTFatal("sync_new: unknown kind %d", kind);
+	if (count < 0)
+		RTFatal("semaphore_new: the count must not be negative");
+	s = (struct task_sync *)EMalloc(sizeof(struct task_sync));
+	s->kind = kind;
+	s->count = (kind == SYNC_EVENT) ? (count != 0) :
+			   (kind == SYNC_CONDITION) ? 0 : count;
+	s->waiting.first = -1;
+	s->waiting.last = -1;
+	h = handle_add(&sync_handles, s);
+	if (h == 0) {
+		EFree((char *)s);
+		RTFatal("sync_new: too many semaphores and events");
+	}
+	return MAKE_UINT(h);
+}
+
+object sync_wait(object x)
+/* x is a semaphore or event. returns 1 if the current task can go on, or 0
+   if it has been suspended until it can - the caller must then
+   task_yield() and call again */
+{
+	struct task_sync *s;
+
+	s = get_sync("task wait", get_pos_int("task wait", x));
+	if (tcb[current_task].woken) {
+		// it was handed the unit, or the event was set, while it waited
+		tcb[current_task].woken = FALSE;
+		tcb[current_task].unit_of = 0;
+		return ATOM_1;
+	}
+	if (s->count > 0) {
+		if (s->kind == SYNC_SEMAPHORE)
+			s->count--;
+		return ATOM_1;
+	}
+	wait_park(&s->waiting);
+	return ATOM_0;
+}
+
+object sync_post(object x)
+/* x is a semaphore, which gets another unit, an event, which is set, or a
+   condition variable, which wakes one waiting task */
+{
+	struct task_sync *s;
+	uintptr_t h;
+
+	h = get_pos_int("task signal", x);
+	s = get_sync("task signal", h);
+	if (s->kind == SYNC_SEMAPHORE) {
+		if (!sync_wake(s, h))
+			s->count++;
+	}
+	else if (s->kind == SYNC_CONDITION) {
+		sync_wake(s, h);
+	}
+	else {
+		s->count = 1;
+		while (sync_wake(s, h))
+			;
+	}
+	return ATOM_1;
+}
+
+object sync_clear(object x)
+/* x is an event, which is cleared */
+{
+	struct task_sync *s;
+
+	s = get_sync("event_clear", get_pos_int("event_clear", x));
+	if (s->kind == SYNC_EVENT)
+		s->count = 0;
+	return ATOM_1;
+}
+
+object sync_broadcast(object x)
+/* x is a condition variable. wakes every task waiting for it */
+{
+	struct task_sync *s;
+	int task;
+
+	s = get_sync("cond_broadcast", get_pos_int("cond_broadcast", x));
+	if (s->kind != SYNC_CONDITION)
+		RTFatal("cond_broadcast: not a condition variable");
+	while ((task = s->waiting.first) != -1) {
+		wait_wake(&s->waiting, TRUE);
+		tcb[task].unit_of = 0;  // (nothing to pass on if it's suspended)
+	}
+	return ATOM_1;
+}
+
+object sync_delete(object x)
+/* x is a semaphore, event or condition variable, which is freed */
+{
+	struct task_sync *s;
+	uintptr_t h;
+
+	h = get_pos_int("task delete", x);
+	s = get_sync("task delete", h);
+	if (s->waiting.first != -1)
+		RTFatal("a semaphore, event or condition variable can't be deleted while tasks wait for it");
+	handle_remove(&sync_handles, h);
+	EFree((char *)s);
+	return ATOM_1;
+}
+
+/************/
+/* Channels */
+/************/
+
+// A channel is a bounded queue of messages that any number of tasks send
+// to and one task receives from.  A task that sends to a full channel, or
+// receives from an empty one, is suspended until it can go on.
+//
+// In a backend built without EREENTRANT there is only one runtime context,
+// so a channel needs no lock, messages are passed by reference, and the
+// waiting tasks are parked on the channel's wait queues, as they are for
+// a semaphore.
+//
+// With EREENTRANT the tasks may belong to contexts running on different
+// threads (be_context.h), so a channel has a lock of its own and is
+// allocated with malloc() rather than from a storage cache.  Sending a
+// message takes over the sender's reference to it.  The parts of it that
+// nothing else refers to are handed to the receiver as they are: every
+// sequence block comes straight from malloc(), so the receiving context
+// can free it into its own storage cache later on.  Shared parts, and
+// parts with a delete routine, are copied.  Doubles are carved out of
+// bigger blocks that belong to the sending context, so they travel in
+// blocks of their own and are swapped for ones from the receiver's cache
+// when they arrive.  A waiting task is suspended with io_park() on a file
+// descriptor that is readable while the channel has a message (or room,
+// for a sender), so when all of a thread's tasks are waiting it sleeps in
+// the scheduler.  On Windows an event stands in for the file descriptor
+// and waiting blocks the whole thread.
+
+#ifdef EREENTRANT
+struct chan_event {
+	int set;            // is it signalled?
+#ifdef EWINDOWS
+	HANDLE event;       // manual-reset
+#else
+	int fd[2];          // fd[0] is readable while it's signalled
+#endif
+};
+#endif
+
+struct chan_message {
+	object obj;
+	int dbls;           // number of doubles still to move into a cache
+};
+
+struct channel {
+	int capacity;
+	int count;          // messages waiting
+	int head;           // queue index of the oldest one
+	int reserved;       // room promised to senders that are still copying
+	int closed;
+	struct chan_message *queue;
+#ifdef EREENTRANT
+	struct chan_event has_data;  // while count > 0, or it's closed
+	struct chan_event has_room;  // while there's room, or it's closed
+#ifdef EWINDOWS
+	CRITICAL_SECTION lock;
+#else
+	pthread_mutex_t lock;
+#endif
+#else
+	struct wait_queue receivers; // tasks waiting for a message
+	struct wait_queue senders;   // tasks waiting for room
+#endif
+};
+
+#ifndef EREENTRANT
+#define chan_lock(ch)
+#define chan_unlock(ch)
+#elif defined(EWINDOWS)
+#define chan_lock(ch) EnterCriticalSection(&(ch)->lock)
+#define chan_unlock(ch) LeaveCriticalSection(&(ch)->lock)
+#else
+#define chan_lock(ch) pthread_mutex_lock(&(ch)->lock)
+#define chan_unlock(ch) pthread_mutex_unlock(&(ch)->lock)
+#endif
+
+#ifdef EREENTRANT
+static int chan_event_init(struct chan_event *e)
+/* make a new event, not signalled. returns FALSE if it can't be made */
+{
+#if defined(EUNIX) && !defined(ELINUX)
+	int i;
+#endif
+
+	e->set = FALSE;
+#ifdef EWINDOWS
+	e->event = CreateEvent(NULL, TRUE, FALSE, NULL);
+	return e->event != NULL;
+#elif defined(ELINUX)
+	e->fd[0] = e->fd[1] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	return e->fd[0] != -1;
+#else
+	if (pipe(e->fd) == -1)
+		return FALSE;
+	for (i = 0; i < 2; i++) {
+		fcntl(e->fd[i], F_SETFL, fcntl(e->fd[i], F_GETFL) | O_NONBLOCK);
+		fcntl(e->fd[i], F_SETFD, FD_CLOEXEC);
+	}
+	return TRUE;
+#endif
+}
+
+static void chan_event_free(struct chan_event *e)
+{
+#ifdef EWINDOWS
+	CloseHandle(e->event);
+#else
+	close(e->fd[0]);
+	if (e->fd[1] != e->fd[0])
+		close(e->fd[1]);
+#endif
+}
+
+static void chan_event_set(struct chan_event *e, int on)
+/* signal e, or clear it. the channel must be locked */
+{
+#ifdef ELINUX
+	uint64_t n = 1;
+#elif defined(EUNIX)
+	char buff[8];
+#endif
+
+	if (on == e->set)
+		return;
+	e->set = on;
+#ifdef EWINDOWS
+	if (on)
+		SetEvent(e->event);
+	else
+		ResetEvent(e->event);
+#elif defined(ELINUX)
+	if (on)
+		n = write(e->fd[1], &n, sizeof(n));
+	else
+		n = read(e->fd[0], &n, sizeof(n));  // the count goes back to 0
+#else
+	buff[0] = 0;
+	if (on)
+		on = write(e->fd[1], buff, 1);
+	else
+		on = read(e->fd[0], buff, sizeof(buff));
+#endif
+}
+
+static void chan_event_wait(struct chan_event *e)
+/* block the calling thread until e is signalled */
+{
+#ifdef EWINDOWS
+	WaitForSingleObject(e->event, INFINITE);
+#else
+	struct pollfd pfd;
+
+	pfd.fd = e->fd[0];
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	while (poll(&pfd, 1, -1) < 0 && errno == EINTR)
+		;
+#endif
+}
+#endif
+
+static void chan_update(struct channel *ch)
+/* after a change to ch, let the tasks that wait for it know. ch must be
+   locked */
+{
+#ifdef EREENTRANT
+	chan_event_set(&ch->has_data, ch->count > 0 || ch->closed);
+	chan_event_set(&ch->has_room,
+				   ch->count + ch->reserved < ch->capacity || ch->closed);
+#else
+	if (ch->closed) {
+		while (wait_wake(&ch->receivers, FALSE))
+			;
+		while (wait_wake(&ch->senders, FALSE))
+			;
+		return;
+	}
+	if (ch->count > 0)
+		wait_wake(&ch->receivers, FALSE);
+	if (ch->count + ch->reserved < ch->capacity)
+		wait_wake(&ch->senders, FALSE);
+#endif
+}
+
+#ifdef EREENTRANT
+static object chan_double(eudouble d)
+/* a double in a block of its own, that any context can take over */
+{
+	d_ptr p;
+
+	p = (d_ptr)EMalloc(D_SIZE);
+	p->dbl = d;
+	p->ref = 1;
+	p->cleanup = 0;
+	return MAKE_DBL(p);
+}
+
+static object chan_copy(object x, int *dbls)
+/* a copy of x that nothing else refers to */
+{
+	s1_ptr s, c;
+	intptr_t i;
+
+	if (IS_ATOM_INT(x))
+		return x;
+	if (IS_ATOM_DBL(x)) {
+		*dbls += 1;
+		return chan_double(DBL_PTR(x)->dbl);
+	}
+	s = SEQ_PTR(x);
+	c = NewS1(s->length);
+	for (i = 1; i <= s->length; i++)
+		c->base[i] = chan_copy(s->base[i], dbls);
+	return MAKE_SEQ(c);
+}
+
+static object chan_take(object x, int *dbls)
+/* take over a reference to x for a message to another context. the parts
+   of x that only this reference leads to are moved, the rest is copied.
+   *dbls is increased by the number of doubles in the message */
+{
+	s1_ptr s;
+	object y;
+	intptr_t i;
+
+	if (IS_ATOM_INT(x))
+		return x;
+	if (IS_ATOM_DBL(x)) {
+		*dbls += 1;
+		y = chan_double(DBL_PTR(x)->dbl);
+		DeRefDS(x);
+		return y;
+	}
+	s = SEQ_PTR(x);
+	if (s->ref != 1 || s->cleanup != 0) {
+		y = chan_copy(x, dbls);
+		DeRefDS(x);
+		return y;
+	}
+	for (i = 1; i <= s->length; i++)
+		s->base[i] = chan_take(s->base[i], dbls);
+	return x;
+}
+
+static object chan_settle(object x, int *dbls)
+/* swap the doubles in a message from chan_take() for ones from the current
+   context's storage cache. *dbls is how many are left to find */
+{
+	s1_ptr s;
+	object y;
+	intptr_t i;
+
+	if (IS_ATOM_INT(x))
+		return x;
+	if (IS_ATOM_DBL(x)) {
+		*dbls -= 1;
+		y = NewDouble(DBL_PTR(x)->dbl);
+		EFree((char *)DBL_PTR(x));
+		return y;
+	}
+	s = SEQ_PTR(x);
+	for (i = 1; i <= s->length && *dbls > 0; i++)
+		s->base[i] = chan_settle(s->base[i], dbls);
+	return x;
+}
+#endif
+
+static int chan_reserve(struct channel *ch)
+/* keep room in ch for a message. returns 1 if there was some, 0 if ch is
+   full and -1 if it's closed */
+{
+	int r;
+
+	chan_lock(ch);
+	if (ch->closed) {
+		r = -1;
+	}
+	else if (ch->count + ch->reserved < ch->capacity) {
+		ch->reserved++;
+		chan_update(ch);
+		r = 1;
+	}
+	else {
+		r = 0;
+	}
+	chan_unlock(ch);
+	return r;
+}
+
+static void chan_put(struct channel *ch, object msg)
+/* send msg through ch, in the room that chan_reserve() kept for it.
+   the caller's reference to msg is taken over */
+{
+	int i, dbls;
+
+	dbls = 0;
+#ifdef EREENTRANT
+	// (not while ch is locked - dropping a reference can run a
+	// delete routine)
+	msg = chan_take(msg, &dbls);
+#endif
+	chan_lock(ch);
+	i = (ch->head + ch->count) % ch->capacity;
+	ch->queue[i].obj = msg;
+	ch->queue[i].dbls = dbls;
+	ch->count++;
+	ch->reserved--;
+	chan_update(ch);
+	chan_unlock(ch);
+}
+
+static int chan_get(struct channel *ch, object *msg)
+/* take the oldest message out of ch. returns 1 if there was one, 0 if ch
+   is empty and -1 if it's empty and closed */
+{
+	int r;
+#ifdef EREENTRANT
+	int dbls;
+
+	dbls = 0;
+#endif
+	chan_lock(ch);
+	if (ch->count > 0) {
+		*msg = ch->queue[ch->head].obj;
+#ifdef EREENTRANT
+		dbls = ch->queue[ch->head].dbls;
+#endif
+		ch->head = (ch->head + 1) % ch->capacity;
+		ch->count--;
+		chan_update(ch);
+		r = 1;
+	}
+	else {
+		r = ch->closed ? -1 : 0;
+	}
+	chan_unlock(ch);
+#ifdef EREENTRANT
+	if (dbls > 0)
+		*msg = chan_settle(*msg, &dbls);
+#endif
+	return r;
+}
+
+struct channel *eu_channel_new(int capacity)
+/* a new, empty channel with room for capacity messages, or NULL if it
+   can't be made */
+{
+	struct channel *ch;
+
+	ch = (struct channel *)malloc(sizeof(struct channel));
+	if (ch == NULL)
+		return NULL;
+	ch->queue = (struct chan_message *)malloc(
+								capacity * sizeof(struct chan_message));
+	if (ch->queue == NULL) {
+		free(ch);
+		return NULL;
+	}
+#ifdef EREENTRANT
+	if (!chan_event_init(&ch->has_data)) {
+		free(ch->queue);
+		free(ch);
+		return NULL;
+	}
+	if (!chan_event_init(&ch->has_room)) {
+		chan_event_free(&ch->has_data);
+		free(ch->queue);
+		free(ch);
+		return NULL;
+	}
+#ifdef EWINDOWS
+	InitializeCriticalSection(&ch->lock);
+#else
+	pthread_mutex_init(&ch->lock, NULL);
+#endif
+#else
+	ch->receivers.first = ch->receivers.last = -1;
+	ch->senders.first = ch->senders.last = -1;
+#endif
+	ch->capacity = capacity;
+	ch->count = 0;
+	ch->head = 0;
+	ch->reserved = 0;
+	ch->closed = FALSE;
+	chan_update(ch);
+	return ch;
+}
+
+#ifdef EREENTRANT
+int eu_channel_send(struct channel *ch, object msg)
+/* send msg, blocking the thread while ch is full. the caller's reference
+   to msg is taken over. returns FALSE if ch is closed */
+{
+	int r;
+
+	while ((r = chan_reserve(ch)) == 0)
+		chan_event_wait(&ch->has_room);
+	if (r < 0) {
+		DeRef(msg);
+		return FALSE;
+	}
+	chan_put(ch, msg);
+	return TRUE;
+}
+
+int eu_channel_receive(struct channel *ch, object *msg)
+/* receive the next message into *msg, blocking the thread while ch is
+   empty. returns FALSE once ch is closed and empty */
+{
+	int r;
+
+	while ((r = chan_get(ch, msg)) == 0)
+		chan_event_wait(&ch->has_data);
+	return r > 0;
+}
+#endif
+
+void eu_channel_close(struct channel *ch)
+/* no more messages can be sent through ch. the ones already sent can
+   still be received */
+{
+	chan_lock(ch);
+	ch->closed = TRUE;
+	chan_update(ch);
+	chan_unlock(ch);
+}
+
+void eu_channel_delete(struct channel *ch)
+/* free ch and any messages left in it. nothing may be using ch */
+{
+	object msg;
+
+#ifndef EREENTRANT
+	if (ch->receivers.first != -1 || ch->senders.first != -1)
+		RTFatal("a channel can't be deleted while tasks wait for it");
+#endif
+	ch->closed = TRUE;
+	while (chan_get(ch, &msg) > 0)
+		DeRef(msg);
+#ifdef EREENTRANT
+	chan_event_free(&ch->has_data);
+	chan_event_free(&ch->has_room);
+#ifdef EWINDOWS
+	DeleteCriticalSection(&ch->lock);
+#else
+	pthread_mutex_destroy(&ch->lock);
+#endif
+#endif
+	free(ch->queue);
+	free(ch);
+}
+
+// channel handles are good in every context, so with EREENTRANT their
+// table is shared by all the threads
+static struct handle_table channel_handles;
+
+#ifndef EREENTRANT
+#define chan_table_lock()
+#define chan_table_unlock()
+#elif defined(EWINDOWS)
+static volatile LONG chan_table_busy = 0;
+#define chan_table_lock() while (InterlockedExchange(&chan_table_busy, 1)) Sleep(0)
+#define chan_table_unlock() InterlockedExchange(&chan_table_busy, 0)
+#else
+static pthread_mutex_t chan_table_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define chan_table_lock() pthread_mutex_lock(&chan_table_mutex)
+#define chan_table_unlock() pthread_mutex_unlock(&chan_table_mutex)
+#endif
+
+static struct channel *get_channel(char *where, object x)
+/* the channel that handle x refers to */
+{
+	struct channel *ch;
+
+	chan_table_lock();
+	ch = (struct channel *)handle_obj(&channel_handles, get_pos_int(where, x));
+	chan_table_unlock();
+	if (ch == NULL)
+		RTFatal("%s: not a channel", where);
+	return ch;
+}
+
+object channel_new(object x)
+/* x is the capacity. returns the new channel's handle */
+{
+	uintptr_t capacity, h;
+	struct channel *ch;
+
+	capacity = get_pos_int("channel_new", x);
+	if (capacity < 1 || capacity > INT_MAX / sizeof(struct chan_message))
+		RTFatal("channel_new: the capacity must be from 1 to %d",
+				(int)(INT_MAX / sizeof(struct chan_message)));
+	ch = eu_channel_new((int)capacity);
+	if (ch == NULL)
+		RTFatal("channel_new: couldn't make a channel");
+	chan_table_lock();
+	h = handle_add(&channel_handles, ch);
+	chan_table_unlock();
+	if (h == 0) {
+		eu_channel_delete(ch);
+		RTFatal("channel_new: too many channels");
+	}
+	return MAKE_UINT(h);
+}
+
+object channel_send(object x)
+/* x is {channel, message}. returns 1 once the message is sent, or 0 if
+   the channel is closed. returns -1 if the channel is full and the current
+   task has been suspended until there's room - the caller must then
+   task_yield() and call again */
+{
+	s1_ptr args;
+	struct channel *ch;
+	object msg;
+	int r;
+
+	args = SEQ_PTR(x);
+	ch = get_channel("channel_send", args->base[1]);
+	while ((r = chan_reserve(ch)) == 0) {
+#ifndef EREENTRANT
+		wait_park(&ch->senders);
+		return ATOM_M1;
+#elif defined(EWINDOWS)
+		chan_event_wait(&ch->has_room);
+#else
+		if (io_park(ch->has_room.fd[0], TASK_IO_READ))
+			return ATOM_M1;
+#endif
+	}
+	if (r < 0)
+		return ATOM_0;
+
+	// if x is a temporary, its reference to the message can be taken over.
+	// (from Euphoria the sender's own variables still refer to the message,
+	// so it is copied anyway: only eu_channel_send() really moves one)
+	msg = args->base[2];
+	if (args->ref == 1)
+		args->base[2] = ATOM_0;
+	else
+		Ref(msg);
+	chan_put(ch, msg);
+	return ATOM_1;
+}
+
+object channel_receive(object x)
+/* x is a channel. returns {message}, or {} if the channel is closed and
+   empty. returns -1 if the channel is empty and the current task has been
+   suspended until it isn't - the caller must then task_yield() and call
+   again */
+{
+	struct channel *ch;
+	object msg;
+	s1_ptr result;
+	int r;
+
+	ch = get_channel("channel_receive", x);
+	while ((r = chan_get(ch, &msg)) == 0) {
+#ifndef EREENTRANT
+		wait_park(&ch->receivers);
+		return ATOM_M1;
+#elif defined(EWINDOWS)
+		chan_event_wait(&ch->has_data);
+#else
+		if (io_park(ch->has_data.fd[0], TASK_IO_READ))
+			return ATOM_M1;
+#endif
+	}
+	if (r < 0)
+		return MAKE_SEQ(NewS1(0));
+	result = NewS1(1);
+	result->base[1] = msg;
+	return MAKE_SEQ(result);
+}
+
+object channel_close(object x)
+/* x is a channel */
+{
+	eu_channel_close(get_channel("channel_close", x));
+	return ATOM_1;
+}
+
+object channel_delete(object x)
+/* x is a channel */
+{
+	struct channel *ch;
+	uintptr_t h;
+
+	h = get_pos_int("channel_delete", x);
+	chan_table_lock();
+	ch = (struct channel *)handle_obj(&channel_handles, h);
+	if (ch != NULL)
+		handle_remove(&channel_handles, h);
+	chan_table_unlock();
+	if (ch == NULL)
+		RTFatal("channel_delete: not a channel");
+	eu_channel_delete(ch);
+	return ATOM_1;
+}
+
+#ifndef ERUNTIME
+object task_create(object r_id, object args)
+// Create a new task for the interpreter - return a double task id - assumed by Translator
+{
+	symtab_ptr sub;
+	struct tcb_entry *new_entry;
+	int recycle, proc_args;
+	double id;
+	
+	
+	
+	r_id = (object)get_pos_int("task_create", r_id);
+
+  
+	if ( r_id >= e_routine_next)
+		RTFatal("invalid routine id");
+	sub = e_routine[r_id];
+	
+	if (sub->token != PROC) {
+		RTFatal("specify the routine id of a procedure, not a function or type");
+	} 
+	
+	if (!IS_SEQUENCE(args))
+		RTFatal("Argument list must be a sequence");
+
+	proc_args = sub->u.subp.num_args; 
+	
+	if (SEQ_PTR(args)->length != proc_args) {
+		RTFatal("Incorrect number of arguments (passing %d where %d are expected)",
+				SEQ_PTR(args)->length, proc_args);
+	}
+	
+	// try to pick ST_DEAD task with biggest stack space
+	// (this mainly helps translated code, but also helps interpeter)
+	recycle = dead_take(TRUE);
+	
 	if (recycle == -1) {
 		// nothing is ST_DEAD, must expand the tcb
-		tcb_size++;
-		// n.b. tcb could get moved because of this:
-		tcb = (struct tcb *)ERealloc((char *)tcb, sizeof(struct tcb) * tcb_size);
-		new_entry = &tcb[tcb_size-1];
+		recycle = tcb_new_entry();
+		new_entry = &tcb[recycle];
 	}
 	else {
 		// found a ST_DEAD task
 		// release the call stack 
-		if (tcb[recycle].impl.interpreted.expr_stack != NULL) {
-			EFree((char *)tcb[recycle].impl.interpreted.expr_stack);
-		}
+		FreeStack(tcb[recycle].impl.interpreted.segment);
 		DeRef(tcb[recycle].args);
+		tid_remove(recycle);
 		new_entry = &tcb[recycle];
 	}
 	
@@ -763,6 +2296,18 @@ object task_create(object r_id, object args)
 	new_entry->runs_left = 1;
 	new_entry->runs_max = 1;
 	new_entry->next = -1; 
+	new_entry->prev = -1;
+	new_entry->queue = Q_NONE;
+	new_entry->heap_pos = -1;
+	new_entry->waiting = NULL;
+	new_entry->woken = FALSE;
+	new_entry->unit_of = 0;
+	new_entry->run_start = 0.0;
+	new_entry->cpu_time = 0.0;
+	new_entry->runs = 0.0;
+	new_entry->late_total = 0.0;
+	new_entry->late_max = 0.0;
+	new_entry->waited = 0.0;
 	new_entry->mode = INTERPRETED_TASK;
 	
 	new_entry->args = args;
@@ -772,45 +2317,38 @@ object task_create(object r_id, object args)
 	new_entry->impl.interpreted.pc = NULL;
 
 
-	new_entry->impl.interpreted.expr_max = NULL;
-	new_entry->impl.interpreted.expr_limit = NULL;
-	new_entry->impl.interpreted.expr_top = NULL;
-	new_entry->impl.interpreted.expr_stack = NULL;
-	new_entry->impl.interpreted.stack_size = 0;
+	new_entry->impl.interpreted.stack_max = NULL;
+	new_entry->impl.interpreted.stack_limit = NULL;
+	new_entry->impl.interpreted.stack_top = NULL;
+	new_entry->impl.interpreted.stack = NULL;
+	new_entry->impl.interpreted.segment = NULL;
+	new_entry->impl.interpreted.stack_length = 0;
 	
 	id = next_task_id;
+	tid_add(recycle);
 	
 	// choose task id for next time
-	if (!id_wrap && next_task_id < TASK_ID_MAX) {
-		next_task_id += 1.0;
-	}
-	else {
-		// extremely rare
-		id_wrap = TRUE;  // id's have wrapped
-		for (t = 1.0; t <= TASK_ID_MAX; t += 1.0) { 
-			next_task_id = t;
-			for (j = 0; j < tcb_size; j++) {
-				if (next_task_id == tcb[j].tid) {
-					next_task_id = 0.0;
-					break;  // this id is still in use
-				}
-			}
-			if (next_task_id > 0) {
-				break;   // found unused id for next time
-			}
-		}
-		// must have found one - couldn't have trillions of non-dead tasks!
-	}
+	choose_next_task_id();
 	
 	return NewDouble(id);
 }
 #endif
 
-TASK_HANDLE stale_task = 0;
-
 void release_task( TASK_HANDLE task ){
 	#ifdef EWINDOWS
 	DeleteFiber( task );
+	#elif defined(TASK_COROUTINES)
+	struct task_context *c = (struct task_context *)task;
+
+	if( free_context_count < TASK_STACK_CACHE ){
+		c->next_free = free_contexts;
+		free_contexts = c;
+		free_context_count++;
+	}
+	else{
+		munmap( c->stack, TASK_STACK_SIZE + page_size );
+		EFree( (char *)c );
+	}
 	#else
 	pthread_cancel( task );
 	#endif
@@ -823,14 +2361,80 @@ void release_task_later( TASK_HANDLE task ){
 	stale_task = task;
 }
 
+void FreeTasks()
+/* release the task table, the scheduler queues and the task stacks of the
+   current runtime context, which must not be running any more */
+{
+#ifdef ERUNTIME
+	int i;
+
+	for (i = 1; i < tcb_size; i++) {
+		if (tcb[i].impl.translated.task != (TASK_HANDLE)NULL &&
+			tcb[i].impl.translated.task != (TASK_HANDLE)stale_task)
+			release_task( tcb[i].impl.translated.task );
+	}
+	if (stale_task != NULL) {
+		release_task( stale_task );
+		stale_task = NULL;
+	}
+#ifdef TASK_COROUTINES
+	while (free_contexts != NULL) {
+		struct task_context *c = free_contexts;
+		free_contexts = c->next_free;
+		munmap( c->stack, TASK_STACK_SIZE + page_size );
+		EFree( (char *)c );
+	}
+	free_context_count = 0;
+	if (main_context != NULL) {
+		EFree( (char *)main_context );
+		main_context = NULL;
+	}
+#endif
+#else
+	int i;
+
+	// the current task's stack is expr_segment, which the caller frees
+	for (i = 0; i < tcb_size; i++) {
+		if (i != current_task)
+			FreeStack(tcb[i].impl.interpreted.segment);
+	}
+#endif
+	task_trace(ATOM_0);  // (finish any trace)
+	if (tcb != NULL)
+		EFree((char *)tcb);
+	if (rt_heap != NULL)
+		EFree((char *)rt_heap);
+	if (tid_table != NULL)
+		EFree((char *)tid_table);
+	if (sync_handles.slot != NULL)
+		free(sync_handles.slot);
+	sync_handles.slot = NULL;
+	sync_handles.size = sync_handles.used = sync_handles.free_first = 0;
+	tcb = NULL;
+	rt_heap = NULL;
+	tid_table = NULL;
+	tcb_size = tcb_alloc = rt_count = rt_heap_size = tid_table_size = 0;
+#ifdef EUNIX
+	if (io_waiters != NULL)
+		EFree((char *)io_waiters);
+	io_waiters = NULL;
+	io_waiting = io_waiters_size = 0;
+#ifdef ELINUX
+	if (epoll_fd >= 0)
+		close(epoll_fd);
+	epoll_fd = -1;
+#endif
+#endif
+}
+
 object ctask_create(object r_id, object args)
 // Create a new task for translated code - return a double task id - assumed by Translator
 {
 	
 	
-	struct tcb *new_entry;
-	int recycle, i, j, proc_args;
-	double id, t;
+	struct tcb_entry *new_entry;
+	int recycle, proc_args;
+	double id;
 	
 	
 	r_id = (object)get_pos_int("task_create", r_id);
@@ -849,29 +2453,17 @@ object ctask_create(object r_id, object args)
 				SEQ_PTR(args)->length, proc_args);
 	}
 	
-	recycle = -1;
-
-	for (i = 0; i < tcb_size; i++) { 
-    
-		if (tcb[i].status == ST_DEAD) {
-			// this task is dead, can recycle its entry 
-			// (but not its external task id)
-			recycle = i;
-			break;
-		}
-	}
+	recycle = dead_take(FALSE);
 	
 	if (recycle == -1) {
 		// nothing is ST_DEAD, must expand the tcb
-		tcb_size++;
-		// n.b. tcb could get moved because of this:
-		tcb = (struct tcb *)ERealloc((char *)tcb, sizeof(struct tcb) * tcb_size);
-		new_entry = &tcb[tcb_size-1];
-		recycle = tcb_size-1;
+		recycle = tcb_new_entry();
+		new_entry = &tcb[recycle];
 	}
 	else {
 		// found a ST_DEAD task
 		DeRef(tcb[recycle].args);
+		tid_remove(recycle);
 		new_entry = &tcb[recycle];
 		if( new_entry->mode == TRANSLATED_TASK && new_entry->impl.translated.task != 0 ){
 			if( recycle == current_task ){
@@ -898,6 +2490,18 @@ object ctask_create(object r_id, object args)
 	new_entry->runs_left = 1;
 	new_entry->runs_max = 1;
 	new_entry->next = -1;
+	new_entry->prev = -1;
+	new_entry->queue = Q_NONE;
+	new_entry->heap_pos = -1;
+	new_entry->waiting = NULL;
+	new_entry->woken = FALSE;
+	new_entry->unit_of = 0;
+	new_entry->run_start = 0.0;
+	new_entry->cpu_time = 0.0;
+	new_entry->runs = 0.0;
+	new_entry->late_total = 0.0;
+	new_entry->late_max = 0.0;
+	new_entry->waited = 0.0;
 	new_entry->mode = TRANSLATED_TASK;
 	
 	new_entry->args = args;
@@ -907,50 +2511,32 @@ object ctask_create(object r_id, object args)
 	new_entry->impl.translated.task = (TASK_HANDLE) NULL;
 
 	id = next_task_id;
+	tid_add(recycle);
 	
 	// choose task id for next time
-	if (!id_wrap && next_task_id < TASK_ID_MAX) {
-		next_task_id += 1.0;
-	}
-	else {
-		// extremely rare
-		id_wrap = TRUE;  // id's have wrapped
-		for (t = 1.0; t <= TASK_ID_MAX; t += 1.0) { 
-			next_task_id = t;
-			for (j = 0; j < tcb_size; j++) {
-				if (next_task_id == tcb[j].tid) {
-					next_task_id = 0.0;
-					break;  // this id is still in use
-				}
-			}
-			if (next_task_id > 0) {
-				break;   // found unused id for next time
-			}
-		}
-		// must have found one - couldn't have trillions of non-dead tasks!
-	}
+	choose_next_task_id();
 	init_task( recycle );
 	return NewDouble(id);
 }
 
 // put these scheduler vars here for translated code, to avoid register 
 // and/or stack corruption complications
-static int earliest_task; 
 
 void run_task( int tx ){
 #ifndef ERUNTIME
 	static intptr_t **code[3];
 	if( tcb[tx].mode == INTERPRETED_TASK ){
-		struct tcb *tp;
+		struct tcb_entry *tp;
 		
 		// save current stack info
 		tp = &tcb[current_task];
 		tp->impl.interpreted.pc = tpc; 
-		tp->impl.interpreted.expr_stack = expr_stack;
-		tp->impl.interpreted.expr_max   = expr_max; 
-		tp->impl.interpreted.expr_limit = expr_limit;
-		tp->impl.interpreted.expr_top   = expr_top;   
-		tp->impl.interpreted.stack_size = stack_size;
+		tp->impl.interpreted.stack = expr_stack;
+		tp->impl.interpreted.segment = expr_segment;
+		tp->impl.interpreted.stack_max   = expr_max; 
+		tp->impl.interpreted.stack_limit = expr_limit;
+		tp->impl.interpreted.stack_top   = expr_top;   
+		tp->impl.interpreted.stack_length = stack_size;
 		
 		// load new task 
 		
@@ -960,7 +2546,7 @@ void run_task( int tx ){
 			// first time we are running this task - no stack to restore
 			// call its procedure, passing the args from task_create
 
-			InitStack(EXPR_SIZE, 0); // create its call stack
+			InitStack(TASK_EXPR_SIZE, 0); // create its call stack
 			
 			// re-entrant? - ok, we use code right away
 			// infinite calls to scheduler?
@@ -975,11 +2561,12 @@ void run_task( int tx ){
 			// set up stack
 			tp = &tcb[earliest_task];
 			tpc = tp->impl.interpreted.pc;
-			expr_stack = tp->impl.interpreted.expr_stack;
-			expr_max = tp->impl.interpreted.expr_max;
-			expr_limit = tp->impl.interpreted.expr_limit;
-			expr_top = tp->impl.interpreted.expr_top;
-			stack_size = tp->impl.interpreted.stack_size;
+			expr_stack = tp->impl.interpreted.stack;
+			expr_segment = tp->impl.interpreted.segment;
+			expr_max = tp->impl.interpreted.stack_max;
+			expr_limit = tp->impl.interpreted.stack_limit;
+			expr_top = tp->impl.interpreted.stack_top;
+			stack_size = tp->impl.interpreted.stack_length;
 			restore_privates((symtab_ptr)expr_top[-1]);
 			tpc += 1;    
 		}
@@ -1008,7 +2595,7 @@ static void run_current_task( int task ){
 }
 
 void WINAPI exec_task( void *task ){
-	struct tcb *t = &tcb[(intptr_t)task];
+	struct tcb_entry *t = &tcb[(intptr_t)task];
 
 	call_task( t->rid, t->args );
 }
@@ -1018,6 +2605,130 @@ static void init_task( intptr_t tx ){
 	tcb[tx].impl.translated.task = (TASK_HANDLE) CreateFiber( 0, exec_task, (void *)tx );
 }
 
+#elif defined(TASK_COROUTINES)
+
+#ifdef TASK_SWITCH_ASM
+void eu_task_switch( void **save_sp, void *new_sp );
+
+// Saves the callee-saved registers and the floating point control words
+// on this stack, switches stacks, and restores them from the new one.
+__asm__(
+	".text\n"
+	".globl eu_task_switch\n"
+	".hidden eu_task_switch\n"
+	".type eu_task_switch, @function\n"
+"eu_task_switch:\n"
+	"pushq %rbp\n"
+	"pushq %rbx\n"
+	"pushq %r12\n"
+	"pushq %r13\n"
+	"pushq %r14\n"
+	"pushq %r15\n"
+	"subq $8, %rsp\n"
+	"stmxcsr (%rsp)\n"
+	"fnstcw 4(%rsp)\n"
+	"movq %rsp, (%rdi)\n"
+	"movq %rsi, %rsp\n"
+	"ldmxcsr (%rsp)\n"
+	"fldcw 4(%rsp)\n"
+	"addq $8, %rsp\n"
+	"popq %r15\n"
+	"popq %r14\n"
+	"popq %r13\n"
+	"popq %r12\n"
+	"popq %rbx\n"
+	"popq %rbp\n"
+	"ret\n"
+	".size eu_task_switch, .-eu_task_switch\n"
+);
+#endif
+
+/**
+ * This is where a new task starts, on its own stack.  call_task() never
+ * returns - when the task ends, the scheduler switches to another one.
+ */
+static void start_task(){
+	call_task( tcb[current_task].rid, tcb[current_task].args );
+}
+
+/**
+ * Gives the task a stack, and a context that will start it.
+ */
+static void init_task( intptr_t tx ){
+	struct task_context *c;
+#ifdef TASK_SWITCH_ASM
+	void **sp;
+	uint32_t mxcsr;
+	uint16_t fpucw;
+#endif
+
+	if( free_contexts != NULL ){
+		c = free_contexts;
+		free_contexts = c->next_free;
+		free_context_count--;
+	}
+	else{
+		if( page_size == 0 ){
+			page_size = (size_t)sysconf( _SC_PAGESIZE );
+		}
+		c = (struct task_context *)EMalloc( sizeof(struct task_context) );
+		c->stack = (char *)mmap( NULL, TASK_STACK_SIZE + page_size, PROT_READ | PROT_WRITE,
+								 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0 );
+		if( c->stack == (char *)MAP_FAILED ){
+			EFree( (char *)c );
+			RTFatal( "couldn't allocate a stack for a new task" );
+		}
+		// running off the end of the stack faults, instead of overwriting
+		// memory. The guard page makes the stack two mappings, and the system
+		// limits how many a process can have (65530 on Linux by default)
+		if( mprotect( c->stack, page_size, PROT_NONE ) != 0 ){
+			munmap( c->stack, TASK_STACK_SIZE + page_size );
+			EFree( (char *)c );
+			RTFatal( "couldn't allocate a stack for a new task" );
+		}
+	}
+
+#ifdef TASK_SWITCH_ASM
+	// what eu_task_switch() expects to find, returning into start_task()
+	sp = (void **)(c->stack + page_size + TASK_STACK_SIZE);
+	*--sp = NULL;  // keeps start_task()'s frame aligned as if it were called
+	*--sp = (void *)&start_task;
+	*--sp = NULL;  // rbp
+	*--sp = NULL;  // rbx
+	*--sp = NULL;  // r12
+	*--sp = NULL;  // r13
+	*--sp = NULL;  // r14
+	*--sp = NULL;  // r15
+	__asm__ volatile( "stmxcsr %0" : "=m" (mxcsr) );
+	__asm__ volatile( "fnstcw %0" : "=m" (fpucw) );
+	*--sp = (void *)((uintptr_t)mxcsr | ((uintptr_t)fpucw << 32));
+	c->sp = (void *)sp;
+#else
+	getcontext( &c->uc );
+	c->uc.uc_stack.ss_sp = c->stack + page_size;
+	c->uc.uc_stack.ss_size = TASK_STACK_SIZE;
+	c->uc.uc_link = NULL;
+	makecontext( &c->uc, start_task, 0 );
+#endif
+	tcb[tx].impl.translated.task = (TASK_HANDLE)c;
+}
+
+/**
+ * Saves the current task's registers and continues @task where it left off.
+ */
+static void run_current_task( int task ){
+	struct task_context *from, *to;
+
+	from = (struct task_context *)tcb[current_task].impl.translated.task;
+	to = (struct task_context *)tcb[task].impl.translated.task;
+	current_task = task;
+#ifdef TASK_SWITCH_ASM
+	eu_task_switch( &from->sp, to->sp );
+#else
+	swapcontext( &from->uc, &to->uc );
+#endif
+}
+
 #else
 
 /**
@@ -1063,17 +2774,142 @@ static void run_current_task( int task ){
 }
 #endif
 
+static char *task_name(int task)
+// the name of a task's routine
+{
+	if (tcb[task].rid < 0)
+		return "main";
+#ifdef ERUNTIME
+	return _00[tcb[task].rid].name;
+#else
+	return e_routine[tcb[task].rid]->name;
+#endif
+}
+
+static void trace_event(int task, char *name, double from, double to)
+// add a complete event for something task did between from and to to the
+// trace. ts and dur are in microseconds
+{
+	if (from < sched_trace_origin)
+		from = sched_trace_origin;
+	fprintf((FILE *)sched_trace,
+			"%s{\"name\":\"%s\",\"cat\":\"task\",\"ph\":\"X\",\"ts\":%.3f,"
+			"\"dur\":%.3f,\"pid\":1,\"tid\":%.0f}",
+			sched_trace_count++ ? ",\n" : "", name,
+			(from - sched_trace_origin) * 1000000.0, (to - from) * 1000000.0,
+			tcb[task].tid);
+}
+
+static void run_ended(double now)
+// the current task has stopped running at time now
+{
+	tcb[current_task].cpu_time += now - tcb[current_task].run_start;
+	if (sched_trace != NULL) {
+		trace_event(current_task, task_name(current_task),
+					tcb[current_task].run_start, now);
+	}
+}
+
+static void run_begins(int task, double now, double waited)
+// task is about to run, after the scheduler waited for it for waited
+// seconds
+{
+	double late;
+
+	if (tcb[task].type == T_REAL_TIME && now > tcb[task].max_time) {
+		late = now - tcb[task].max_time;
+		tcb[task].late_total += late;
+		if (late > tcb[task].late_max)
+			tcb[task].late_max = late;
+	}
+	tcb[task].runs += 1.0;
+	tcb[task].waited += waited;
+	tcb[task].run_start = now;
+	if (sched_trace != NULL && waited > 0.0)
+		trace_event(task, "wait", now - waited, now);
+}
+
+object task_stats(object a)
+// statistics for a task: {cpu time, runs, total lateness, maximum lateness,
+// time waited for}
+{
+	double tid;
+	int task;
+	s1_ptr result;
+	double cpu;
+
+	if (IS_ATOM_INT(a)) {
+		tid = (double)a;
+	}
+	else if (IS_ATOM(a)) {
+		tid = DBL_PTR(a)->dbl;
+	}
+	else {
+		RTFatal("a task id must be an atom");
+	}
+	task = which_task(tid);
+
+	cpu = tcb[task].cpu_time;
+	if (task == current_task) {
+		// and its run so far
+		cpu += current_time() - tcb[task].run_start;
+	}
+	result = NewS1(5);
+	result->base[1] = NewDouble((eudouble)cpu);
+	result->base[2] = NewDouble((eudouble)tcb[task].runs);
+	result->base[3] = NewDouble((eudouble)tcb[task].late_total);
+	result->base[4] = NewDouble((eudouble)tcb[task].late_max);
+	result->base[5] = NewDouble((eudouble)tcb[task].waited);
+	return MAKE_SEQ(result);
+}
+
+object task_trace(object x)
+// x is the name of a file to write a trace of task runs to, in the Chrome
+// trace event format, or an atom to stop tracing. returns 0 if the file
+// can't be opened
+{
+	char *name;
+	int len;
+
+	if (sched_trace != NULL) {
+		fputs("\n]\n", (FILE *)sched_trace);
+		fclose((FILE *)sched_trace);
+		sched_trace = NULL;
+	}
+	if (IS_ATOM(x))
+		return ATOM_1;
+
+	len = SEQ_PTR(x)->length + 1;
+	name = EMalloc(len);
+	MakeCString(name, x, len);
+	sched_trace = fopen(name, "w");
+	EFree(name);
+	if (sched_trace == NULL)
+		return ATOM_0;
+	fputs("[\n", (FILE *)sched_trace);
+	sched_trace_origin = current_time();
+	sched_trace_count = 0;
+	return ATOM_1;
+}
+
 void scheduler(double now)
 // pick the next task to run
 {
-	double earliest_time, start_time;
-	int ts_found;
-	struct tcb *tp;
-	int p;
+	double start_time, entered, waited, t;
 
-	
+	entered = now;
+	waited = 0.0;
+	run_ended(now);  // (if it's chosen again, it's a new run)
+
+#ifdef EUNIX
+	if (io_waiting) {
+		// let tasks whose I/O is ready compete
+		io_poll(0.0);
+	}
+  choose:
+#endif
 	// find the task with the earliest MAX_TIME
-	earliest_task = rt_first;
+	earliest_task = (rt_count > 0) ? rt_heap[0] : -1;
 	
 	if (clock_stopped || earliest_task == -1) {
 		// no real-time tasks are active
@@ -1082,18 +2918,6 @@ void scheduler(double now)
 	}
 	else {
 		// choose a real-time task
-		earliest_time = tcb[earliest_task].max_time;
-		
-		p = tcb[rt_first].next;
-		while (p != -1) {
-			tp = &tcb[p];
-			if (tp->max_time < earliest_time) {
-				earliest_task = p;
-				earliest_time = tp->max_time;
-			}
-			p = tp->next;
-		}
-		
 		// when can we start? how many runs?
 		start_time = tcb[earliest_task].min_time;
 		
@@ -1113,45 +2937,56 @@ void scheduler(double now)
 		// No real-time task is ready to run.
 		// Look for a time-share task.
 		
-		ts_found = FALSE;
-		p = ts_first;
-
-		while (p != -1) {
-			tp = &tcb[p];
-			if (tp->runs_left > 0) {
-				  earliest_task = p;
-				  ts_found = TRUE;
-				  break;
-			}
-			p = tp->next;
+		if (ready_first == -1) {
+			// all time-share tasks are at zero, recharge them all
+			ts_recharge();
 		}
-		
-		if (!ts_found) {
-			// all time-share tasks are at zero, recharge them all, 
-			// and choose one to run
-			p = ts_first;
-			while (p != -1) {
-				tp = &tcb[p];
-				earliest_task = p;
-				tcb[p].runs_left = tp->runs_max;
-				p = tp->next;
-			}
+		if (ready_first != -1) {
+			earliest_task = ready_first;
 		}
 			
 		if (earliest_task == -1) {
+#ifdef EUNIX
+			if (io_waiting) {
+				// every task is waiting for I/O
+				t = current_time();
+				io_poll(-1.0);
+				now = current_time();
+				waited += now - t;
+				goto choose;
+			}
+#endif
 			// no tasks are active - no task will ever run again
 			// RTFatal("no task to run") ??
 			Cleanup(0);
 		}
 			
 		if (tcb[earliest_task].type == T_REAL_TIME) {
+#ifdef EUNIX
+			if (io_waiting) {
+				t = now;
+				if (io_poll(start_time - now) > 0) {
+					// I/O became ready before this task was due
+					now = current_time();
+					waited += now - t;
+					goto choose;
+				}
+				now = current_time();
+				waited += now - t;
+			}
+#endif
 			// no time-sharing tasks, Wait and run this real-time task
+			t = now;
 			now = Wait(start_time - now);
+			waited += now - t;
 		}
 	}
 
 	/* we've chosen the task - now switch to it */
 
+	// (the time spent choosing is counted as part of its run)
+	run_begins(earliest_task, (waited > 0.0) ? current_time() : entered,
+			   waited);
 	tcb[earliest_task].start = now; //current_time(); 
 	
 	if (earliest_task == current_task) {
@@ -3,8 +3,6 @@
 
 #include "execute.h"
 
-extern int tcb_size;
-extern int current_task;
 extern double clock_period;
 
 enum task_mode {
@@ -17,28 +15,43 @@ enum task_mode {
 #define TASK_NEVER 1e300
 #define TASK_ID_MAX 9e15 // wrap to 0 after this (and avoid in-use ones)
 
+// events for task_io_wait()
+#define TASK_IO_READ 1
+#define TASK_IO_WRITE 2
+
 #ifdef EWINDOWS
 #include <windows.h>
 
 // Address to a fiber:
 #define TASK_HANDLE LPVOID
 
-#else
+#elif defined(EOSX)
 
 #include <pthread.h>
 
 // PThread handle:
 #define TASK_HANDLE pthread_t
 
+#else
+
+// Translated tasks are coroutines, each with a stack of its own
+#define TASK_COROUTINES
+
+// Address of its saved context:
+#define TASK_HANDLE void *
+
 #endif
 
+struct stack_segment;
+
 struct interpreted_task{
 	intptr_t *pc;         // program counter for this task
-	object_ptr expr_stack; // call stack for this task
-	object_ptr expr_max;   // current top limit of stack
-	object_ptr expr_limit; // don't start a new routine above this
-	object_ptr expr_top;   // stack pointer
-	int stack_size;        // current size of stack
+	object_ptr stack;       // call stack for this task (its current segment)
+	struct stack_segment *segment; // the segment stack is in
+	object_ptr stack_max;   // current top limit of stack
+	object_ptr stack_limit; // don't start a new routine above this
+	object_ptr stack_top;   // stack pointer
+	int stack_length;       // current size of stack
 };
 
 struct translated_task{
@@ -46,8 +59,15 @@ struct translated_task{
 	
 };
 
+// tasks waiting for a semaphore, event or channel, oldest first, linked
+// through tcb.next and tcb.prev
+struct wait_queue {
+	int first;
+	int last;
+};
+
 // Task Control Block - sync with euphoria\include\euphoria.h
-struct tcb {
+struct tcb_entry {
 	int rid;         // routine id
 	double tid;      // external task id
 	int type;        // type of task: T_REAL_TIME or T_TIME_SHARED
@@ -60,7 +80,7 @@ struct tcb {
 	double max_time; // maximum activation time (determines task order)
 	int runs_left;   // number of executions left in this burst
 	int runs_max;    // maximum number of executions in one burst
-	int next;        // index of next task of the same kind
+	int next;        // index of next task on the same queue
 	object args;     // args to call task procedure with at startup
 	
 	int mode;  // TRANSLATED_TASK or INTERPRETED_TASK
@@ -69,9 +89,21 @@ struct tcb {
 		struct translated_task translated;
 	} impl;
 	
-};
+	int prev;        // index of previous task on the same time-share queue
+	int queue;       // which scheduler queue the task is on, if any
+	int heap_pos;    // position in the real-time heap
+	struct wait_queue *waiting; // the wait queue it's on, if queue is Q_WAIT
+	int woken;       // was it handed what it waited for when woken?
+	uintptr_t unit_of; // while woken, the semaphore whose unit it was handed
 
-extern struct tcb *tcb;
+	// statistics, for task_stats()
+	double run_start;  // when its current or last run began
+	double cpu_time;   // seconds it has run for
+	double runs;       // number of times it has been run
+	double late_total; // seconds its runs began after max_time, in all
+	double late_max;   // ... and at most
+	double waited;     // seconds the scheduler waited before running it
+};
 
 // TASK API:
 void task_yield();
@@ -79,12 +111,41 @@ void task_schedule(object task, object sparams);
 void task_suspend(object a);
 object task_list();
 object task_status(object a);
+object task_self();
 void task_clock_stop();
 void task_clock_start();
 object task_create(object r_id, object args);
+object task_io_wait(object x);
+object task_wait_spin(object x);
+object channel_new(object x);
+object channel_send(object x);
+object channel_receive(object x);
+object channel_close(object x);
+object channel_delete(object x);
+object sync_new(object x);
+object sync_wait(object x);
+object sync_post(object x);
+object sync_clear(object x);
+object sync_broadcast(object x);
+object sync_delete(object x);
+object task_stats(object a);
+object task_trace(object x);
 void InitTask();
+void FreeTasks();
 void terminate_task(int task);
 void scheduler(double now);
 void restore_privates(symtab_ptr this_routine);
 double Wait(double t);
+
+#ifdef EREENTRANT
+// Channels, for an application that runs Euphoria on several threads
+// (see be_context.h).  eu_channel_send() takes over the caller's reference
+// to msg, and the two that wait block the calling thread.
+struct channel;
+struct channel *eu_channel_new(int capacity);
+int eu_channel_send(struct channel *ch, object msg);
+int eu_channel_receive(struct channel *ch, object *msg);
+void eu_channel_close(struct channel *ch);
+void eu_channel_delete(struct channel *ch);
+#endif
 #endif
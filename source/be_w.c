@@ -462,6 +462,10 @@ void InitInOut()
     in_from_keyb  = isatty(0);
     out_to_screen = isatty(1);
     err_to_screen = isatty(2);
+    if (!out_to_screen) {
+        // redirected output is written in large blocks
+        setvbuf(stdout, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+    }
     screen_line = position.row;
     screen_col = position.col;
 
@@ -1027,13 +1031,35 @@ void screen_output(IFILE f, char *out_string)
     }
 }
 
+int output_to_screen(IFILE f)
+/* TRUE if screen_output() would treat output to f as screen output,
+   FALSE if f is simply a file that bytes can be written to */
+{
+    if (f == NULL || (intptr_t)f == DOING_SPRINTF)
+        return TRUE;
+    if (f != stdout && f != stderr)
+        return FALSE;
+#ifdef EUNIX
+    if (EuConsole)
+        return TRUE;
+    return (f == stdout && out_to_screen) ||
+           (f == stderr && err_to_screen && (!low_on_space || have_console));
+#else
+    return TRUE;
+#endif
+}
+
 void screen_output_va(IFILE f, char *out_string, va_list ap)
 {
 	int nsize;
 	char * buf;
+	va_list aq;
 
 	// figure out how long the string will be
-	nsize = vsnprintf(0, 0, out_string, ap);
+	// (ap is used up by the first vsnprintf, so measure with a copy)
+	va_copy(aq, ap);
+	nsize = vsnprintf(0, 0, out_string, aq);
+	va_end(aq);
 
 	buf = EMalloc(nsize+1); // add one for the trailing '\0'
 	vsnprintf(buf, nsize+1, out_string, ap);
@@ -60,6 +60,7 @@ void ClearScreen(void);
 void SetPosition(int line, int col);
 void GetTextPositionP(struct eu_rccoord *p);
 void screen_output(IFILE f, char *out_string);
+int output_to_screen(IFILE f);
 void screen_output_va(IFILE f, char *out_string, va_list ap);
 void screen_output_vararg(IFILE f, char *out_string, ...);
 void buffer_screen(void);
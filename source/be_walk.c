@@ -0,0 +1,471 @@
+/*****************************************************************************/
+/*      (c) Copyright - See License.txt       */
+/*****************************************************************************/
+/*                                                                           */
+/*                          Directory Tree Walker                            */
+/*                                                                           */
+/*****************************************************************************/
+
+/* walk_dir() calls dir() for every directory, and dir() builds a complete
+   listing with a stat() per entry before the first name is looked at.
+   This walker goes through a whole tree natively and hands back the
+   entries in batches, so a tree of millions of files never has to be
+   held in memory at once.
+
+   Directories are read with getdents64() on Linux, through a large buffer,
+   and with readdir() elsewhere.  The file type that the directory entry
+   carries is enough to know what to descend into, so unless the caller
+   wants sizes and dates, nothing is stat()'ed at all.  When they are
+   wanted, the stat() calls for a batch are shared out between the native
+   worker threads, which helps most on network and cold file systems.
+
+   Symbolic links to directories are reported but not followed, so a
+   link back up the tree can't make the walk go round forever. */
+
+#define _LARGEFILE64_SOURCE
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef EUNIX
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef ELINUX
+#include <sys/syscall.h>
+#endif
+#endif
+
+#include "alldefs.h"
+#include "be_alloc.h"
+#include "be_runtime.h"
+#include "be_machine.h"
+#include "be_pool.h"
+#include "be_walk.h"
+
+#ifdef EUNIX
+
+#define WALK_DIRENT_BUFFER 65536  // bytes of directory entries read at once
+#define WALK_STAT_JOB 256         // entries stat()'ed by one worker job
+
+#ifdef ELINUX
+typedef struct stat64 walk_stat_t;
+#define walk_stat(name, buf) stat64(name, buf)
+#define walk_lstat(name, buf) lstat64(name, buf)
+
+struct walk_dirent64 {
+	uint64_t d_ino;
+	int64_t d_off;
+	unsigned short d_reclen;
+	unsigned char d_type;
+	char d_name[];
+};
+#else
+typedef struct stat walk_stat_t;
+#define walk_stat(name, buf) stat(name, buf)
+#define walk_lstat(name, buf) lstat(name, buf)
+#endif
+
+struct dir_walk {
+	struct cleanup cleanup;  // must be first - freed by cleanup_double()
+	int options;
+	int nthreads;
+	intptr_t batch;
+	char *path;              // the directory being read, or NULL
+#ifdef ELINUX
+	int fd;
+	char *buffer;            // raw entries from getdents64()
+	int buffer_pos;
+	int buffer_len;
+#else
+	DIR *dirp;
+#endif
+	char **pending;          // directories still to be read
+	intptr_t npending;
+	intptr_t pending_size;
+};
+
+struct walk_entry {
+	char *name;              // the path, EMalloc'ed
+	int is_dir;
+	int stat_ok;
+	walk_stat_t st;
+};
+
+struct walk_stat_job {
+	struct walk_entry *entries;
+	intptr_t count;
+};
+
+static void walk_push(struct dir_walk *w, char *path)
+/* remember a directory to read later. w takes over path */
+{
+	if (w->npending == w->pending_size) {
+		if (w->pending_size == 0) {
+			w->pending_size = 64;
+			w->pending = (char **)EMalloc(w->pending_size * sizeof(char *));
+		}
+		else {
+			w->pending_size *= 2;
+			w->pending = (char **)ERealloc((char *)w->pending,
+										   w->pending_size * sizeof(char *));
+		}
+	}
+	w->pending[w->npending++] = path;
+}
+
+static void walk_close_dir(struct dir_walk *w)
+{
+#ifdef ELINUX
+	if (w->fd != -1) {
+		close(w->fd);
+		w->fd = -1;
+	}
+#else
+	if (w->dirp != NULL) {
+		closedir(w->dirp);
+		w->dirp = NULL;
+	}
+#endif
+	if (w->path != NULL) {
+		EFree(w->path);
+		w->path = NULL;
+	}
+}
+
+static void walk_finish(struct dir_walk *w)
+/* stop the walk and let go of everything it holds */
+{
+	walk_close_dir(w);
+	while (w->npending > 0) {
+		EFree(w->pending[--w->npending]);
+	}
+	if (w->pending != NULL) {
+		EFree((char *)w->pending);
+		w->pending = NULL;
+		w->pending_size = 0;
+	}
+#ifdef ELINUX
+	if (w->buffer != NULL) {
+		EFree(w->buffer);
+		w->buffer = NULL;
+	}
+#endif
+}
+
+static int walk_open_next(struct dir_walk *w)
+/* start reading the next pending directory. FALSE when there are none.
+   directories that can't be opened are skipped */
+{
+	while (w->npending > 0) {
+		w->path = w->pending[--w->npending];
+#ifdef ELINUX
+		w->fd = open(w->path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+		if (w->fd != -1) {
+			w->buffer_pos = w->buffer_len = 0;
+			return TRUE;
+		}
+#else
+		w->dirp = opendir(w->path);
+		if (w->dirp != NULL)
+			return TRUE;
+#endif
+		EFree(w->path);
+		w->path = NULL;
+	}
+	return FALSE;
+}
+
+static int walk_read_name(struct dir_walk *w, char **name, int *type)
+/* the next name in the directory being read, with its DT_ type.
+   FALSE at the end of the directory */
+{
+#ifdef ELINUX
+	struct walk_dirent64 *d;
+	long n;
+
+	for (;;) {
+		if (w->buffer_pos >= w->buffer_len) {
+			do {
+				n = syscall(SYS_getdents64, w->fd, w->buffer, WALK_DIRENT_BUFFER);
+			} while (n < 0 && errno == EINTR);
+			if (n <= 0)
+				return FALSE;
+			w->buffer_len = (int)n;
+			w->buffer_pos = 0;
+		}
+		d = (struct walk_dirent64 *)(w->buffer + w->buffer_pos);
+		w->buffer_pos += d->d_reclen;
+		if (d->d_name[0] == '.' && (d->d_name[1] == 0 ||
+			(d->d_name[1] == '.' && d->d_name[2] == 0)))
+			continue;
+		*name = d->d_name;
+		*type = d->d_type;
+		return TRUE;
+	}
+#else
+	struct dirent *d;
+
+	for (;;) {
+		d = readdir(w->dirp);
+		if (d == NULL)
+			return FALSE;
+		if (d->d_name[0] == '.' && (d->d_name[1] == 0 ||
+			(d->d_name[1] == '.' && d->d_name[2] == 0)))
+			continue;
+		*name = d->d_name;
+#ifdef DT_UNKNOWN
+		*type = d->d_type;
+#else
+		*type = 0;
+#endif
+		return TRUE;
+	}
+#endif
+}
+
+static char *walk_join(char *dir, char *name)
+{
+	size_t dlen, nlen;
+	char *path;
+
+	dlen = strlen(dir);
+	nlen = strlen(name);
+	path = EMalloc(dlen + nlen + 2);
+	memcpy(path, dir, dlen);
+	if (dlen == 0 || dir[dlen - 1] != '/')
+		path[dlen++] = '/';
+	memcpy(path + dlen, name, nlen + 1);
+	return path;
+}
+
+static char *walk_copy(char *path)
+{
+	char *copy;
+	size_t len;
+
+	len = strlen(path) + 1;
+	copy = EMalloc(len);
+	memcpy(copy, path, len);
+	return copy;
+}
+
+static void walk_stat_job(void *job)
+/* run by the worker threads - touches no Euphoria objects */
+{
+	struct walk_stat_job *j = (struct walk_stat_job *)job;
+	intptr_t i;
+
+	for (i = 0; i < j->count; i++) {
+		j->entries[i].stat_ok = (walk_stat(j->entries[i].name, &j->entries[i].st) == 0);
+	}
+}
+
+static void walk_stat_entries(struct walk_entry *entries, intptr_t n, int nthreads)
+{
+	struct walk_stat_job *jobs;
+	intptr_t i, njobs;
+
+	if (nthreads <= 1 || n <= WALK_STAT_JOB) {
+		for (i = 0; i < n; i++) {
+			entries[i].stat_ok = (walk_stat(entries[i].name, &entries[i].st) == 0);
+		}
+		return;
+	}
+	njobs = (n + WALK_STAT_JOB - 1) / WALK_STAT_JOB;
+	jobs = (struct walk_stat_job *)EMalloc(njobs * sizeof(struct walk_stat_job));
+	for (i = 0; i < njobs; i++) {
+		jobs[i].entries = entries + i * WALK_STAT_JOB;
+		jobs[i].count = (i == njobs - 1) ? n - i * WALK_STAT_JOB : WALK_STAT_JOB;
+	}
+	pool_run(walk_stat_job, jobs, sizeof(struct walk_stat_job), (int)njobs, nthreads);
+	EFree((char *)jobs);
+}
+
+static object walk_row(struct walk_entry *e, int with_stat)
+/* an entry laid out like one from dir(), with the whole path as the name */
+{
+	s1_ptr row;
+	object_ptr obj_ptr;
+	struct tm *date_time;
+	int i;
+
+	row = NewS1(11);
+	obj_ptr = row->base;
+	obj_ptr[1] = NewString(e->name);
+	obj_ptr[2] = NewString(e->is_dir ? "d" : "");
+	for (i = 3; i <= 11; i++) {
+		obj_ptr[i] = 0;
+	}
+	if (with_stat && e->stat_ok) {
+		if (e->st.st_size > MAXINT)
+			obj_ptr[3] = NewDouble((eudouble)e->st.st_size);
+		else
+			obj_ptr[3] = (object)e->st.st_size;
+		date_time = localtime(&e->st.st_mtime);
+		if (date_time != NULL) {
+			obj_ptr[4] = date_time->tm_year + 1900;
+			obj_ptr[5] = date_time->tm_mon + 1;
+			obj_ptr[6] = date_time->tm_mday;
+			obj_ptr[7] = date_time->tm_hour;
+			obj_ptr[8] = date_time->tm_min;
+			obj_ptr[9] = date_time->tm_sec;
+		}
+	}
+	return MAKE_SEQ(row);
+}
+
+static struct dir_walk *get_walk(object x)
+{
+	cleanup_ptr cp = NULL;
+
+	if (IS_ATOM_DBL(x)) {
+		cp = DBL_PTR(x)->cleanup;
+		while (cp != NULL && cp->type != CLEAN_WALK) {
+			cp = cp->next;
+		}
+	}
+	if (cp == NULL)
+		RTFatal("a directory walk from walk_open() was expected");
+	return (struct dir_walk *)cp;
+}
+
+static void walk_clean(object x)
+{
+	walk_finish(get_walk(x));
+}
+
+#endif
+
+object walk_open(object x)
+/* x is {path, options, batch size, threads}. returns a new walk of the
+   tree under path, or -1 if path isn't a directory (M_WALK_OPEN) */
+{
+#ifdef EUNIX
+	s1_ptr args;
+	struct dir_walk *w;
+	char *path;
+	intptr_t len;
+	object handle;
+	walk_stat_t st;
+
+	args = SEQ_PTR(x);
+	if (!IS_SEQUENCE(args->base[1]))
+		RTFatal("walk_open(): the path must be a sequence");
+	len = SEQ_PTR(args->base[1])->length + 1;
+	path = EMalloc(len);
+	MakeCString(path, args->base[1], len);
+	if (walk_stat(path, &st) != 0 || !S_ISDIR(st.st_mode)) {
+		EFree(path);
+		return ATOM_M1;
+	}
+
+	w = (struct dir_walk *)EMalloc(sizeof(struct dir_walk));
+	w->cleanup.type = CLEAN_WALK;
+	w->cleanup.func.builtin = &walk_clean;
+	w->cleanup.next = NULL;
+	w->options = (int)get_pos_int("walk_open()", args->base[2]);
+	w->batch = (intptr_t)get_pos_int("walk_open()", args->base[3]);
+	if (w->batch < 1)
+		w->batch = 1;
+	w->nthreads = pool_size((int)get_int(args->base[4]));
+	w->path = NULL;
+#ifdef ELINUX
+	w->fd = -1;
+	w->buffer = EMalloc(WALK_DIRENT_BUFFER);
+	w->buffer_pos = w->buffer_len = 0;
+#else
+	w->dirp = NULL;
+#endif
+	w->pending = NULL;
+	w->npending = 0;
+	w->pending_size = 0;
+	walk_push(w, path);
+
+	handle = NewDouble((eudouble)0.0);
+	DBL_PTR(handle)->cleanup = (cleanup_ptr)w;
+	return handle;
+#else
+	UNUSED(x);
+	RTFatal("walk_open() is not supported on this platform");
+	return ATOM_M1;
+#endif
+}
+
+object walk_next(object x)
+/* x is a walk. returns its next batch of entries, which is empty
+   once the whole tree has been walked (M_WALK_NEXT) */
+{
+#ifdef EUNIX
+	struct dir_walk *w;
+	struct walk_entry *entries, *e;
+	s1_ptr result;
+	char *name;
+	int type, with_stat;
+	intptr_t n, i;
+	walk_stat_t st;
+
+	w = get_walk(x);
+	with_stat = (w->options & WALK_STAT) != 0;
+	entries = (struct walk_entry *)EMalloc(w->batch * sizeof(struct walk_entry));
+	n = 0;
+	while (n < w->batch) {
+		if (w->path == NULL && !walk_open_next(w))
+			break;  // the whole tree has been read
+		if (!walk_read_name(w, &name, &type)) {
+			walk_close_dir(w);
+			continue;
+		}
+		e = &entries[n++];
+		e->name = walk_join(w->path, name);
+		e->stat_ok = FALSE;
+#ifdef DT_UNKNOWN
+		if (type == DT_UNKNOWN) {
+			// some file systems don't fill in the type
+			e->is_dir = (walk_lstat(e->name, &st) == 0 && S_ISDIR(st.st_mode));
+		}
+		else {
+			e->is_dir = (type == DT_DIR);
+		}
+#else
+		e->is_dir = (walk_lstat(e->name, &st) == 0 && S_ISDIR(st.st_mode));
+#endif
+		if (e->is_dir)
+			walk_push(w, walk_copy(e->name));
+	}
+	if (n == 0 && w->path == NULL)
+		walk_finish(w);
+
+	if (with_stat)
+		walk_stat_entries(entries, n, w->nthreads);
+
+	result = NewS1(n);
+	for (i = 0; i < n; i++) {
+		result->base[i + 1] = walk_row(&entries[i], with_stat);
+		EFree(entries[i].name);
+	}
+	EFree((char *)entries);
+	return MAKE_SEQ(result);
+#else
+	UNUSED(x);
+	RTFatal("walk_next() is not supported on this platform");
+	return ATOM_M1;
+#endif
+}
+
+object walk_close(object x)
+/* x is a walk. stops it early (M_WALK_CLOSE) */
+{
+#ifdef EUNIX
+	walk_finish(get_walk(x));
+	return ATOM_1;
+#else
+	UNUSED(x);
+	RTFatal("walk_close() is not supported on this platform");
+	return ATOM_M1;
+#endif
+}
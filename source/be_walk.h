@@ -0,0 +1,12 @@
+#ifndef BE_WALK_H_
+#define BE_WALK_H_
+
+#include "execute.h"
+
+#define WALK_STAT 1  // fill in sizes and dates, as dir() does
+
+object walk_open(object x);
+object walk_next(object x);
+object walk_close(object x);
+
+#endif
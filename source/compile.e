@@ -6384,7 +6384,7 @@ end procedure
 procedure opTASK_SELF()
 	dll_tasking()
 	CDeRef(Code[pc+1]) -- Code[pc+1] not used in next expression
-	c_stmt("@ = NewDouble(tcb[current_task].tid);\n", {Code[pc+1]})
+	c_stmt("@ = task_self();\n", {Code[pc+1]})
 	SetBBType(Code[pc+1], TYPE_DOUBLE, novalue, TYPE_OBJECT, 0) -- always TYPE_DOUBLE
 	create_temp( Code[pc+1], NEW_REFERENCE )
 	pc += 2
@@ -167,6 +167,8 @@ struct replace_block {
 #define UNKNOWN -1
 
 #define EXPR_SIZE 200  /* initial size of call stack */
+#define TASK_EXPR_SIZE 64  /* initial size of a task's call stack */
+#define EXPR_SEGMENT_MAX 16384  /* largest segment the call stack grows by */
 
 
 /* MACROS */
@@ -278,6 +280,7 @@ struct char_cell {
 #define TEXT_MODE (config.numxpixels <= 80 || config.numypixels <= 80)
 
 #define TEMP_SIZE 1040  // size of TempBuff - big enough for 1024 image
+#define OUTPUT_BUFFER_SIZE 65536  // stdio buffer for files being written
 
 #define EXTRA_EXPAND(x) (4 + (x) + ((x) >> 2))
 
@@ -447,12 +450,63 @@ struct char_cell {
 #define M_CALL_STACK         103
 #define M_INIT_DEBUGGER      104
 #define M_A_TO_F80           105
+#define M_PARALLEL_SORT      106
+#define M_HASH_INIT          107
+#define M_HASH_UPDATE        108
+#define M_HASH_FINAL         109
+#define M_RNG_NEW            110
+#define M_RNG_SEED           111
+#define M_RNG_INTS           112
+#define M_RNG_DOUBLES        113
+#define M_RNG_SHUFFLE        114
+#define M_GET_BYTES          115
+#define M_GETS_MANY          116
+#define M_LINES_OPEN         117
+#define M_LINES_NEXT         118
+#define M_LINES_CLOSE        119
+#define M_TASK_IO_WAIT       120
+#define M_IO_READ            121
+#define M_IO_WRITE           122
+#define M_IO_SPLICE          123
+#define M_SPAWN              124
+#define M_WALK_OPEN          125
+#define M_WALK_NEXT          126
+#define M_WALK_CLOSE         127
+#define M_READ_ARRAY         128
+#define M_WRITE_ARRAY        129
+#define M_DECODE_ARRAY       130
+#define M_ENCODE_ARRAY       131
+#define M_PEEK_GATHER        132
+#define M_PEEK_STRIDED       133
+#define M_POKE_SCATTER       134
+#define M_POKE_STRIDED       135
+#define M_TASK_WAIT_SPIN     136
+#define M_FORK_WORKERS       137
+#define M_WORKER_RETURN      138
+#define M_GATHER_WORKERS     139
+#define M_CHANNEL_NEW        140
+#define M_CHANNEL_SEND       141
+#define M_CHANNEL_RECEIVE    142
+#define M_CHANNEL_CLOSE      143
+#define M_CHANNEL_DELETE     144
+#define M_SYNC_NEW           145
+#define M_SYNC_WAIT          146
+#define M_SYNC_POST          147
+#define M_SYNC_CLEAR         148
+#define M_SYNC_DELETE        149
+#define M_TASK_STATS         150
+#define M_TASK_TRACE         151
+#define M_SYNC_BROADCAST     152
 
 enum CLEANUP_TYPES {
 	CLEAN_UDT,
 	CLEAN_UDT_RT,
 	CLEAN_PCRE,
-	CLEAN_FILE
+	CLEAN_FILE,
+	CLEAN_HASH,
+	CLEAN_RNG,
+	CLEAN_LINES,
+	CLEAN_WALK
 };
 
 #endif
@@ -52,7 +52,7 @@ typedef signed   char   schar;
 #	define igetc fgetc
 #	define iputs fputs
 #	define iputc fputc
-#	define iread fread64
+#	define iread fread
 #	define iwrite fwrite
 	// these don't seem to exist???
 	//#define iseek fseek64
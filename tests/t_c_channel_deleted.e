@@ -0,0 +1,12 @@
+include std/unittest.e
+include std/task.e
+
+-- the handle of a deleted channel is caught, not followed
+
+atom ch = channel_new(4)
+channel_delete(ch)
+channel_send(ch, "hello")
+
+test_fail("should have died: the channel was deleted")
+
+test_report()
@@ -0,0 +1,19 @@
+include std/unittest.e
+include std/sequence.e
+
+-- a run-time error in a worker stops the parent, with the worker's message
+
+integer zero = 0
+
+function part(integer first, integer last)
+	if last > 5 then
+		return first / zero
+	end if
+	return last
+end function
+
+sequence parts = parallel_range(routine_id("part"), 1, 10, 2)
+
+test_fail("should have died with the worker's error")
+
+test_report()
@@ -0,0 +1,10 @@
+include std/unittest.e
+include std/task.e
+
+-- a number that isn't a semaphore's handle is caught, not followed
+
+semaphore_wait(5)
+
+test_fail("should have died: 5 isn't a semaphore")
+
+test_report()
@@ -120,5 +120,13 @@ test_equal( "to_string #6", `{12, abc, {4.5, -99}}` , to_string({12,"abc",{4.5,
 test_equal( "to_string #7", `12.34567` , to_string(12.34567))
 test_equal( "to_string #8", `1234567891234` , to_string(1_234_567_891_234))
 
+test_equal("bytes_to_array C_INT", {1, -1}, bytes_to_array({1,0,0,0, 255,255,255,255}, C_INT))
+test_equal("bytes_to_array C_UINT", {1, #FFFFFFFF}, bytes_to_array({1,0,0,0, 255,255,255,255, 9}, C_UINT))
+test_equal("bytes_to_array C_SHORT big endian", {258, -2}, bytes_to_array({1,2, 255,254}, C_SHORT, 1))
+test_equal("array_to_bytes C_USHORT big endian", {0,1, 0,2}, array_to_bytes({1, 2}, C_USHORT, 1))
+test_equal("array_to_bytes C_DOUBLE", atom_to_float64(1.5) & atom_to_float64(-2), array_to_bytes({1.5, -2}, C_DOUBLE))
+test_equal("array_to_bytes C_FLOAT", atom_to_float32(0.25), array_to_bytes({0.25}, C_FLOAT))
+test_equal("bytes_to_array C_LONGLONG round trip", {-5, power(2, 40)}, bytes_to_array(array_to_bytes({-5, power(2, 40)}, C_LONGLONG), C_LONGLONG))
+
 test_report()
 
@@ -262,6 +262,28 @@ procedure dir_tests()
 	
 	test_equal( "test walk_dir results", expected_walk_data, sort( walk_data ) )
 	
+	sequence expected_paths = {}, walk_paths = {}, batch
+	for i = 1 to length( expected_walk_data ) do
+		expected_paths = append( expected_paths, expected_walk_data[i][1] & SLASH & expected_walk_data[i][2] )
+	end for
+	atom walk = walk_open( "filesyse_dir", 0, 3 )
+	batch = walk_next( walk )
+	while length( batch ) do
+		test_true( "walk_next batch size", length( batch ) <= 3 )
+		for i = 1 to length( batch ) do
+			walk_paths = append( walk_paths, batch[i][D_NAME] )
+		end for
+		batch = walk_next( walk )
+	end while
+	test_equal( "walk_open/walk_next paths", sort( expected_paths ), sort( walk_paths ) )
+	test_equal( "walk_open bad path", -1, walk_open( "filesyse_dir" & SLASH & "test-file" ) )
+	
+	walk = walk_open( "filesyse_dir", 1 )
+	batch = walk_next( walk )
+	walk_close( walk )
+	test_equal( "walk_open with_stat entries", length( expected_paths ), length( batch ) )
+	test_equal( "walk_close", {}, walk_next( walk ) )
+	
 	sequence test_dir_size = dir_size( "filesyse_dir" )
 	test_equal( "dir size dir count", 4, test_dir_size[COUNT_DIRS] )
 	test_equal( "dir size file count", 1, test_dir_size[COUNT_FILES] )
@@ -2,6 +2,8 @@
 include std/unittest.e
 include std/hash.e
 include std/io.e
+include std/machine.e
+include std/filesys.e
 constant s = "Euphoria Programming Language brought to you by Rapid Deployment Software"
 constant hashalgo = {-9.123, HSIEH30, HSIEH32, ADLER32, FLETCHER32, MD5, SHA256, 0, 0.5, 1, 2, 9, 9.123, #3FFFFFFF, "abc", "abb", ""}
 
@@ -85,4 +87,91 @@ for i = 1 to length(hashalgo) do
 	end if
 end for
 
+-- incremental hashing
+function hex_digest(sequence words)
+	sequence hex = ""
+	for i = 1 to length(words) do
+		hex &= sprintf("%08x", words[i])
+	end for
+	return hex
+end function
+
+atom state = hash_init(MD5)
+test_equal("hash_final MD5 empty", "d41d8cd98f00b204e9800998ecf8427e", hex_digest(hash_final(state)))
+hash_update(state, "abc")
+test_equal("hash_final MD5 abc", "900150983cd24fb0d6963f7d28e17f72", hex_digest(hash_final(state)))
+
+state = hash_init(SHA256)
+hash_update(state, "a")
+hash_update(state, "bc")
+test_equal("hash_final SHA256 abc",
+	"ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", hex_digest(hash_final(state)))
+
+state = hash_init(SHA256)
+hash_update(state, "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq")
+test_equal("hash_final SHA256 two blocks",
+	"248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1", hex_digest(hash_final(state)))
+
+sequence million = repeat('a', 1_000_000)
+state = hash_init(MD5)
+for i = 1 to length(million) by 999 do
+	if i + 998 > length(million) then
+		hash_update(state, million[i..$])
+	else
+		hash_update(state, million[i..i+998])
+	end if
+end for
+test_equal("hash_final MD5 million a", "7707d6ae4e027c70eea2a935c2296f21", hex_digest(hash_final(state)))
+
+atom mem = allocate(length(s))
+poke(mem, s)
+for i = XXHASH64 to SHA256 do
+	atom from_seq = hash_init(i)
+	atom from_mem = hash_init(i)
+	for j = 1 to length(s) by 7 do
+		if j + 6 > length(s) then
+			hash_update(from_seq, s[j..$])
+		else
+			hash_update(from_seq, s[j..j+6])
+		end if
+	end for
+	hash_update(from_mem, mem, length(s))
+	test_equal(sprintf("hash_update memory vs sequence %d", i), hash_final(from_seq), hash_final(from_mem))
+
+	if find(i, {ADLER32, FLETCHER32, CRC32C, XXHASH64}) then
+		test_equal(sprintf("hash_final vs hash %d", i), hash(s, i), hash_final(from_seq))
+		hash_update(from_seq, "x")
+		test_equal(sprintf("hash_final continues %d", i), hash(s & 'x', i), hash_final(from_seq))
+	end if
+end for
+free(mem)
+
+-- CRC32C and xxHash64
+test_equal("CRC32C check value", #E3069283, hash("123456789", CRC32C))
+test_equal("CRC32C empty", 0, hash("", CRC32C))
+state = hash_init(CRC32C)
+hash_update(state, "12345")
+hash_update(state, "6789")
+test_equal("CRC32C incremental", #E3069283, hash_final(state))
+
+ifdef BITS64 then
+	test_equal("XXHASH64 empty", #EF46DB37 * #100000000 + #51D8E999, hash("", XXHASH64))
+	test_equal("XXHASH64 abc", #44BC2CF5 * #100000000 + #AD770999, hash("abc", XXHASH64))
+end ifdef
+
+for i = XXHASH64 to CRC32C do
+	test_equal(sprintf("%d: integer vs equivalent double", i), hash({1, 5, "ab"}, i), hash({1, 5.5 - 0.5, {97, 98.0}}, i))
+	test_not_equal(sprintf("%d: nested sequences", i), hash({"ab", "c"}, i), hash({"a", "bc"}, i))
+	test_not_equal(sprintf("%d: integer vs double", i), hash(5, i), hash(5.01, i))
+end for
+
+sequence fname = "t_hash_file.tmp"
+integer fn = open(fname, "wb")
+puts(fn, million)
+close(fn)
+test_equal("hash_file MD5", "7707d6ae4e027c70eea2a935c2296f21", hex_digest(hash_file(fname, MD5)))
+test_equal("hash_file CRC32C", hash(million, CRC32C), hash_file(fname, CRC32C))
+delete_file(fname)
+test_equal("hash_file missing", -1, hash_file(fname, MD5))
+
 test_report()
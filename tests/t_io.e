@@ -3,6 +3,8 @@ include std/filesys.e
 include std/unittest.e
 include std/text.e
 include std/sequence.e
+include std/search.e
+include std/dll.e
 
 -- TODO: add more tests
 
@@ -190,6 +192,79 @@ for i = 1 to length(tmp) do
 end for
 test_equal( "process lines #3", tmp, alt_tmp)
 
+function stop_at_two(sequence aLine, integer line_no, object data)
+	tmp = append(tmp, aLine)
+	if line_no = data then
+		return aLine
+	end if
+	return 0
+end function
+
+write_file("filed.txt", "one\r\ntwo\n\nfour")
+tmp = {}
+test_equal( "process lines early exit", "two", process_lines("filed.txt", routine_id("stop_at_two"), 2))
+test_equal( "process lines early exit lines", {"one", "two"}, tmp)
+tmp = {}
+test_equal( "process lines no final new line", 0, process_lines("filed.txt", routine_id("stop_at_two"), 0))
+test_equal( "process lines no final new line lines", {"one", "two", "", "four"}, tmp)
+
+tmp = open("filed.txt", "r")
+test_equal( "gets_many first", {"one", "two"}, gets_many(tmp, 2))
+test_equal( "gets_many rest", {"", "four"}, gets_many(tmp, 10))
+test_equal( "gets_many at eof", {}, gets_many(tmp, 10))
+close(tmp)
+test_equal( "read_lines via gets_many", {"one", "two", "", "four"}, read_lines("filed.txt"))
+tmp = open("filed.txt", "r")
+test_equal( "gets after gets_many", {{"one"}, "two\n"}, {gets_many(tmp, 1), gets(tmp)})
+close(tmp)
+
+tmp = open_lines("filed.txt", 3)
+test_equal( "next_lines first batch", {"one", "two", ""}, next_lines(tmp))
+test_equal( "next_lines last batch", {"four"}, next_lines(tmp))
+test_equal( "next_lines after end", {}, next_lines(tmp))
+tmp = open_lines("filed.txt", 1)
+test_equal( "next_lines batch of one", {"one"}, next_lines(tmp))
+close_lines(tmp)
+test_equal( "next_lines after close_lines", {}, next_lines(tmp))
+test_equal( "open_lines missing file", -1, open_lines("no such file.txt"))
+
+-- large enough to need several blocks
+sequence big = repeat(0, 200_000)
+for i = 1 to length(big) do
+	big[i] = remainder(i * 7, 256)
+end for
+write_file("filed.txt", big)
+test_equal( "read_file large", big, read_file("filed.txt"))
+
+tmp = open("filed.txt", "rb")
+test_equal( "get_bytes 0", {}, get_bytes(tmp, 0))
+test_equal( "get_bytes first", big[1..10], get_bytes(tmp, 10))
+test_equal( "get_bytes middle", big[11..100_010], get_bytes(tmp, 100_000))
+test_equal( "get_bytes short", big[100_011..$], get_bytes(tmp, 1_000_000))
+test_equal( "get_bytes at eof", {}, get_bytes(tmp, 10))
+close(tmp)
+
+-- small writes go through the file buffer, big ones straight to the file
+tmp = open("filed.txt", "wb")
+puts(tmp, "ab\0c")
+puts(tmp, big & big)
+test_equal( "where after big puts", 4 + 2 * length(big), where(tmp))
+puts(tmp, 'z')
+close(tmp)
+test_equal( "read back big puts", "ab\0c" & big & big & "z", read_file("filed.txt"))
+write_file("filed.txt", big)
+
+tmp = {}
+test_equal( "process lines big", 0, process_lines("filed.txt", routine_id("stop_at_two"), 0))
+test_equal( "process lines big count", length(find_all('\n', big)) + (big[$] != '\n'), length(tmp))
+
+-- a line longer than a block, and a last line that keeps its '\r'
+write_file("filed.txt", repeat('x', 150_000) & "\nabc\r")
+tmp = {}
+test_equal( "process lines long line", 0, process_lines("filed.txt", routine_id("stop_at_two"), 0))
+test_equal( "process lines long line lines", {repeat('x', 150_000), "abc\r"}, tmp)
+delete_file("filed.txt")
+
 
 -- OpenBSD allows seeking on STDIN, STDOUT and STDERR
 ifdef not OPENBSD and not NETBSD then
@@ -224,5 +299,35 @@ delete_file("file.txt")
 delete_file("filea.txt")
 delete_file("fileb.txt")
 delete_file("filec.txt")
+
+-- binary arrays
+sequence ints = {0, 1, -1, 70000, -2147483648, 2147483647}
+fh = open("array.bin", "wb")
+put_array(fh, C_INT, ints)
+put_array(fh, C_DOUBLE, {0.5, -1e300}, 1)
+put_array(fh, C_USHORT, {1, 65535, 65536})
+close(fh)
+fh = open("array.bin", "rb")
+test_equal("get_array C_INT", ints, get_array(fh, C_INT, length(ints)))
+test_equal("get_array C_DOUBLE big endian", {0.5, -1e300}, get_array(fh, C_DOUBLE, 2, 1))
+test_equal("get_array to the end", {1, 65535, 0}, get_array(fh, C_USHORT))
+test_equal("get_array at end", {}, get_array(fh, C_USHORT))
+close(fh)
+fh = open("array.bin", "rb")
+test_equal("get_array C_UINT", {0, 1, #FFFFFFFF}, get_array(fh, C_UINT, 3))
+test_equal("get_array matches get_integer32", get_integer32(fh), 70000)
+close(fh)
+delete_file("array.bin")
+
+-- a partial value at the end is left to be read another way
+fh = open("array.bin", "wb")
+puts(fh, {1, 0, 0, 0, 2, 0, 0, 0, 3, 4})
+close(fh)
+fh = open("array.bin", "rb")
+test_equal("get_array stops before a partial value", {1, 2}, get_array(fh, C_INT))
+test_equal("get_array leaves a partial value unread", {3, 4}, get_bytes(fh, 10))
+close(fh)
+delete_file("array.bin")
+
 test_report()
 
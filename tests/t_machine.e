@@ -1,3 +1,4 @@
+include std/dll.e
 include std/machine.e
 include std/unittest.e
 
@@ -14,6 +15,24 @@ test_equal( "poke_wstring",                   ptr + 6, poke_wstring( ptr, 256, "
 test_equal( "peek_wstring",                   "foo",   peek_wstring( ptr ) )
 free( ptr )
 
+-- three 8 byte records of {int, int}
+ptr = allocate( 24 )
+poke4( ptr, {1, -1, 2, -2, 3, -3} )
+test_equal( "peek_strided",            {1, 2, 3},    peek_strided( ptr, 8, 3, C_INT ) )
+test_equal( "peek_strided contiguous", {1, -1, 2},   peek_strided( ptr, 4, 3, C_INT ) )
+test_equal( "peek_strided unsigned",   {#FFFFFFFF, #FFFFFFFE}, peek_strided( ptr + 4, 8, 2, C_UINT ) )
+test_equal( "peek_gather",             {3, -1},      peek_gather( {ptr + 16, ptr + 4}, C_INT ) )
+poke_scatter( {ptr + 16, ptr}, C_INT, {30, 10} )
+test_equal( "poke_scatter",            {10, 2, 30},  peek_strided( ptr, 8, 3, C_INT ) )
+poke_strided( ptr + 4, 8, C_SHORT, {-7, 8, 9} )
+test_equal( "poke_strided",            {-7, 8, 9},   peek_strided( ptr + 4, 8, 3, C_SHORT ) )
+free( ptr )
+
+ptr = allocate( 16 )
+poke_strided( ptr, 8, C_DOUBLE, {1.5, -2.25} )
+test_equal( "peek_gather double",      {-2.25, 1.5}, peek_gather( {ptr + 8, ptr}, C_DOUBLE ) )
+free( ptr )
+
 test_true( "allocate_wstring", allocate_wstring( "foo", 1 ) )
 
 test_true( "allocate_data with cleanup", allocate_data( 5, 1 ) )
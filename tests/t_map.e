@@ -9,6 +9,7 @@ include std/math.e
 include std/eumem.e
 include std/serialize.e
 include std/datetime.e
+include std/hash.e
 
 object o1, o2, o3
 constant init_small_map_key = -75960.358941
@@ -606,6 +607,38 @@ map:put( m2, 1, "ONE", map:APPEND )
 map:put( m2, 2, "TWO", map:CONCAT )
 test_equal("Initial append/concat large", {{1, {"ONE"}}, {2, "TWO"}}, pairs(m2, 1))
 
+test_equal("hash_algorithm default", HSIEH30, map:hash_algorithm())
+for a = 1 to 2 do
+	integer algo = {CRC32C, XXHASH64}[a]
+	test_equal(sprintf("hash_algorithm set %d", algo), HSIEH30, map:hash_algorithm(algo))
+	m2 = map:new(map:threshold() + 1)
+	for i = 1 to 500 do
+		map:put(m2, sprintf("key%d", i), i)
+		map:put(m2, i + 0.5, -i)
+	end for
+	integer found = 0
+	for i = 1 to 500 do
+		found += (map:get(m2, sprintf("key%d", i)) = i) + (map:get(m2, i + 0.5) = -i)
+	end for
+	test_equal(sprintf("hash_algorithm %d lookups", algo), 1000, found)
+	test_equal(sprintf("hash_algorithm restore %d", algo), algo, map:hash_algorithm(HSIEH30))
+end for
+
+-- a map goes on using the algorithm it was made with
+m2 = map:new(map:threshold() + 1)
+for i = 1 to 100 do
+	map:put(m2, sprintf("key%d", i), i)
+end for
+map:hash_algorithm(CRC32C)
+for i = 101 to 1000 do
+	map:put(m2, sprintf("key%d", i), i) -- and rehashes with it as it grows
+end for
+integer kept = 0
+for i = 1 to 1000 do
+	kept += (map:get(m2, sprintf("key%d", i)) = i)
+end for
+test_equal("hash_algorithm leaves existing maps alone", 1000, kept)
+map:hash_algorithm(HSIEH30)
 
 --
 -- Done with testing
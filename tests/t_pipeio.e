@@ -42,5 +42,39 @@ end if
 
 pipe:kill(p)
 
+-- move data between two pipes of our own without reading it
+object a = pipe:create(), b = pipe:create()
+sequence text = repeat('z', 20_000) & "end"
+test_equal("pipe:write #2", length(text), pipe:write(a[PARENT][STDIN], text))
+test_equal("pipe:transfer", length(text), pipe:transfer(a[CHILD][STDIN], b[PARENT][STDIN], length(text)))
+sequence got = ""
+while length(got) < length(text) do
+	r = pipe:read(b[CHILD][STDIN], 65536)
+	if length(r) = 0 then
+		exit
+	end if
+	got &= r
+end while
+test_equal("pipe:read after transfer", text, got)
+for i = 1 to 2 do
+	for j = 1 to 3 do
+		pipe:close(a[i][j])
+		pipe:close(b[i][j])
+	end for
+end for
+
+-- a pool of workers that echo each request
+ifdef UNIX then
+	integer pool = pipe:pool_new("cat", 3)
+	test_true("pipe:pool_new", pool > 0)
+	test_equal("pipe:pool_call", "hello", pipe:pool_call(pool, "hello"))
+	sequence requests = {}
+	for i = 1 to 20 do
+		requests = append(requests, sprintf("request %d", i))
+	end for
+	test_equal("pipe:pool_map", requests, pipe:pool_map(pool, requests))
+	pipe:pool_close(pool)
+end ifdef
+
 test_report()
 
@@ -96,5 +96,33 @@ sequence sample_result = sample( "abc", 4, 1 )
 sample_result[1] = sort( sample_result[1] )
 test_equal("full sample without replacement, also unselected", {"abc", {}}, sample_result )
 
+atom rng1 = rng_new(2024)
+atom rng2 = rng_new(2024)
+test_equal("rng_ints() same seed", rng_ints(rng1, 50, 1, 6), rng_ints(rng2, 50, 1, 6))
+test_equal("rng_doubles() same seed", rng_doubles(rng1, 20), rng_doubles(rng2, 20))
+rng_seed(rng2, "another seed")
+test_not_equal("rng_seed()", rng_ints(rng1, 20, 0, 1000), rng_ints(rng2, 20, 0, 1000))
+test_equal("rng_ints() empty", {}, rng_ints(0, 0, 1, 6))
+test_equal("rng_ints() lo = hi", repeat(5, 10), rng_ints(rng1, 10, 5, 5))
+
+sequence rs = rng_ints(rng1, 6000, -3, 2)
+test_equal("rng_ints() range", {-3, 2}, {min(rs), max(rs)})
+integer zeros = 0
+for i = 1 to length(rs) do
+	zeros += (rs[i] = 0)
+end for
+test_equal("rng_ints() uniform", 0, approx(zeros, 1000, 150))
+
+rs = rng_ints(0, 100, -#FFFFFFFFFF, #FFFFFFFFFF)
+test_true("rng_ints() large range", min(rs) >= -#FFFFFFFFFF and max(rs) <= #FFFFFFFFFF and equal(rs, floor(rs)))
+
+rs = rng_doubles(rng1, 1000)
+test_true("rng_doubles() range", min(rs) >= 0 and max(rs) < 1)
+
+sequence deck = rng_shuffle(rng1, {1,2,3,4,5,6,7,8,9,10,"jack","queen"})
+test_equal("rng_shuffle() keeps elements", sort({1,2,3,4,5,6,7,8,9,10,"jack","queen"}), sort(deck))
+test_equal("rng_shuffle() same seed", rng_shuffle(rng_new(9), deck), rng_shuffle(rng_new(9), deck))
+test_equal("rng_shuffle() empty", {}, rng_shuffle(0, {}))
+
 test_report()
 
@@ -457,6 +457,46 @@ function sprinter(object a, object t)
 end function
 test_equal("apply #1", {"8","9","10","11"}, apply({1,2,3,4}, routine_id("sprinter"), 7))
 
+function tripler(object a)
+	return {a, a * 3.5, sprint(a)}
+end function
+sequence pa_source = repeat(0, 1001)
+for i = 1 to length(pa_source) do
+	pa_source[i] = i - 500
+end for
+sequence pa_expected = repeat(0, length(pa_source))
+for i = 1 to length(pa_source) do
+	pa_expected[i] = tripler(pa_source[i])
+end for
+test_equal("parallel_apply", pa_expected, parallel_apply(routine_id("tripler"), pa_source, 4))
+test_equal("parallel_apply one thread", pa_expected, parallel_apply(routine_id("tripler"), pa_source, 1))
+test_equal("parallel_apply short", {{1, 3.5, "1"}}, parallel_apply(routine_id("tripler"), {1}))
+test_equal("parallel_apply empty", {}, parallel_apply(routine_id("tripler"), {}))
+
+function range_part(integer first, integer last)
+	integer total = 0
+	for i = first to last do
+		total += pa_source[i]
+	end for
+	return {first, last, total}
+end function
+integer pa_total = 0
+for i = 1 to length(pa_source) do
+	pa_total += pa_source[i]
+end for
+sequence parts = parallel_range(routine_id("range_part"), 1, length(pa_source), 3)
+integer covered = 0, range_total = 0
+for i = 1 to length(parts) do
+	test_equal(sprintf("parallel_range part %d starts after the last", i), covered + 1, parts[i][1])
+	covered = parts[i][2]
+	range_total += parts[i][3]
+end for
+test_equal("parallel_range covers the range", length(pa_source), covered)
+test_equal("parallel_range total", pa_total, range_total)
+test_equal("parallel_range one thread", {{1, length(pa_source), pa_total}},
+	parallel_range(routine_id("range_part"), 1, length(pa_source), 1))
+test_equal("parallel_range empty", {}, parallel_range(routine_id("range_part"), 5, 4))
+
 
 include std/math.e
 include std/search.e
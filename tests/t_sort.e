@@ -1,3 +1,4 @@
+include std/rand.e
 include std/sort.e
 include std/unittest.e
 include std/wildcard.e
@@ -40,6 +41,28 @@ test_equal("sort() mixed",
                     sort({"ABa",3, "", 2.477, {-5}, {1,{2,3},4.5}})
           )
 
+-----  parallel_sort() ------
+test_equal("parallel_sort() empty sequence", {}, parallel_sort({}))
+test_equal("parallel_sort() integers", {1,1,2,2,3}, parallel_sort({1,2,3,2,1}))
+test_equal("parallel_sort() integers descending", {3,2,2,1,1}, parallel_sort({1,2,3,2,1}, DESCENDING))
+test_equal("parallel_sort() floats", {5.1, 5.2, 6.5}, parallel_sort({5.1, 6.5, 5.2}))
+test_equal("parallel_sort() strings", {"", "AB", "ABa", "abc"}, parallel_sort({"abc", "ABa", "", "AB"}))
+test_equal("parallel_sort() mixed",
+                    sort({"ABa",3, "", 2.477, {-5}, {1,{2,3},4.5}}),
+                    parallel_sort({"ABa",3, "", 2.477, {-5}, {1,{2,3},4.5}})
+          )
+
+sequence big_ints = rand(repeat(1_000_000, 50_000))
+test_equal("parallel_sort() large integer sequence", sort(big_ints), parallel_sort(big_ints, ASCENDING, 4))
+test_equal("parallel_sort() large integer sequence descending", sort(big_ints, DESCENDING), parallel_sort(big_ints, DESCENDING, 4))
+sequence big_floats = big_ints + 0.5
+test_equal("parallel_sort() large float sequence", sort(big_floats), parallel_sort(big_floats, ASCENDING, 3))
+sequence big_strings = repeat(0, 20_000)
+for i = 1 to length(big_strings) do
+	big_strings[i] = rand(repeat(26, rand(8))) + 'a' - 1
+end for
+test_equal("parallel_sort() large string sequence", sort(big_strings), parallel_sort(big_strings, ASCENDING, 4))
+
 -----  custom_sort() ------
 function rs(object a, object b) -- reverse sort
     return -(compare(a, b))
@@ -3,6 +3,8 @@ include std/task.e
 include std/filesys.e
 include std/io.e
 include std/math.e
+include std/pipeio.e as pipe
+include std/dll.e
 
 sequence vResults
 sequence xResults
@@ -130,5 +132,343 @@ else
 end if
 
 test_equal("Tasks dir hash", xResults, vResults)
+
+ifdef UNIX then
+	-- one task reads a pipe that another task writes
+	sequence io_got = ""
+	integer io_done = 0
+
+	procedure io_reader(integer fd, integer n)
+		object data
+		while length(io_got) < n do
+			data = task_io_read(fd, 4096)
+			if atom(data) or length(data) = 0 then
+				exit
+			end if
+			io_got &= data
+		end while
+		io_done += 1
+	end procedure
+
+	procedure io_writer(integer fd, sequence text)
+		for i = 1 to length(text) do
+			if task_io_write(fd, text[i]) != length(text[i]) then
+				exit
+			end if
+			task_yield()
+		end for
+		io_done += 1
+	end procedure
+
+	object io_pipe = pipe:create()
+	sequence io_text = {"first ", "second ", repeat('x', 100_000)}
+	task_schedule(task_create(routine_id("io_reader"),
+		{io_pipe[pipe:CHILD][pipe:STDIN], length(io_text[1] & io_text[2] & io_text[3])}), 1)
+	task_schedule(task_create(routine_id("io_writer"),
+		{io_pipe[pipe:PARENT][pipe:STDIN], io_text}), 1)
+	while io_done < 2 do
+		task_yield()
+	end while
+	test_equal("task_io_read/task_io_write through a pipe", io_text[1] & io_text[2] & io_text[3], io_got)
+	for i = 1 to 2 do
+		for j = 1 to 3 do
+			pipe:close(io_pipe[i][j])
+		end for
+	end for
+end ifdef
+
+atom old_spin = task_wait_spin(0)
+test_true("task_wait_spin default", old_spin > 0)
+test_equal("task_wait_spin returns the old setting", 0, task_wait_spin(old_spin))
+
+integer rt_runs = 0
+procedure rt_task()
+	while 1 do
+		rt_runs += 1
+		task_yield()
+	end while
+end procedure
+
+atom rt_id = task_create(routine_id("rt_task"), {})
+atom rt_start = time()
+task_schedule(rt_id, {0.01, 0.01})
+while rt_runs < 5 do
+	task_yield()
+end while
+task_suspend(rt_id)
+test_true("real-time task waits for its min time", time() - rt_start >= 0.04)
+
+atom ch = channel_new(4)
+test_equal("channel_send", 1, channel_send(ch, {1, 2.5, "three"}))
+test_equal("channel_send #2", 1, channel_send(ch, 4))
+channel_close(ch)
+test_equal("channel_send after channel_close", 0, channel_send(ch, 5))
+test_equal("channel_receive", {{1, 2.5, "three"}}, channel_receive(ch))
+test_equal("channel_receive #2", {4}, channel_receive(ch))
+test_equal("channel_receive when closed", {}, channel_receive(ch))
+channel_delete(ch)
+
+-- a task sends more messages than the channel holds while the main
+-- task receives them
+procedure ch_sender(atom c, integer n)
+	for i = 1 to n do
+		if channel_send(c, {i, repeat(i, 10)}) = 0 then
+			exit
+		end if
+	end for
+	channel_close(c)
+end procedure
+
+ch = channel_new(2)
+task_schedule(task_create(routine_id("ch_sender"), {ch, 50}), 1)
+sequence ch_got = {}, ch_want = {}
+for i = 1 to 50 do
+	ch_want &= i
+end for
+sequence ch_msg = channel_receive(ch)
+while length(ch_msg) do
+	ch_got &= ch_msg[1][1]
+	ch_msg = channel_receive(ch)
+end while
+channel_delete(ch)
+test_equal("channel between tasks", ch_want, ch_got)
+
+-- ping-pong between two tasks through a pair of semaphores
+atom ping = semaphore_new(), pong = semaphore_new()
+sequence pp_log = ""
+
+procedure ponger(integer n)
+	for i = 1 to n do
+		semaphore_wait(ping)
+		pp_log &= 'o'
+		semaphore_signal(pong)
+	end for
+end procedure
+
+task_schedule(task_create(routine_id("ponger"), {3}), 1)
+for i = 1 to 3 do
+	pp_log &= 'i'
+	semaphore_signal(ping)
+	semaphore_wait(pong)
+end for
+test_equal("semaphore ping-pong", "ioioio", pp_log)
+semaphore_delete(ping)
+semaphore_delete(pong)
+
+-- a waiter handed a unit, but suspended before it runs, passes it on
+atom sem = semaphore_new()
+sequence sem_log = ""
+
+procedure sem_waiter(integer c)
+	semaphore_wait(sem)
+	sem_log &= c
+end procedure
+
+atom sem_a = task_create(routine_id("sem_waiter"), {'a'})
+task_schedule(sem_a, 1)
+task_yield()  -- a waits first
+task_schedule(task_create(routine_id("sem_waiter"), {'b'}), 1)
+task_yield()
+semaphore_signal(sem)
+task_suspend(sem_a)
+for i = 1 to 3 do
+	task_yield()
+end for
+test_equal("a suspended waiter's unit goes to the next", "b", sem_log)
+task_schedule(sem_a, 1)
+task_yield()
+semaphore_signal(sem)
+for i = 1 to 3 do
+	task_yield()
+end for
+test_equal("a rescheduled waiter waits again", "ba", sem_log)
+semaphore_delete(sem)
+
+-- a condition variable wakes one waiter per signal, or all of them
+atom cv = cond_new()
+integer cv_ready = 0
+sequence cv_log = ""
+
+procedure cv_waiter(integer c)
+	while not cv_ready do
+		cond_wait(cv)
+	end while
+	cv_log &= c
+end procedure
+
+for c = 'a' to 'c' do
+	task_schedule(task_create(routine_id("cv_waiter"), {c}), 1)
+	task_yield()  -- so they wait in order
+end for
+cond_signal(cv)
+for i = 1 to 3 do
+	task_yield()
+end for
+test_equal("cond_signal wakes one waiter, which checks again", "", cv_log)
+cv_ready = 1
+cond_signal(cv)
+for i = 1 to 3 do
+	task_yield()
+end for
+test_equal("cond_signal wakes the longest waiter", "b", cv_log)
+cond_broadcast(cv)
+for i = 1 to 3 do
+	task_yield()
+end for
+test_equal("cond_broadcast wakes the rest", {3, 'b'}, {length(cv_log), cv_log[1]})
+cond_delete(cv)
+
+-- every task waiting for an event runs once it is set
+atom go = event_new()
+integer ev_runs = 0
+
+procedure ev_waiter()
+	event_wait(go)
+	ev_runs += 1
+end procedure
+
+for i = 1 to 3 do
+	task_schedule(task_create(routine_id("ev_waiter"), {}), 1)
+end for
+task_yield()
+test_equal("event_wait waits", 0, ev_runs)
+event_set(go)
+while ev_runs < 3 do
+	task_yield()
+end while
+test_equal("event_set wakes every waiter", 3, ev_runs)
+event_clear(go)
+event_delete(go)
+
+-- the scheduler counts each task's runs, and can trace them to a file
+integer st_runs = 0, st_keep = 1
+
+procedure st_worker()
+	while st_keep do
+		st_runs += 1
+		task_yield()
+	end while
+end procedure
+
+test_true("task_trace opens a file", task_trace("task_trace.json"))
+atom st_task = task_create(routine_id("st_worker"), {})
+task_schedule(st_task, 1)
+while st_runs < 3 do
+	task_yield()
+end while
+sequence st = task_stats(st_task)
+test_equal("task_stats runs", 3, st[TASK_RUNS])
+test_true("task_stats cpu time", st[TASK_CPU_TIME] >= 0)
+test_equal("task_stats time-shared tasks aren't late", 0, st[TASK_LATE_MAX])
+test_true("task_stats current task", task_stats(task_self())[TASK_RUNS] >= 1)
+st_keep = 0
+task_yield()
+test_true("task_trace closes the file", task_trace(0))
+sequence trace = read_file("task_trace.json")
+test_equal("task_trace writes an array", "[\n", trace[1..2])
+test_true("task_trace names the runs", match("\"name\":\"st_worker\"", trace))
+delete_file("task_trace.json")
+
+-- a task's call stack grows as it recurses, and other tasks run while
+-- it is deep
+function deep(integer n)
+	if n = 0 then
+		task_yield()
+		return 0
+	end if
+	return deep(n - 1) + 1
+end function
+
+sequence deep_got = {}
+
+procedure deep_task(integer n)
+	deep_got &= deep(n)
+	deep_got &= deep(n)
+end procedure
+
+task_schedule(task_create(routine_id("deep_task"), {10_000}), 1)
+task_schedule(task_create(routine_id("deep_task"), {30}), 1)
+while length(deep_got) < 4 do
+	task_yield()
+end while
+test_equal("deep recursion in tasks", {30, 30, 10_000, 10_000}, sort(deep_got))
+
+-- a delete routine or call-back run from any depth of a task's call
+-- stack, that itself recurses across the next stack segment boundary
+integer cb_deleted = 0
+
+function cb_depth(integer n)
+	if n = 0 then
+		return 0
+	end if
+	return cb_depth(n - 1) + 1
+end function
+
+procedure cb_delete(object x)
+	cb_deleted += cb_depth(40) - 39
+end procedure
+
+function cb_func(integer n)
+	return cb_depth(40) + n
+end function
+
+constant CB_FUNC = define_c_func("", call_back(routine_id("cb_func")),
+	{C_INT}, C_INT)
+
+function cb_at(integer depth, integer n)
+	object x
+	if depth > 0 then
+		return cb_at(depth - 1, n)
+	end if
+	x = delete_routine(n + 0.5, routine_id("cb_delete"))
+	x = 0
+	return c_func(CB_FUNC, {n})
+end function
+
+sequence cb_got = {}
+
+procedure cb_task()
+	for depth = 0 to 100 do
+		cb_got &= cb_at(depth, depth) - depth
+	end for
+end procedure
+
+task_schedule(task_create(routine_id("cb_task"), {}), 1)
+while length(cb_got) < 101 do
+	task_yield()
+end while
+test_equal("call-backs across call stack segments", repeat(40, 101), cb_got)
+test_equal("delete routines across call stack segments", 101, cb_deleted)
+
+-- many tasks, created in waves so that the ended ones are recycled, each
+-- with some depth of calls of its own while the others run
+integer wave_done = 0, wave_bad = 0
+
+function wave_depth(integer n)
+	if n = 0 then
+		task_yield()
+		return 0
+	end if
+	return wave_depth(n - 1) + 1
+end function
+
+procedure wave_task(integer n)
+	if wave_depth(n) != n then
+		wave_bad += 1
+	end if
+	task_yield()
+	wave_done += 1
+end procedure
+
+for wave = 1 to 5 do
+	for i = 1 to 1000 do
+		task_schedule(task_create(routine_id("wave_task"), {remainder(i, 50)}), 1)
+	end for
+	while wave_done < wave * 1000 do
+		task_yield()
+	end while
+end for
+test_equal("many tasks created and recycled", {5000, 0}, {wave_done, wave_bad})
+
 test_report()
 
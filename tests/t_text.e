@@ -45,6 +45,38 @@ test_equal("sprintf() integer", "i=1", sprintf("i=%d", {1}))
 test_equal("sprintf() float", "i=5.5", sprintf("i=%.1f", {5.5}))
 test_equal("sprintf() percent", "%", sprintf("%%", {}))
 
+-- the same format is compiled and cached after its first use
+for i = 1 to 3 do
+	test_equal(sprintf("sprintf() repeated format #%d", i),
+		"[INFO] 12 -3 abc  4.50 7F 100% x",
+		sprintf("[%s] %d %d %s %5.2f %x %d%% %s", {"INFO", 12, -3, "abc", 4.5, 127, 100, 'x'}))
+	test_equal(sprintf("sprintf() repeated %%d of a float #%d", i), "12 -7", sprintf("%d %d", {12.0, -7.9}))
+end for
+
+sequence fmt = "a=%d"
+for i = 1 to 3 do
+	test_equal(sprintf("sprintf() changing format #%d", i), "a=" & sprint(i), sprintf(fmt, i))
+end for
+fmt[1] = 'b'
+test_equal("sprintf() format changed in place", "b=4", sprintf(fmt, 4))
+
+-- a format's first use isn't cached, so later uses must match it
+fmt = "%-6s|%6.2f|%o|%x|%g|%5d|%s"
+sequence fmt_args = {"ab", 3.14159, 8, 255, 0.5, -42, {'c', 'd'}}
+sequence uncached = sprintf(fmt, fmt_args)
+test_equal("sprintf() uncached format", "ab    |  3.14|10|FF|0.5|  -42|cd", uncached)
+for i = 1 to 5 do
+	test_equal(sprintf("sprintf() cached format #%d", i), uncached, sprintf(fmt, fmt_args))
+end for
+
+-- formats longer than FORMAT_MAX_LENGTH (1024) are never compiled
+fmt = repeat('.', 1100) & "%d %s %x"
+uncached = sprintf(fmt, {5, "ab", 255})
+test_equal("sprintf() long format", repeat('.', 1100) & "5 ab FF", uncached)
+for i = 1 to 3 do
+	test_equal(sprintf("sprintf() long format repeated #%d", i), uncached, sprintf(fmt, {5, "ab", 255}))
+end for
+
 
 -- proper
 test_equal("proper #1", {"The Quick Brown", "The Quick Brown", "_abc Abc_12_def34fgh", {2.3, 'a'}, "123Word*Another*Word((Here))"},